@@ -1,19 +1,26 @@
 #include <algorithm>
 #include <filesystem>
 #include <iostream>
+#include <random>
 #include <regex>
 
 #include "boost/program_options.hpp"
 
+#include "cista/mmap.h"
+
 #include "utl/parallel_for.h"
 #include "utl/progress_tracker.h"
 
 #include "nigiri/logging.h"
 #include "nigiri/qa/qa.h"
 #include "nigiri/query_generator/generator.h"
+#include "nigiri/routing/mc_raptor_search.h"
 #include "nigiri/routing/raptor/raptor.h"
 #include "nigiri/routing/raptor_search.h"
 #include "nigiri/routing/search.h"
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/rt/rt_timetable.h"
 #include "nigiri/timetable.h"
 #include "nigiri/types.h"
 
@@ -135,10 +142,21 @@ nigiri::pareto_set<nigiri::routing::journey> raptor_search(
                .journeys_);
 }
 
+// McRAPTOR result in the format of the RAPTOR results (without algo stats).
+routing_result<raptor_stats> to_raptor_result(
+    routing_result<mc_raptor_stats> const& r) {
+  return {.journeys_ = r.journeys_,
+          .interval_ = r.interval_,
+          .search_stats_ = r.search_stats_,
+          .algo_stats_ = {}};
+}
+
 void process_queries(
     std::vector<nigiri::query_generation::start_dest_query> const& queries,
     std::vector<benchmark_result>& results,
-    nigiri::timetable const& tt) {
+    nigiri::timetable const& tt,
+    nigiri::rt_timetable const* rtt,
+    bool const mc = false) {
   results.reserve(queries.size());
   std::mutex mutex;
   {
@@ -150,14 +168,19 @@ void process_queries(
     struct query_state {
       search_state ss_;
       raptor_state rs_;
+      mc_raptor_state mc_;
     };
     utl::parallel_for_run_threadlocal<query_state>(
         queries.size(), [&](auto& query_state, auto const q_idx) {
           try {
             auto const total_time_start = std::chrono::steady_clock::now();
-            auto const result = routing::raptor_search(
-                tt, nullptr, query_state.ss_, query_state.rs_,
-                queries[q_idx].q_, direction::kForward);
+            auto const result =
+                mc ? to_raptor_result(routing::mc_raptor_search(
+                         tt, query_state.ss_, query_state.mc_,
+                         queries[q_idx].q_))
+                   : routing::raptor_search(tt, rtt, query_state.ss_,
+                                            query_state.rs_, queries[q_idx].q_,
+                                            direction::kForward);
             auto const total_time_stop = std::chrono::steady_clock::now();
             auto const guard = std::lock_guard{mutex};
             results.emplace_back(benchmark_result{
@@ -305,6 +328,94 @@ void print_results(
   print_result(results, "#journeys");
 }
 
+// Adds random delays (from a random stop on) and cancellations to
+// transports of the rt timetable's base day.
+void add_random_rt_updates(timetable const& tt,
+                           rt_timetable& rtt,
+                           std::uint32_t const n_delays,
+                           std::uint32_t const n_cancellations,
+                           std::int64_t const seed) {
+  if (tt.transport_route_.size() == 0U) {
+    return;
+  }
+
+  auto rng = seed > -1 ? std::mt19937{static_cast<std::uint32_t>(seed)}
+                       : std::mt19937{std::random_device{}()};
+  auto transport_dist =
+      std::uniform_int_distribution<transport_idx_t::value_t>{
+          0U, static_cast<transport_idx_t::value_t>(
+                  tt.transport_route_.size() - 1U)};
+  auto delay_dist = std::uniform_int_distribution<int>{1, 30};
+
+  auto const day = rtt.base_day_idx_;
+  auto const random_transport = [&]() -> std::optional<transport> {
+    for (auto attempt = 0U; attempt != 1000U; ++attempt) {
+      auto const t = transport{transport_idx_t{transport_dist(rng)}, day};
+      if (rtt.bitfields_[rtt.transport_traffic_days_[t.t_idx_]].test(
+              to_idx(day)) &&
+          rtt.resolve_rt(t) == rt_transport_idx_t::invalid()) {
+        return t;
+      }
+    }
+    return std::nullopt;
+  };
+
+  auto n_delayed = 0U;
+  for (auto i = 0U; i != n_delays; ++i) {
+    auto const t = random_transport();
+    if (!t.has_value()) {
+      break;
+    }
+    auto const n_stops = static_cast<stop_idx_t>(
+        tt.route_location_seq_[tt.transport_route_[t->t_idx_]].size());
+    auto const from = std::uniform_int_distribution<stop_idx_t>{
+        0U, static_cast<stop_idx_t>(n_stops - 1U)}(rng);
+    auto const delay = duration_t{delay_dist(rng)};
+    auto const rt_t = rtt.add_rt_transport(source_idx_t{0U}, tt, *t);
+    for (auto stop_idx = from; stop_idx != n_stops; ++stop_idx) {
+      if (stop_idx != 0U) {
+        rtt.update_time(rt_t, stop_idx, event_type::kArr,
+                        tt.event_time(*t, stop_idx, event_type::kArr) + delay);
+      }
+      if (stop_idx != n_stops - 1U) {
+        rtt.update_time(rt_t, stop_idx, event_type::kDep,
+                        tt.event_time(*t, stop_idx, event_type::kDep) + delay);
+      }
+    }
+    ++n_delayed;
+  }
+
+  auto n_cancelled = 0U;
+  for (auto i = 0U; i != n_cancellations; ++i) {
+    auto const t = random_transport();
+    if (!t.has_value()) {
+      break;
+    }
+    rtt.deactivate_static_transport(*t);
+    ++n_cancelled;
+  }
+
+  std::cout << "random rt updates: " << n_delayed << " delays, "
+            << n_cancelled << " cancellations\n";
+}
+
+// Moves the query start to the given day (keeps the time of day).
+void move_to_day(routing::query& q, date::sys_days const day) {
+  auto const move = [&](unixtime_t const t) {
+    return day + (t - std::chrono::floor<date::days>(t));
+  };
+  q.start_time_ = std::visit(
+      utl::overloaded{[&](unixtime_t const t) -> routing::start_time_t {
+                        return move(t);
+                      },
+                      [&](interval<unixtime_t> const i)
+                          -> routing::start_time_t {
+                        return interval<unixtime_t>{move(i.from_),
+                                                    move(i.from_) + i.size()};
+                      }},
+      q.start_time_);
+}
+
 void print_memory_usage() {
 #ifndef _WIN32
   auto r = rusage{};
@@ -335,6 +446,11 @@ int main(int argc, char* argv[]) {
   auto seed = std::int64_t{-1};
   auto min_transfer_time = duration_t::rep{};
   auto qa_path = std::filesystem::path{};
+  auto gtfsrt_paths = std::vector<std::filesystem::path>{};
+  auto rt_base_day_str = std::string{};
+  auto n_random_delays = std::uint32_t{0U};
+  auto n_random_cancellations = std::uint32_t{0U};
+  auto use_mc_raptor = false;
 
   bpo::options_description desc("Allowed options");
   desc.add_options()("help,h", "produce this help message")  //
@@ -408,7 +524,19 @@ int main(int argc, char* argv[]) {
       ("dest_loc", bpo::value<location_idx_t::value_t>(&dest_loc_val),
        "destination location for random queries")  //
       ("qa_path,q", bpo::value(&qa_path),
-       "path to write the journey criteria to for qa");
+       "path to write the journey criteria to for qa")  //
+      ("gtfsrt", bpo::value(&gtfsrt_paths)->multitoken(),
+       "GTFS-RT protobuf snapshot(s) to load into the rt timetable")  //
+      ("random_delays", bpo::value(&n_random_delays),
+       "number of random delays to add to the rt timetable")  //
+      ("random_cancellations", bpo::value(&n_random_cancellations),
+       "number of random cancellations to add to the rt timetable")  //
+      ("rt_base_day", bpo::value(&rt_base_day_str),
+       "base day of the rt timetable (YYYY-MM-DD), default: today; "
+       "queries are moved to this day if real-time data is used")  //
+      ("mc_raptor", bpo::bool_switch(&use_mc_raptor),
+       "multi-criteria search (arrival time, transfers, walking time), "
+       "compared to RAPTOR on the same queries");
   bpo::variables_map vm;
   bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
 
@@ -519,13 +647,70 @@ int main(int argc, char* argv[]) {
     gs.dest_match_mode_ = location_match_mode::kEquivalent;
     gs.dest_ = location_idx_t{dest_loc_val};
   }
+
+  auto const use_rt = !gtfsrt_paths.empty() || n_random_delays != 0U ||
+                      n_random_cancellations != 0U;
+  auto rt_base_day = std::chrono::time_point_cast<date::days>(
+      std::chrono::system_clock::now());
+  if (!rt_base_day_str.empty()) {
+    auto ss = std::stringstream{rt_base_day_str};
+    ss >> date::parse("%F", rt_base_day);
+    if (ss.fail()) {
+      std::cout << "Error: invalid rt base day\n";
+      return 1;
+    }
+  }
+  if (use_mc_raptor && (use_rt || gs.n_vias_ != 0U)) {
+    std::cout << "Error: mc_raptor does not support real-time or vias\n";
+    return 1;
+  }
   // process program options - end
 
+  auto rtt = std::optional<rt_timetable>{};
+  if (use_rt) {
+    auto const rt_timer = scoped_timer{"creation of rt timetable"};
+    rtt = rt::create_rt_timetable(tt, rt_base_day);
+    for (auto const& p : gtfsrt_paths) {
+      auto const f =
+          cista::mmap{p.string().c_str(), cista::mmap::protection::READ};
+      auto const stats =
+          rt::gtfsrt_update_buf(tt, *rtt, source_idx_t{0U}, "", f.view());
+      std::cout << p << ":\n" << stats << "\n";
+    }
+    add_random_rt_updates(tt, *rtt, n_random_delays, n_random_cancellations,
+                          seed);
+    rtt->build_rt_routes(tt);
+    std::cout << rtt->n_rt_transports() << " rt transports\n";
+  }
+
   auto queries = std::vector<nigiri::query_generation::start_dest_query>{};
   generate_queries(queries, n_queries, tt, gs, seed);
 
   auto results = std::vector<benchmark_result>{};
-  process_queries(queries, results, tt);
+  if (rtt.has_value()) {
+    for (auto& q : queries) {
+      move_to_day(q.q_, rt_base_day);
+    }
+
+    // Static baseline for the same queries.
+    auto static_results = std::vector<benchmark_result>{};
+    process_queries(queries, static_results, tt, nullptr);
+    utl::sort(static_results, [](auto const& a, auto const& b) {
+      return a.total_time_ < b.total_time_;
+    });
+    print_result(static_results, "total_time (static)");
+  }
+  if (use_mc_raptor) {
+    // RAPTOR baseline for the same queries.
+    auto raptor_results = std::vector<benchmark_result>{};
+    process_queries(queries, raptor_results, tt, nullptr);
+    utl::sort(raptor_results, [](auto const& a, auto const& b) {
+      return a.total_time_ < b.total_time_;
+    });
+    print_result(raptor_results, "total_time (raptor)");
+  }
+  process_queries(queries, results, tt, rtt.has_value() ? &*rtt : nullptr,
+                  use_mc_raptor);
 
   print_results(queries, results, tt, gs, tt_path);
 
@@ -0,0 +1,183 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+
+#include "boost/program_options.hpp"
+
+#include "fmt/format.h"
+
+#include "utl/parser/arg_parser.h"
+#include "utl/parser/buf_reader.h"
+#include "utl/parser/csv_range.h"
+#include "utl/parser/line_range.h"
+#include "utl/pipes/for_each.h"
+
+#include "nigiri/loader/gtfs/csv_scanner.h"
+#include "nigiri/loader/gtfs/parse_time.h"
+
+using namespace nigiri;
+using namespace nigiri::loader::gtfs;
+
+struct csv_stop_time {
+  utl::csv_col<utl::cstr, UTL_NAME("trip_id")> trip_id_;
+  utl::csv_col<utl::cstr, UTL_NAME("arrival_time")> arrival_time_;
+  utl::csv_col<utl::cstr, UTL_NAME("departure_time")> departure_time_;
+  utl::csv_col<utl::cstr, UTL_NAME("stop_id")> stop_id_;
+  utl::csv_col<std::uint16_t, UTL_NAME("stop_sequence")> stop_sequence_;
+};
+
+// Synthetic stop_times.txt: trips with 20 stops, times spread over 30h.
+std::string generate(std::uint64_t const n_rows, std::uint32_t const seed) {
+  auto rng = std::mt19937{seed};
+  auto start_dist = std::uniform_int_distribution<unsigned>{0U, 24U * 60U};
+  auto travel_dist = std::uniform_int_distribution<unsigned>{1U, 10U};
+
+  auto s = std::string{
+      "trip_id,arrival_time,departure_time,stop_id,stop_sequence\n"};
+  s.reserve(n_rows * 48U);
+  auto t = 0U;
+  for (auto i = std::uint64_t{0U}; i != n_rows; ++i) {
+    auto const seq = i % 20U;
+    t = seq == 0U ? start_dist(rng) : t + travel_dist(rng);
+    auto const time = fmt::format("{:02}:{:02}:00", t / 60U, t % 60U);
+    fmt::format_to(std::back_inserter(s), "T{},{},{},S{},{}\n", i / 20U, time,
+                   time, rng() % 100'000U, seq);
+  }
+  return s;
+}
+
+// hhmm_to_min before the fixed layout fast path.
+duration_t hhmm_to_min_parse_arg(utl::cstr s) {
+  if (s.empty()) {
+    return kInterpolate;
+  }
+  int hours = 0;
+  utl::parse_arg(s, hours, 0);
+  if (s) {
+    ++s;
+  } else {
+    return kInterpolate;
+  }
+  int minutes = 0;
+  utl::parse_arg(s, minutes, 0);
+  return duration_t{hours * 60 + minutes};
+}
+
+// Numeric part of the synthetic stop ids "S<number>".
+utl::cstr stop_number(csv_stop_time const& r) {
+  return {r.stop_id_->str + 1, r.stop_id_->len - 1U};
+}
+
+// Calls fn(row) for every row, tokenized by utl::csv.
+template <typename Fn>
+void for_each_utl(std::string const& file, Fn&& fn) {
+  utl::line_range{utl::make_buf_reader(file)}  //
+      | utl::csv<csv_stop_time>()  //
+      | utl::for_each([&](csv_stop_time const& r) { fn(r); });
+}
+
+// Calls fn(row) for every row, tokenized by csv_scanner.
+template <typename Fn>
+void for_each_scanner(std::string const& file, Fn&& fn) {
+  auto csv = csv_scanner{file};
+  auto const trip_id_col = csv.column("trip_id");
+  auto const arrival_time_col = csv.column("arrival_time");
+  auto const departure_time_col = csv.column("departure_time");
+  auto const stop_id_col = csv.column("stop_id");
+  auto const stop_sequence_col = csv.column("stop_sequence");
+  auto r = csv_stop_time{};
+  while (csv.next()) {
+    *r.trip_id_ = csv[trip_id_col];
+    *r.arrival_time_ = csv[arrival_time_col];
+    *r.departure_time_ = csv[departure_time_col];
+    *r.stop_id_ = csv[stop_id_col];
+    *r.stop_sequence_ = parse_int<std::uint16_t>(csv[stop_sequence_col]);
+    fn(r);
+  }
+}
+
+template <typename ForEach, typename Fn>
+void run(std::string_view name,
+         std::string const& file,
+         ForEach&& for_each,
+         Fn&& fn) {
+  auto const start = std::chrono::steady_clock::now();
+  auto n = std::uint64_t{0U};
+  auto checksum = std::int64_t{0};
+  for_each(file, [&](csv_stop_time const& r) {
+    checksum += fn(r);
+    ++n;
+  });
+  auto const duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+  auto const mb = static_cast<double>(file.size()) / (1024.0 * 1024.0);
+  std::cout << fmt::format(
+      "{:<26} rows={} time={}ms throughput={:.1f} MB/s checksum={}\n", name,
+      n, duration.count(),
+      mb / (static_cast<double>(duration.count() + 1) / 1000.0), checksum);
+}
+
+int main(int argc, char* argv[]) {
+  namespace bpo = boost::program_options;
+
+  auto n_rows = std::uint64_t{100'000'000U};
+  auto seed = std::uint32_t{0U};
+
+  bpo::options_description desc("Allowed options");
+  desc.add_options()("help,h", "produce this help message")  //
+      ("rows,n", bpo::value(&n_rows)->default_value(n_rows),
+       "number of rows of the synthetic stop_times.txt")  //
+      ("seed,s", bpo::value(&seed)->default_value(seed),
+       "value to seed the RNG with");
+  bpo::variables_map vm;
+  bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
+
+  if (vm.count("help") != 0U) {
+    std::cout << desc << "\n";
+    return 0;
+  }
+
+  bpo::notify(vm);
+
+  std::cout << "generating " << n_rows << " rows...\n";
+  auto const file = generate(n_rows, seed);
+  std::cout << "file size: " << file.size() / (1024U * 1024U) << " MB\n";
+
+  auto const utl_csv = [](std::string const& f, auto&& fn) {
+    for_each_utl(f, fn);
+  };
+  auto const scanner = [](std::string const& f, auto&& fn) {
+    for_each_scanner(f, fn);
+  };
+
+  auto const lengths = [](csv_stop_time const& r) {
+    return static_cast<std::int64_t>(r.arrival_time_->len +
+                                     r.departure_time_->len);
+  };
+  run("tokenize utl::csv", file, utl_csv, lengths);
+  run("tokenize csv_scanner", file, scanner, lengths);
+
+  auto const old_times = [](csv_stop_time const& r) {
+    return static_cast<std::int64_t>(
+        hhmm_to_min_parse_arg(*r.arrival_time_).count() +
+        hhmm_to_min_parse_arg(*r.departure_time_).count());
+  };
+  auto const new_times = [](csv_stop_time const& r) {
+    return static_cast<std::int64_t>(hhmm_to_min(*r.arrival_time_).count() +
+                                     hhmm_to_min(*r.departure_time_).count());
+  };
+  run("times parse_arg", file, scanner, old_times);
+  run("times fast path", file, scanner, new_times);
+
+  auto const old_ints = [](csv_stop_time const& r) {
+    return static_cast<std::int64_t>(utl::parse<unsigned>(stop_number(r)));
+  };
+  auto const new_ints = [](csv_stop_time const& r) {
+    return static_cast<std::int64_t>(parse_int<unsigned>(stop_number(r)));
+  };
+  run("integers utl::parse", file, scanner, old_ints);
+  run("integers fast path", file, scanner, new_ints);
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <vector>
 
 #include "boost/algorithm/string.hpp"
@@ -27,6 +28,8 @@ int main(int ac, char** av) {
   auto out_shapes = fs::path{"shapes"};
   auto start_date = "TODAY"s;
   auto assistance_path = fs::path{};
+  auto cache_dir = fs::path{};
+  auto checkpoint_interval = loader::kCheckpointInterval;
   auto n_days = 365U;
   auto recursive = false;
   auto ignore = false;
@@ -67,6 +70,13 @@ int main(int ac, char** av) {
       ("max_foopath_length",
        bpo::value(&finalize_opt.max_footpath_length_)
            ->default_value(finalize_opt.max_footpath_length_))  //
+      ("cache", bpo::value(&cache_dir),
+       "directory for intermediate timetables: unchanged sources are not "
+       "parsed again")  //
+      ("checkpoint_interval",
+       bpo::value(&checkpoint_interval)->default_value(checkpoint_interval),
+       "number of sources between two cached intermediate timetables "
+       "(1: one per source)")  //
       ("assistance_times", bpo::value(&assistance_path))  //
       ("shapes", bpo::value(&out_shapes));
   auto const pos = bpo::positional_options_description{}.add("in", -1);
@@ -90,6 +100,9 @@ int main(int ac, char** av) {
         input_files.emplace_back(e.path().generic_string(), c);
       }
     }
+    // Stable source order (required to reuse cached sources).
+    std::sort(begin(input_files), end(input_files),
+              [](auto&& a, auto&& b) { return a.first < b.first; });
   } else if (exists(in) && !recursive) {
     input_files.emplace_back(in.generic_string(), c);
   }
@@ -114,6 +127,7 @@ int main(int ac, char** av) {
 
   auto const start = parse_date(start_date);
   load(input_files, finalize_opt, {start, start + date::days{n_days}},
-       assistance.get(), shapes.get(), ignore && recursive)
+       assistance.get(), shapes.get(), ignore && recursive, cache_dir,
+       checkpoint_interval)
       .write(out);
 }
\ No newline at end of file
@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "boost/program_options.hpp"
+
+#include "pugixml.hpp"
+
+#include "cista/mmap.h"
+#include "cista/serialization.h"
+
+#include "utl/enumerate.h"
+
+#include "nigiri/query_generator/generator.h"
+#include "nigiri/routing/raptor_search.h"
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/rt/rt_timetable.h"
+#include "nigiri/rt/rt_timetable_publisher.h"
+#include "nigiri/rt/vdv/vdv_event_index.h"
+#include "nigiri/rt/vdv/vdv_update.h"
+#include "nigiri/timetable.h"
+#include "nigiri/types.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace nigiri;
+namespace fs = std::filesystem;
+
+using micros_t = std::chrono::microseconds;
+
+enum class msg_type { kGtfsRt, kVdv };
+
+struct message {
+  fs::path path_;
+  msg_type type_;
+  std::string content_;
+};
+
+struct message_result {
+  std::size_t msg_idx_;
+  micros_t duration_;
+};
+
+// needs sorted vector
+template <typename T>
+T quantile(std::vector<T> const& v, double q) {
+  q = q < 0.0 ? 0.0 : q;
+  q = 1.0 < q ? 1.0 : q;
+  if (q == 1.0) {
+    return v.back();
+  }
+  return v[static_cast<std::size_t>(static_cast<double>(v.size()) * q)];
+}
+
+void print_result(std::vector<micros_t> const& var,
+                  std::string const& var_name) {
+  if (var.empty()) {
+    return;
+  }
+  std::cout << "\n--- " << var_name << " --- (n = " << var.size() << ")"
+            << "\n  10%: " << quantile(var, 0.1)
+            << "\n  50%: " << quantile(var, 0.5)
+            << "\n  90%: " << quantile(var, 0.9)
+            << "\n  99%: " << quantile(var, 0.99)
+            << "\n99.9%: " << quantile(var, 0.999) << "\n  max: " << var.back()
+            << "\n----------------------------------\n";
+}
+
+std::vector<message> read_messages(fs::path const& dir) {
+  auto paths = std::vector<fs::path>{};
+  for (auto const& e : fs::directory_iterator{dir}) {
+    if (e.is_regular_file()) {
+      paths.emplace_back(e.path());
+    }
+  }
+  std::sort(begin(paths), end(paths));
+
+  auto messages = std::vector<message>{};
+  for (auto const& p : paths) {
+    auto const ext = p.extension().string();
+    auto const type = ext == ".xml" ? std::optional{msg_type::kVdv}
+                      : ext == ".pb" || ext == ".bin"
+                          ? std::optional{msg_type::kGtfsRt}
+                          : std::nullopt;
+    if (!type.has_value()) {
+      std::cout << "skipping " << p << " (unknown extension)\n";
+      continue;
+    }
+    auto const content =
+        cista::mmap{p.string().c_str(), cista::mmap::protection::READ};
+    messages.emplace_back(p, *type, std::string{content.view()});
+  }
+  return messages;
+}
+
+std::size_t rtt_size(rt_timetable const& rtt) {
+  return cista::serialize(rtt).size();
+}
+
+double max_rss_gib() {
+#ifndef _WIN32
+  auto r = rusage{};
+  getrusage(RUSAGE_SELF, &r);
+  return static_cast<double>(r.ru_maxrss) / (1024 * 1024);
+#else
+  return 0.0;
+#endif
+}
+
+int main(int argc, char* argv[]) {
+  namespace bpo = boost::program_options;
+
+  auto tt_path = fs::path{};
+  auto msg_path = fs::path{};
+  auto base_day_str = std::string{};
+  auto gtfsrt_src = source_idx_t::value_t{0U};
+  auto vdv_src = source_idx_t::value_t{0U};
+  auto use_vdv_index = true;
+  auto n_query_threads = 0U;
+  auto seed = std::int64_t{-1};
+
+  bpo::options_description desc("Allowed options");
+  desc.add_options()("help,h", "produce this help message")  //
+      ("tt_path,p", bpo::value(&tt_path)->required(),
+       "path to a binary file containing a serialized nigiri timetable")  //
+      ("messages,m", bpo::value(&msg_path)->required(),
+       "directory with recorded messages, replayed in file name order:\n"
+       "*.pb, *.bin: GTFS-RT protobuf\n*.xml: VDV AUS")  //
+      ("base_day,d", bpo::value(&base_day_str),
+       "base day of the rt timetable (YYYY-MM-DD), default: today")  //
+      ("gtfsrt_src", bpo::value(&gtfsrt_src)->default_value(gtfsrt_src),
+       "source index of GTFS-RT messages")  //
+      ("vdv_src", bpo::value(&vdv_src)->default_value(vdv_src),
+       "source index of VDV messages")  //
+      ("vdv_index", bpo::value(&use_vdv_index)->default_value(use_vdv_index),
+       "match VDV runs with a prebuilt event index")  //
+      ("query_threads,q",
+       bpo::value(&n_query_threads)->default_value(n_query_threads),
+       "number of threads running routing queries during the replay")  //
+      ("seed,s", bpo::value<std::int64_t>(&seed),
+       "value to seed the RNG of the query generator with, "
+       "omit for random seed");
+  bpo::variables_map vm;
+  bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
+
+  if (vm.count("help") != 0U) {
+    std::cout << desc << "\n";
+    return 0;
+  }
+
+  bpo::notify(vm);
+
+  auto base_day = std::chrono::time_point_cast<date::days>(
+      std::chrono::system_clock::now());
+  if (!base_day_str.empty()) {
+    auto ss = std::stringstream{base_day_str};
+    ss >> date::parse("%F", base_day);
+    if (ss.fail()) {
+      std::cout << "Error: invalid base day\n";
+      return 1;
+    }
+  }
+
+  std::cout << "loading timetable...\n";
+  auto tt = *timetable::read(tt_path);
+  tt.locations_.resolve_timezones();
+
+  std::cout << "reading messages...\n";
+  auto const messages = read_messages(msg_path);
+  std::cout << messages.size() << " messages\n";
+
+  auto const vdv_idx = use_vdv_index
+                           ? std::make_unique<rt::vdv::event_index>(tt)
+                           : std::unique_ptr<rt::vdv::event_index>{};
+  auto const make_updater = [&]() {
+    return vdv_idx != nullptr
+               ? rt::vdv::updater{tt, source_idx_t{vdv_src}, *vdv_idx}
+               : rt::vdv::updater{tt, source_idx_t{vdv_src}};
+  };
+
+  // Updates are applied to both buffers of the publisher. Each buffer gets
+  // its own VDV updater to keep the run id mapping consistent.
+  auto vdv_updaters = hash_map<rt_timetable const*, rt::vdv::updater>{};
+  auto gtfsrt_stats = rt::statistics{};
+  auto gtfsrt_parser_errors = 0U;
+  auto vdv_parser_errors = 0U;
+  // Only the first application of an update is counted.
+  auto const apply = [&](rt_timetable& rtt, message const& m,
+                         bool const counting) {
+    if (m.type_ == msg_type::kGtfsRt) {
+      auto const s = rt::gtfsrt_update_buf(tt, rtt, source_idx_t{gtfsrt_src},
+                                           "", m.content_);
+      if (!counting) {
+        return;
+      }
+      gtfsrt_parser_errors += s.parser_error_ ? 1U : 0U;
+      gtfsrt_stats.total_entities_ += s.total_entities_;
+      gtfsrt_stats.total_entities_success_ += s.total_entities_success_;
+      gtfsrt_stats.total_entities_fail_ += s.total_entities_fail_;
+      gtfsrt_stats.trip_resolve_error_ += s.trip_resolve_error_;
+      gtfsrt_stats.reverted_ += s.reverted_;
+      gtfsrt_stats.resolve_duration_ += s.resolve_duration_;
+      gtfsrt_stats.apply_duration_ += s.apply_duration_;
+    } else {
+      auto it = vdv_updaters.find(&rtt);
+      if (it == end(vdv_updaters)) {
+        it = vdv_updaters.emplace(&rtt, make_updater()).first;
+      }
+      auto doc = pugi::xml_document{};
+      if (!doc.load_buffer(m.content_.data(), m.content_.size())) {
+        vdv_parser_errors += counting ? 1U : 0U;
+        return;
+      }
+      it->second.update(rtt, doc);
+    }
+  };
+
+  auto durations = std::vector<micros_t>{};
+  auto results = std::vector<message_result>{};
+  auto query_durations = std::vector<micros_t>{};
+  auto size_before = std::size_t{0U};
+  auto size_after = std::size_t{0U};
+  auto const rss_before = max_rss_gib();
+
+  auto const replay = [&](auto&& update) {
+    for (auto const [i, m] : utl::enumerate(messages)) {
+      auto const start = std::chrono::steady_clock::now();
+      update(m);
+      auto const stop = std::chrono::steady_clock::now();
+      results.emplace_back(i,
+                           std::chrono::duration_cast<micros_t>(stop - start));
+    }
+  };
+
+  if (n_query_threads == 0U) {
+    auto rtt = rt::create_rt_timetable(tt, base_day);
+    size_before = rtt_size(rtt);
+    replay([&](message const& m) { apply(rtt, m, true); });
+    size_after = rtt_size(rtt);
+  } else {
+    auto publisher = rt::rt_timetable_publisher{tt, base_day};
+    size_before = rtt_size(*publisher.get_snapshot());
+
+    auto gs = query_generation::generator_settings{};
+    gs.start_match_mode_ = routing::location_match_mode::kEquivalent;
+    gs.dest_match_mode_ = routing::location_match_mode::kEquivalent;
+
+    auto done = std::atomic_bool{false};
+    auto query_mutex = std::mutex{};
+    auto threads = std::vector<std::thread>{};
+    for (auto t = 0U; t != n_query_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        auto qg =
+            seed > -1
+                ? query_generation::generator{tt, gs,
+                                              static_cast<std::uint32_t>(seed) +
+                                                  t}
+                : query_generation::generator{tt, gs};
+        auto ss = routing::search_state{};
+        auto rs = routing::raptor_state{};
+        auto local = std::vector<micros_t>{};
+        while (!done.load(std::memory_order_relaxed)) {
+          auto sdq = qg.random_query();
+          if (!sdq.has_value()) {
+            continue;
+          }
+          auto const start = std::chrono::steady_clock::now();
+          {
+            auto const snapshot = publisher.get_snapshot();
+            routing::raptor_search(tt, &*snapshot, ss, rs, std::move(sdq->q_),
+                                   direction::kForward);
+          }
+          auto const stop = std::chrono::steady_clock::now();
+          local.emplace_back(
+              std::chrono::duration_cast<micros_t>(stop - start));
+        }
+        auto const lock = std::lock_guard{query_mutex};
+        query_durations.insert(end(query_durations), begin(local), end(local));
+      });
+    }
+
+    replay([&](message const& m) {
+      // Replayed during the next update: m refers to messages (still alive).
+      publisher.update([&, first = true](rt_timetable& rtt) mutable {
+        apply(rtt, m, first);
+        first = false;
+      });
+    });
+
+    done = true;
+    for (auto& t : threads) {
+      t.join();
+    }
+    size_after = rtt_size(*publisher.get_snapshot());
+  }
+
+  for (auto const& r : results) {
+    durations.emplace_back(r.duration_);
+  }
+  std::sort(begin(durations), end(durations));
+  print_result(durations, "message latency");
+
+  std::sort(begin(results), end(results), [](auto const& a, auto const& b) {
+    return a.duration_ > b.duration_;
+  });
+  std::cout << "\nSlowest messages:\n";
+  for (auto i = 0U; i != results.size() && i != 10U; ++i) {
+    std::cout << "  " << results[i].duration_ << ": "
+              << messages[results[i].msg_idx_].path_ << "\n";
+  }
+
+  std::sort(begin(query_durations), end(query_durations));
+  print_result(query_durations, "query latency during replay");
+
+  std::cout << "\n--- GTFS-RT statistics ---"
+            << "\nparser_errors: " << gtfsrt_parser_errors
+            << "\ntotal_entities: " << gtfsrt_stats.total_entities_
+            << "\ntotal_entities_success: "
+            << gtfsrt_stats.total_entities_success_
+            << "\ntotal_entities_fail: " << gtfsrt_stats.total_entities_fail_
+            << "\ntrip_resolve_error: " << gtfsrt_stats.trip_resolve_error_
+            << "\nreverted: " << gtfsrt_stats.reverted_
+            << "\nresolve_duration: " << gtfsrt_stats.resolve_duration_
+            << "\napply_duration: " << gtfsrt_stats.apply_duration_ << "\n";
+
+  if (!vdv_updaters.empty()) {
+    std::cout << "\n--- VDV statistics ---\nparser_errors: "
+              << vdv_parser_errors << "\n"
+              << begin(vdv_updaters)->second.get_stats() << "\n";
+  }
+
+  std::cout << "\n--- memory usage ---"
+            << "\nrt_timetable (serialized) before: " << size_before
+            << " bytes\nrt_timetable (serialized) after: " << size_after
+            << " bytes\nrusage.ru_maxrss before: " << rss_before
+            << " GiB\nrusage.ru_maxrss after: " << max_rss_gib() << " GiB\n";
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "boost/program_options.hpp"
+
+#include "fmt/format.h"
+
+#include "nigiri/timetable.h"
+
+using namespace nigiri;
+
+// Synthetic timetable with n_trips trip ids "trip-<i>" of one source,
+// sorted like loader::finalize() does.
+void generate(timetable& tt, std::uint32_t const n_trips) {
+  for (auto i = 0U; i != n_trips; ++i) {
+    tt.register_trip_id(fmt::format("trip-{:08}", i), source_idx_t{0U}, "",
+                        trip_debug{}, 0U, {});
+  }
+  std::sort(begin(tt.trip_id_to_idx_), end(tt.trip_id_to_idx_),
+            [&](pair<trip_id_idx_t, trip_idx_t> const& a,
+                pair<trip_id_idx_t, trip_idx_t> const& b) {
+              return std::tuple(tt.trip_id_src_[a.first],
+                                tt.trip_id_strings_[a.first].view()) <
+                     std::tuple(tt.trip_id_src_[b.first],
+                                tt.trip_id_strings_[b.first].view());
+            });
+}
+
+void run(std::string_view name,
+         timetable const& tt,
+         std::vector<std::string> const& queries) {
+  auto const start = std::chrono::steady_clock::now();
+  auto n_found = 0U;
+  for (auto const& q : queries) {
+    n_found += tt.find_trip_id(source_idx_t{0U}, q) != end(tt.trip_id_to_idx_)
+                   ? 1U
+                   : 0U;
+  }
+  auto const duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start);
+  std::cout << fmt::format(
+      "{:<14} lookups={} found={} time={}ms per_lookup={:.1f}ns\n", name,
+      queries.size(), n_found, duration.count() / 1'000'000,
+      static_cast<double>(duration.count()) /
+          static_cast<double>(std::max(std::size_t{1U}, queries.size())));
+}
+
+int main(int argc, char* argv[]) {
+  namespace bpo = boost::program_options;
+
+  auto n_trips = std::uint32_t{1'000'000U};
+  auto n_lookups = std::uint32_t{10'000'000U};
+  auto miss_rate = 0.1;
+  auto seed = std::uint32_t{0U};
+
+  bpo::options_description desc("Allowed options");
+  desc.add_options()("help,h", "produce this help message")  //
+      ("trips,t", bpo::value(&n_trips)->default_value(n_trips),
+       "number of trip ids")  //
+      ("lookups,n", bpo::value(&n_lookups)->default_value(n_lookups),
+       "number of lookups")  //
+      ("miss_rate,m", bpo::value(&miss_rate)->default_value(miss_rate),
+       "share of lookups for unknown trip ids")  //
+      ("seed,s", bpo::value(&seed)->default_value(seed),
+       "value to seed the RNG with");
+  bpo::variables_map vm;
+  bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
+
+  if (vm.count("help") != 0U) {
+    std::cout << desc << "\n";
+    return 0;
+  }
+
+  bpo::notify(vm);
+
+  auto tt = timetable{};
+  generate(tt, n_trips);
+
+  auto rng = std::mt19937{seed};
+  auto trip_dist = std::uniform_int_distribution<std::uint32_t>{
+      0U, std::max(n_trips, 1U) - 1U};
+  auto miss_dist = std::bernoulli_distribution{miss_rate};
+  auto queries = std::vector<std::string>{};
+  queries.reserve(n_lookups);
+  for (auto i = 0U; i != n_lookups; ++i) {
+    queries.emplace_back(miss_dist(rng)
+                             ? fmt::format("unknown-{:08}", trip_dist(rng))
+                             : fmt::format("trip-{:08}", trip_dist(rng)));
+  }
+
+  tt.trip_id_index_.clear();
+  run("binary search", tt, queries);
+
+  tt.build_trip_id_index();
+  run("hash index", tt, queries);
+}
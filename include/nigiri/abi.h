@@ -81,6 +81,23 @@ void nigiri_update_with_rt(const nigiri_timetable_t* t,
                                             void* context),
                            void* context);
 
+// Same as nigiri_update_with_rt but hands out all changes of the update
+// with one callback invocation. The array is only valid during the callback.
+void nigiri_update_with_rt_batch(const nigiri_timetable_t* t,
+                                 const char* gtfsrt_pb_path,
+                                 void (*callback)(
+                                     const nigiri_event_change_t* changes,
+                                     uint32_t n_changes,
+                                     void* context),
+                                 void* context);
+
+// Same as nigiri_update_with_rt_batch without callback: returns the number
+// of changes and sets *changes to them. The array is owned by the timetable
+// and valid until its next real-time update or nigiri_destroy.
+uint32_t nigiri_update_with_rt_changes(const nigiri_timetable_t* t,
+                                       const char* gtfsrt_pb_path,
+                                       const nigiri_event_change_t** changes);
+
 #ifdef __cplusplus
 }
 #endif
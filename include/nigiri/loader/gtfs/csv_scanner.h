@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "utl/parser/arg_parser.h"
+#include "utl/parser/cstr.h"
+
+namespace nigiri::loader::gtfs {
+
+// Integer fast path: up to 9 plain digits are decoded directly. Everything
+// else (empty, sign, blanks, longer numbers) goes through utl::parse.
+template <typename T>
+T parse_int(utl::cstr const s) {
+  if (s.len == 0U || s.len > 9U) {
+    return utl::parse<T>(s);
+  }
+  auto val = 0U;
+  for (auto i = std::size_t{0U}; i != s.len; ++i) {
+    auto const d = static_cast<unsigned>(s.str[i] - '0');
+    if (d > 9U) {
+      return utl::parse<T>(s);
+    }
+    val = val * 10U + d;
+  }
+  return static_cast<T>(val);
+}
+
+// Parses one field into a utl::csv_col value.
+template <typename T>
+void parse_field(utl::cstr const s, T& val) {
+  if constexpr (std::is_same_v<T, utl::cstr>) {
+    val = s;
+  } else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+    val = parse_int<T>(s);
+  } else {
+    val = utl::parse<T>(s);
+  }
+}
+
+// Splits CSV rows into fields. Delimiters, quotes and line ends are found
+// eight bytes at a time through bitmask classification of 64bit words.
+// Fields point into the input, except for quoted fields with escaped quotes
+// ("") which are unescaped into storage owned by the scanner. Both stay valid
+// as long as the input and the scanner.
+struct csv_scanner {
+  static constexpr auto const kMissing =
+      std::numeric_limits<std::size_t>::max();
+
+  // csv: header line followed by the rows.
+  explicit csv_scanner(std::string_view csv);
+
+  // header: header line (rows of a chunk without the header line).
+  csv_scanner(std::string_view header, std::string_view rows);
+
+  // Index of the column in the header, kMissing if there is none.
+  std::size_t column(std::string_view name) const;
+
+  // Advances to the next non-empty row. Returns false at the end.
+  bool next();
+
+  // Field of the current row. Empty for missing columns.
+  utl::cstr operator[](std::size_t const col) const {
+    return col < fields_.size() ? fields_[col] : utl::cstr{};
+  }
+
+  // Number of input bytes consumed so far.
+  std::size_t position() const {
+    return static_cast<std::size_t>(pos_ - rows_.data());
+  }
+
+private:
+  void read_row();
+
+  std::string_view rows_;
+  char const* pos_;
+  std::vector<std::string> header_;
+  std::vector<utl::cstr> fields_;
+  std::deque<std::string> unescaped_;
+};
+
+}  // namespace nigiri::loader::gtfs
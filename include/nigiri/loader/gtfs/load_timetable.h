@@ -1,6 +1,9 @@
 #pragma once
 
+#include <memory>
+
 #include "nigiri/loader/dir.h"
+#include "nigiri/loader/gtfs/stop_time.h"
 #include "nigiri/loader/loader_interface.h"
 #include "nigiri/types.h"
 
@@ -18,6 +21,14 @@ cista::hash_t hash(dir const& d);
 
 bool applicable(dir const&);
 
+// stop_times.txt, parsed before the other files are read.
+struct prepared_gtfs final : public prepared_source {
+  file stop_times_file_;
+  stop_time_chunks stop_times_;
+};
+
+std::unique_ptr<prepared_gtfs> prepare(dir const&);
+
 void load_timetable(loader_config const&,
                     source_idx_t,
                     dir const&,
@@ -33,4 +44,13 @@ void load_timetable(loader_config const&,
                     assistance_times* = nullptr,
                     shapes_storage* = nullptr);
 
+void load_timetable(loader_config const&,
+                    source_idx_t,
+                    dir const&,
+                    prepared_gtfs&,
+                    timetable&,
+                    hash_map<bitfield, bitfield_idx_t>&,
+                    assistance_times*,
+                    shapes_storage*);
+
 }  // namespace nigiri::loader::gtfs
\ No newline at end of file
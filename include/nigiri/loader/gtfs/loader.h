@@ -15,6 +15,17 @@ struct gtfs_loader : public loader_interface {
             shapes_storage*) const override;
   cista::hash_t hash(dir const&) const override;
   std::string_view name() const override;
+  std::vector<std::filesystem::path> files(bool with_shapes) const override;
+  std::unique_ptr<prepared_source> prepare(loader_config const&,
+                                           dir const&) const override;
+  void load_prepared(prepared_source&,
+                     loader_config const&,
+                     source_idx_t const,
+                     dir const&,
+                     timetable&,
+                     hash_map<bitfield, bitfield_idx_t>&,
+                     assistance_times*,
+                     shapes_storage*) const override;
 };
 
 }  // namespace nigiri::loader::gtfs
\ No newline at end of file
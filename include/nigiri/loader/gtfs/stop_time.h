@@ -1,16 +1,70 @@
 #pragma once
 
+#include <cstddef>
 #include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "utl/parser/cstr.h"
+
+#include "nigiri/loader/gtfs/csv_scanner.h"
 #include "nigiri/loader/gtfs/trip.h"
 
 namespace nigiri::loader::gtfs {
 
+// Size of the parts of stop_times.txt that are parsed in parallel.
+constexpr auto const kStopTimesChunkSize = std::size_t{32U} * 1024U * 1024U;
+
+// Row of stop_times.txt. Parsing does not depend on trips or stops, so it can
+// happen before they are read. Lookups are resolved afterwards. Trips are
+// only written when the rows are applied in file order.
+struct stop_time_row {
+  utl::cstr trip_id_, stop_id_, headsign_;
+  minutes_after_midnight_t arr_, dep_;
+  double distance_;
+  gtfs_trip_idx_t trip_;  // invalid: unknown trip
+  stop::value_type stop_;
+  std::uint16_t stop_sequence_;
+  bool in_allowed_, out_allowed_;
+  bool valid_times_;
+  bool valid_;  // false: unknown stop (or invalid times)
+};
+
+struct stop_time_chunk {
+  std::string_view content_;
+  bool parsed_{false};
+  std::vector<stop_time_row> rows_;
+  std::unique_ptr<csv_scanner> scanner_;  // owns unescaped fields of rows_
+};
+
+// stop_times.txt split at line boundaries. Chunks point into the file
+// content, which has to outlive them.
+struct stop_time_chunks {
+  std::string_view header_;
+  std::vector<stop_time_chunk> chunks_;
+};
+
+stop_time_chunks split_stop_times(std::string_view file_content,
+                            std::size_t chunk_size = kStopTimesChunkSize);
+
+// Parses all chunks in parallel. Needs neither the timetable nor other files.
+void parse_stop_times(stop_time_chunks&);
+
+// Parses the remaining chunks, resolves trips and stops and adds the rows to
+// the trips in file order.
+void read_stop_times(timetable&,
+                     trip_data&,
+                     locations_map const&,
+                     stop_time_chunks&,
+                     bool store_distances);
+
 void read_stop_times(timetable&,
                      trip_data&,
                      locations_map const&,
                      std::string_view file_content,
-                     bool);
+                     bool,
+                     std::size_t chunk_size = kStopTimesChunkSize);
 
 }  // namespace nigiri::loader::gtfs
@@ -19,11 +19,25 @@ namespace nigiri::loader {
 struct assistance_times;
 struct loader_config;
 
+constexpr auto const kCheckpointInterval = 16U;
+
+// With a cache directory, the timetable state before finalize is stored
+// every checkpoint_interval sources (and after the last one), keyed by the
+// loader hashes of all sources up to this point. The next import continues
+// from the checkpoint of the longest unchanged prefix of sources: a changed
+// source is parsed again together with all sources after it. Each checkpoint
+// contains the whole timetable up to its source, so a cold import writes
+// n_sources / checkpoint_interval growing timetables. A manifest per source
+// configuration records its checkpoints; only checkpoints no manifest refers
+// to anymore are removed, so configurations can share a cache directory. Not
+// supported with shapes or assistance times.
 timetable load(std::vector<std::pair<std::string, loader_config>> const&,
                finalize_options const&,
                interval<date::sys_days> const&,
                assistance_times* = nullptr,
                shapes_storage* = nullptr,
-               bool ignore = false);
+               bool ignore = false,
+               std::filesystem::path const& cache_dir = {},
+               unsigned checkpoint_interval = kCheckpointInterval);
 
 }  // namespace nigiri::loader
\ No newline at end of file
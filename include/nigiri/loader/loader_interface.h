@@ -1,7 +1,10 @@
 #pragma once
 
 #include <array>
+#include <filesystem>
+#include <memory>
 #include <string_view>
+#include <vector>
 
 #include "nigiri/loader/assistance.h"
 #include "nigiri/loader/dir.h"
@@ -20,6 +23,12 @@ struct loader_config {
   std::array<bool, kNumClasses> bikes_allowed_default_{};
 };
 
+// Data of one source that a loader computes without the timetable, e.g.
+// parsed files.
+struct prepared_source {
+  virtual ~prepared_source();
+};
+
 struct loader_interface {
   virtual ~loader_interface();
   virtual bool applicable(dir const&) const = 0;
@@ -32,6 +41,27 @@ struct loader_interface {
                     shapes_storage*) const = 0;
   virtual cista::hash_t hash(dir const&) const = 0;
   virtual std::string_view name() const = 0;
+
+  // Files that load() may read. Empty if they are not known in advance.
+  virtual std::vector<std::filesystem::path> files(bool with_shapes) const;
+
+  // Parses what does not depend on the timetable or other sources. Runs
+  // concurrently with the loading of other sources, so it must not touch
+  // shared state (this includes the progress tracker). nullptr: nothing to
+  // prepare.
+  virtual std::unique_ptr<prepared_source> prepare(loader_config const&,
+                                                   dir const&) const;
+
+  // Like load() for a source prepared by prepare() of this loader on the
+  // same directory.
+  virtual void load_prepared(prepared_source&,
+                             loader_config const&,
+                             source_idx_t,
+                             dir const&,
+                             timetable&,
+                             hash_map<bitfield, bitfield_idx_t>&,
+                             assistance_times*,
+                             shapes_storage*) const;
 };
 
 }  // namespace nigiri::loader
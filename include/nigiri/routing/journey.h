@@ -56,10 +56,10 @@ struct journey {
   bool dominates(journey const& o) const {
     if (start_time_ <= dest_time_) {
       return transfers_ <= o.transfers_ && start_time_ >= o.start_time_ &&
-             dest_time_ <= o.dest_time_;
+             dest_time_ <= o.dest_time_ && walk_time_ <= o.walk_time_;
     } else {
       return transfers_ <= o.transfers_ && start_time_ <= o.start_time_ &&
-             dest_time_ >= o.dest_time_;
+             dest_time_ >= o.dest_time_ && walk_time_ <= o.walk_time_;
     }
   }
 
@@ -87,6 +87,10 @@ struct journey {
   unixtime_t dest_time_{};
   location_idx_t dest_{};
   std::uint8_t transfers_{0U};
+
+  // Additional criterion, only set by multi-criteria searches (mc_raptor).
+  duration_t walk_time_{0U};
+
   bool error_{false};
 };
 
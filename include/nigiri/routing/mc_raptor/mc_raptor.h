@@ -0,0 +1,725 @@
+#pragma once
+
+#include <cassert>
+#include <algorithm>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "utl/helpers/algorithm.h"
+#include "utl/verify.h"
+
+#include "nigiri/common/delta_t.h"
+#include "nigiri/common/linear_lower_bound.h"
+#include "nigiri/for_each_meta.h"
+#include "nigiri/location.h"
+#include "nigiri/routing/journey.h"
+#include "nigiri/routing/limits.h"
+#include "nigiri/routing/mc_raptor/mc_raptor_state.h"
+#include "nigiri/routing/pareto_set.h"
+#include "nigiri/routing/query.h"
+#include "nigiri/routing/transfer_time_settings.h"
+#include "nigiri/rt/rt_timetable.h"
+#include "nigiri/special_stations.h"
+#include "nigiri/timetable.h"
+#include "nigiri/types.h"
+
+namespace nigiri::routing {
+
+struct mc_raptor_stats {
+  std::map<std::string, std::uint64_t> to_map() const {
+    return {
+        {"n_routes_visited", n_routes_visited_},
+        {"n_footpaths_visited", n_footpaths_visited_},
+        {"n_earliest_trip_calls", n_earliest_trip_calls_},
+        {"n_labels_created", n_labels_created_},
+        {"n_labels_dominated", n_labels_dominated_},
+        {"n_labels_evicted", n_labels_evicted_},
+        {"n_labels_pruned_by_target", n_labels_pruned_by_target_},
+        {"n_route_labels_dropped", n_route_labels_dropped_},
+    };
+  }
+
+  std::uint64_t n_routes_visited_{0ULL};
+  std::uint64_t n_footpaths_visited_{0ULL};
+  std::uint64_t n_earliest_trip_calls_{0ULL};
+  std::uint64_t n_labels_created_{0ULL};
+  std::uint64_t n_labels_dominated_{0ULL};
+  std::uint64_t n_labels_evicted_{0ULL};
+  std::uint64_t n_labels_pruned_by_target_{0ULL};
+  std::uint64_t n_route_labels_dropped_{0ULL};
+};
+
+// Multi-criteria RAPTOR (McRAPTOR) optimizing arrival time, number of
+// transfers and walking time (intermodal access/egress, start footpaths and
+// footpaths between trips).
+//
+// Labels live in bounded bags (kMcBagSize) per round and stop which are
+// pooled in mc_raptor_state. If a bag is full, the label with the latest
+// arrival time is evicted. The route bag of a route scan has the same bound,
+// labels that do not fit anymore are dropped. Thus, results are
+// pareto-optimal as long as no eviction happens (see
+// mc_raptor_stats::n_labels_evicted_ and n_route_labels_dropped_).
+//
+// Supported: forward search, static timetable, clasz + bike filters,
+// wheelchair profile, transfer time settings, intermodal start/destination.
+// Not supported: via stops, time-dependent footpaths/offsets, real-time.
+template <direction SearchDir>
+struct mc_raptor {
+  static_assert(SearchDir == direction::kForward,
+                "mc_raptor only supports forward search");
+
+  using algo_state_t = mc_raptor_state;
+  using algo_stats_t = mc_raptor_stats;
+
+  static constexpr bool kUseLowerBounds = true;
+  static constexpr auto const kInvalid = kInvalidDelta<SearchDir>;
+  static constexpr auto const kUnreachable =
+      std::numeric_limits<std::uint16_t>::max();
+  static constexpr auto const kIntermodalTarget =
+      get_special_station(special_station::kEnd);
+  static constexpr auto const kTmpRound = kMaxTransfers + 1U;
+
+  struct dest_label {
+    delta_t time_;
+    mc_walk_t walk_;
+    std::uint8_t k_;
+    std::uint32_t gen_;
+
+    // stop where the last trip / footpath ended
+    location_idx_t l_;
+
+    // intermodal egress offset at l_
+    duration_t egress_;
+
+    mc_label_info info_;
+  };
+
+  struct route_label {
+    transport t_;
+    stop_idx_t enter_;
+    mc_walk_t walk_;
+    mc_label_ref parent_;
+  };
+
+  mc_raptor(
+      timetable const& tt,
+      rt_timetable const* rtt,
+      mc_raptor_state& state,
+      bitvec& is_dest,
+      std::array<bitvec, kMaxVias>&,
+      std::vector<std::uint16_t>& dist_to_dest,
+      hash_map<location_idx_t, std::vector<td_offset>> const& td_dist_to_dest,
+      std::vector<std::uint16_t>& lb,
+      std::vector<via_stop> const& via_stops,
+      day_idx_t const base,
+      clasz_mask_t const allowed_claszes,
+      bool const require_bike_transport,
+      bool const is_wheelchair,
+      transfer_time_settings const& tts)
+      : tt_{tt},
+        n_days_{tt_.internal_interval_days().size().count()},
+        state_{state.resize(tt_.n_locations(), tt_.n_routes())},
+        is_dest_{is_dest},
+        dist_to_end_{dist_to_dest},
+        lb_{lb},
+        base_{base},
+        allowed_claszes_{allowed_claszes},
+        require_bike_transport_{require_bike_transport},
+        is_wheelchair_{is_wheelchair},
+        transfer_time_settings_{tts} {
+    utl::verify(rtt == nullptr, "mc_raptor: real-time not supported");
+    utl::verify(via_stops.empty(), "mc_raptor: via stops not supported");
+    utl::verify(td_dist_to_dest.empty(),
+                "mc_raptor: time-dependent destinations not supported");
+    reset_arrivals();
+  }
+
+  algo_stats_t get_stats() const { return stats_; }
+
+  void reset_arrivals() {
+    dest_.clear();
+    worst_at_dest_ = kInvalid;
+  }
+
+  void next_start_time() {
+    ++gen_;
+    state_.clear_bags();
+    state_.station_mark_.reset();
+    state_.prev_station_mark_.reset();
+    state_.route_mark_.reset();
+    state_.tmp_mark_.reset();
+  }
+
+  void add_start(location_idx_t const l, unixtime_t const t) {
+    add_start(l, t, t);
+  }
+
+  // The time between the start time and the time at the start stop is the
+  // first-mile walk (start offset / start footpath).
+  void add_start(location_idx_t const l,
+                 unixtime_t const time_at_stop,
+                 unixtime_t const time_at_start) {
+    auto const time = unix_to_delta(base(), time_at_stop);
+    auto const walk = static_cast<mc_walk_t>(
+        std::clamp(static_cast<int>((time_at_stop - time_at_start).count()),
+                   0, kMcInvalidWalk - 1));
+    auto const bag = state_.get_or_create_bag(0U, to_idx(l), kInvalid);
+    if (insert(bag, time, walk, mc_label_info{}) != kMcBagSize) {
+      state_.station_mark_.set(to_idx(l));
+    }
+  }
+
+  void execute(unixtime_t const start_time,
+               std::uint8_t const max_transfers,
+               unixtime_t const worst_time_at_dest,
+               profile_idx_t const prf_idx,
+               pareto_set<journey>& results) {
+    auto const end_k = std::min(max_transfers, kMaxTransfers) + 1U;
+    worst_at_dest_ =
+        get_best(worst_at_dest_, unix_to_delta(base(), worst_time_at_dest));
+
+    for (auto k = 1U; k != end_k; ++k) {
+      auto any_marked = false;
+      state_.station_mark_.for_each_set_bit([&](std::uint64_t const i) {
+        for (auto const& r : tt_.location_routes_[location_idx_t{i}]) {
+          any_marked = true;
+          state_.route_mark_.set(to_idx(r));
+        }
+      });
+
+      if (!any_marked) {
+        break;
+      }
+
+      std::swap(state_.prev_station_mark_, state_.station_mark_);
+      state_.station_mark_.reset();
+
+      state_.route_mark_.for_each_set_bit([&](std::uint64_t const r_idx) {
+        auto const r = route_idx_t{r_idx};
+        if (!is_allowed(allowed_claszes_, tt_.route_clasz_[r])) {
+          return;
+        }
+        // Routes with bikes allowed only on some sections are skipped.
+        if (require_bike_transport_ &&
+            !tt_.route_bikes_allowed_.test(r_idx * 2)) {
+          return;
+        }
+        ++stats_.n_routes_visited_;
+        update_route(k, r);
+      });
+      state_.route_mark_.reset();
+      state_.prev_station_mark_.reset();
+
+      update_footpaths(k, prf_idx);
+    }
+
+    for (auto const& d : dest_) {
+      if (d.gen_ != gen_) {
+        continue;
+      }
+      results.add(journey{
+          .legs_ = {},
+          .start_time_ = start_time,
+          .dest_time_ = delta_to_unix(base(), d.time_),
+          .dest_ = is_intermodal_dest() ? kIntermodalTarget : d.l_,
+          .transfers_ = static_cast<std::uint8_t>(d.k_ - 1U),
+          .walk_time_ = duration_t{d.walk_}});
+    }
+  }
+
+  void reconstruct(query const& q, journey& j) const {
+    auto const dest_time = unix_to_delta(base(), j.dest_time_);
+    auto const it = std::find_if(begin(dest_), end(dest_), [&](auto&& d) {
+      return d.gen_ == gen_ && d.k_ == j.transfers_ + 1U &&
+             d.time_ == dest_time && d.walk_ == j.walk_time_.count() &&
+             (is_intermodal_dest() || d.l_ == j.dest_);
+    });
+    utl::verify(it != end(dest_), "mc_raptor: destination label not found");
+
+    auto legs = std::vector<journey::leg>{};
+
+    // Intermodal egress.
+    auto l = it->l_;
+    auto time = dest_time;
+    if (is_intermodal_dest()) {
+      time = clamp(dest_time - it->egress_.count());
+      legs.emplace_back(SearchDir, l, kIntermodalTarget, to_unix(time),
+                        j.dest_time_, get_dest_offset(q, l, it->egress_));
+    }
+
+    // Trips and footpaths, from the destination back to the start.
+    auto info = it->info_;
+    auto is_last = true;
+    while (info.t_.is_valid()) {
+      auto const r = tt_.transport_route_[info.t_.t_idx_];
+      auto const stop_seq = tt_.route_location_seq_[r];
+      auto const enter_l = stop{stop_seq[info.enter_]}.location_idx();
+      auto const exit_l = stop{stop_seq[info.exit_]}.location_idx();
+      auto const arr = time_at_stop(r, info.t_, info.exit_, event_type::kArr);
+      auto const dep = time_at_stop(r, info.t_, info.enter_, event_type::kDep);
+
+      if (info.fp_from_ != location_idx_t::invalid() || !is_last) {
+        legs.emplace_back(SearchDir, exit_l, l, to_unix(arr), to_unix(time),
+                          footpath{l, duration_t{time - arr}});
+      }
+      legs.emplace_back(
+          SearchDir, enter_l, exit_l, to_unix(dep), to_unix(arr),
+          journey::run_enter_exit{
+              rt::run{.t_ = info.t_,
+                      .stop_range_ = {0U, static_cast<stop_idx_t>(
+                                              stop_seq.size())}},
+              info.enter_, info.exit_});
+
+      auto const& parent_bag = state_.bags_[info.parent_.bag_];
+      l = enter_l;
+      time = parent_bag.time_[info.parent_.slot_];
+      info = state_.infos_[info.parent_.bag_][info.parent_.slot_];
+      is_last = false;
+    }
+
+    // Start: l is a start location or reached from one via start footpath.
+    add_start_legs(q, j, l, time, legs);
+
+    std::reverse(begin(legs), end(legs));
+    j.legs_ = std::move(legs);
+  }
+
+private:
+  static bool is_better(auto a, auto b) { return a < b; }
+  static bool is_better_or_eq(auto a, auto b) { return a <= b; }
+  static auto get_best(auto a, auto b) { return is_better(a, b) ? a : b; }
+
+  date::sys_days base() const {
+    return tt_.internal_interval_days().from_ + as_int(base_) * date::days{1};
+  }
+
+  void update_route(unsigned const k, route_idx_t const r) {
+    auto const stop_seq = tt_.route_location_seq_[r];
+
+    auto route_bag = std::array<route_label, kMcBagSize>{};
+    auto n_route_labels = 0U;
+
+    for (auto i = 0U; i != stop_seq.size(); ++i) {
+      auto const stop_idx = static_cast<stop_idx_t>(i);
+      auto const stp = stop{stop_seq[stop_idx]};
+      auto const l_idx = to_idx(stp.location_idx());
+
+      if (n_route_labels != 0U && stp.can_finish<SearchDir>(is_wheelchair_)) {
+        for (auto const& rl : std::span{route_bag.data(), n_route_labels}) {
+          add_arrival(
+              k, l_idx, time_at_stop(r, rl.t_, stop_idx, event_type::kArr),
+              rl.walk_,
+              mc_label_info{.t_ = rl.t_,
+                            .enter_ = rl.enter_,
+                            .exit_ = stop_idx,
+                            .fp_from_ = location_idx_t::invalid(),
+                            .parent_ = rl.parent_});
+        }
+      }
+
+      if (lb_[l_idx] == kUnreachable) {
+        break;
+      }
+
+      if (i == stop_seq.size() - 1U ||
+          !stp.can_start<SearchDir>(is_wheelchair_) ||
+          !state_.prev_station_mark_[l_idx]) {
+        continue;
+      }
+
+      auto const bag_idx = state_.bag_idx(k - 1U, l_idx);
+      auto const& bag = state_.bags_[bag_idx];
+      for (auto slot = 0U; slot != kMcBagSize; ++slot) {
+        if (bag.time_[slot] == kInvalid) {
+          continue;
+        }
+
+        auto const [day, mam] = split_day_mam(base_, bag.time_[slot]);
+        auto const et = get_earliest_transport(r, stop_idx, day, mam);
+        if (!et.is_valid()) {
+          continue;
+        }
+
+        // Route labels are compared by their departure at the current stop.
+        // Since routes are FIFO, this order holds for all following stops.
+        auto const dep = time_at_stop(r, et, stop_idx, event_type::kDep);
+        auto const walk = bag.walk_[slot];
+        auto dominated = false;
+        auto n_kept = 0U;
+        for (auto x = 0U; x != n_route_labels; ++x) {
+          auto const x_dep =
+              time_at_stop(r, route_bag[x].t_, stop_idx, event_type::kDep);
+          if (x_dep <= dep && route_bag[x].walk_ <= walk) {
+            dominated = true;
+            break;
+          }
+          if (!(dep <= x_dep && walk <= route_bag[x].walk_)) {
+            route_bag[n_kept++] = route_bag[x];
+          }
+        }
+        if (dominated) {
+          continue;
+        }
+        n_route_labels = n_kept;
+        if (n_route_labels == kMcBagSize) {
+          ++stats_.n_route_labels_dropped_;
+          continue;
+        }
+        route_bag[n_route_labels++] = route_label{
+            .t_ = et,
+            .enter_ = stop_idx,
+            .walk_ = walk,
+            .parent_ = {.bag_ = bag_idx,
+                        .slot_ = static_cast<std::uint8_t>(slot)}};
+      }
+    }
+  }
+
+  void update_footpaths(unsigned const k, profile_idx_t const prf_idx) {
+    state_.tmp_mark_.for_each_set_bit([&](std::uint64_t const i) {
+      auto const l = location_idx_t{i};
+      auto const bag_idx = state_.bag_idx(kTmpRound, l.v_);
+
+      for (auto slot = 0U; slot != kMcBagSize; ++slot) {
+        auto const& bag = state_.bags_[bag_idx];
+        auto const arr = bag.time_[slot];
+        if (arr == kInvalid) {
+          continue;
+        }
+        auto const walk = bag.walk_[slot];
+        auto const info = state_.infos_[bag_idx][slot];
+
+        add_dest(k, l, arr, walk, info);
+
+        add_label(k, l,
+                  clamp(arr + adjusted_transfer_time(
+                                  transfer_time_settings_,
+                                  tt_.locations_.transfer_time_[l].count())),
+                  walk, info);
+
+        auto fp_info = info;
+        fp_info.fp_from_ = l;
+        for (auto const& fp : tt_.locations_.footpaths_out_[prf_idx][l]) {
+          ++stats_.n_footpaths_visited_;
+          auto const duration = adjusted_transfer_time(transfer_time_settings_,
+                                                       fp.duration().count());
+          auto const fp_arr = clamp(arr + duration);
+          auto const fp_walk = static_cast<mc_walk_t>(
+              std::min(walk + duration, kMcInvalidWalk - 1));
+          add_dest(k, fp.target(), fp_arr, fp_walk, fp_info);
+          add_label(k, fp.target(), fp_arr, fp_walk, fp_info);
+        }
+      }
+    });
+
+    state_.free_bags(kTmpRound, state_.tmp_mark_);
+    state_.tmp_mark_.reset();
+  }
+
+  // Transit arrival (without transfer time) at stop l in round k.
+  void add_arrival(unsigned const k,
+                   std::uint32_t const l,
+                   delta_t const time,
+                   mc_walk_t const walk,
+                   mc_label_info const& info) {
+    if (is_pruned(k, l, time, walk)) {
+      return;
+    }
+    auto const bag = state_.get_or_create_bag(kTmpRound, l, kInvalid);
+    if (insert(bag, time, walk, info) != kMcBagSize) {
+      state_.tmp_mark_.set(l);
+    }
+  }
+
+  // Label at stop l in round k, ready to depart.
+  void add_label(unsigned const k,
+                 location_idx_t const l,
+                 delta_t const time,
+                 mc_walk_t const walk,
+                 mc_label_info const& info) {
+    if (is_pruned(k, to_idx(l), time, walk)) {
+      return;
+    }
+    auto const bag = state_.get_or_create_bag(k, to_idx(l), kInvalid);
+    if (insert(bag, time, walk, info) != kMcBagSize) {
+      state_.station_mark_.set(to_idx(l));
+    }
+  }
+
+  void add_dest(unsigned const k,
+                location_idx_t const l,
+                delta_t const time,
+                mc_walk_t const walk,
+                mc_label_info const& info) {
+    auto egress = 0_minutes;
+    if (is_intermodal_dest()) {
+      if (dist_to_end_[to_idx(l)] == kUnreachable) {
+        return;
+      }
+      egress = duration_t{dist_to_end_[to_idx(l)]};
+    } else if (!is_dest_[to_idx(l)]) {
+      return;
+    }
+
+    auto const dest_time = clamp(time + egress.count());
+    auto const dest_walk = static_cast<mc_walk_t>(
+        std::min(walk + egress.count(), kMcInvalidWalk - 1));
+    if (!is_better(dest_time, worst_at_dest_)) {
+      return;
+    }
+
+    for (auto const& d : dest_) {
+      if (d.k_ <= k && is_better_or_eq(d.time_, dest_time) &&
+          d.walk_ <= dest_walk) {
+        return;
+      }
+    }
+    std::erase_if(dest_, [&](dest_label const& d) {
+      return k <= d.k_ && is_better_or_eq(dest_time, d.time_) &&
+             dest_walk <= d.walk_;
+    });
+    dest_.push_back(dest_label{.time_ = dest_time,
+                               .walk_ = dest_walk,
+                               .k_ = static_cast<std::uint8_t>(k),
+                               .gen_ = gen_,
+                               .l_ = l,
+                               .egress_ = egress,
+                               .info_ = info});
+  }
+
+  // Label pruning: lower bound to the destination, destination labels with
+  // at most k trips and labels at the same stop with fewer trips.
+  bool is_pruned(unsigned const k,
+                 std::uint32_t const l,
+                 delta_t const time,
+                 mc_walk_t const walk) {
+    if (lb_[l] == kUnreachable) {
+      return true;
+    }
+
+    auto const time_lb = clamp(time + lb_[l]);
+    if (!is_better(time_lb, worst_at_dest_)) {
+      ++stats_.n_labels_pruned_by_target_;
+      return true;
+    }
+    for (auto const& d : dest_) {
+      if (d.k_ <= k && is_better_or_eq(d.time_, time_lb) && d.walk_ <= walk) {
+        ++stats_.n_labels_pruned_by_target_;
+        return true;
+      }
+    }
+
+    for (auto prev_k = 0U; prev_k != k; ++prev_k) {
+      auto const bag_idx = state_.bag_idx(prev_k, l);
+      if (bag_idx != mc_label_ref::kInvalid &&
+          is_dominated(state_.bags_[bag_idx], time, walk)) {
+        ++stats_.n_labels_dominated_;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Branch-free over all slots so the compiler can vectorize it.
+  static bool is_dominated(mc_bag const& bag,
+                           delta_t const time,
+                           mc_walk_t const walk) {
+    auto dominated = 0U;
+    for (auto i = 0U; i != kMcBagSize; ++i) {
+      dominated |= static_cast<unsigned>(bag.time_[i] <= time) &
+                   static_cast<unsigned>(bag.walk_[i] <= walk);
+    }
+    return dominated != 0U;
+  }
+
+  // Inserts the label into the bag and removes labels dominated by it.
+  // Returns the slot or kMcBagSize if the label is dominated.
+  unsigned insert(std::uint32_t const bag_idx,
+                  delta_t const time,
+                  mc_walk_t const walk,
+                  mc_label_info const& info) {
+    auto& bag = state_.bags_[bag_idx];
+    if (is_dominated(bag, time, walk)) {
+      ++stats_.n_labels_dominated_;
+      return kMcBagSize;
+    }
+
+    auto free_slot = kMcBagSize;
+    auto worst_slot = 0U;
+    for (auto i = 0U; i != kMcBagSize; ++i) {
+      if (time <= bag.time_[i] && walk <= bag.walk_[i]) {
+        bag.time_[i] = kInvalid;
+        bag.walk_[i] = kMcInvalidWalk;
+      }
+      if (bag.time_[i] == kInvalid) {
+        free_slot = i;
+      } else if (is_better(bag.time_[worst_slot], bag.time_[i])) {
+        worst_slot = i;
+      }
+    }
+
+    if (free_slot == kMcBagSize) {
+      if (!is_better(time, bag.time_[worst_slot])) {
+        ++stats_.n_labels_evicted_;
+        return kMcBagSize;
+      }
+      ++stats_.n_labels_evicted_;
+      free_slot = worst_slot;
+    }
+
+    ++stats_.n_labels_created_;
+    bag.time_[free_slot] = time;
+    bag.walk_[free_slot] = walk;
+    state_.infos_[bag_idx][free_slot] = info;
+    return free_slot;
+  }
+
+  transport get_earliest_transport(route_idx_t const r,
+                                   stop_idx_t const stop_idx,
+                                   day_idx_t const day_at_stop,
+                                   minutes_after_midnight_t const mam_at_stop) {
+    ++stats_.n_earliest_trip_calls_;
+
+    auto const n_days_to_iterate = std::min(kMaxTravelTime.count() / 1440 + 1,
+                                            n_days_ - as_int(day_at_stop));
+    auto const event_times =
+        tt_.event_times_at_stop(r, stop_idx, event_type::kDep);
+
+    for (auto i = day_idx_t::value_t{0U}; i < n_days_to_iterate; ++i) {
+      auto const day = day_at_stop + i;
+      auto const from =
+          i == 0U ? linear_lb(begin(event_times), end(event_times),
+                              mam_at_stop,
+                              [](delta const a,
+                                 minutes_after_midnight_t const b) {
+                                return a.mam() < b.count();
+                              })
+                  : begin(event_times);
+      for (auto it = from; it != end(event_times); ++it) {
+        if (i == 0U && mam_at_stop.count() > it->mam()) {
+          continue;
+        }
+        auto const t_offset =
+            static_cast<std::size_t>(&*it - event_times.data());
+        auto const t = tt_.route_transport_ranges_[r][t_offset];
+        auto const start_day = as_int(day) - it->days();
+        if (tt_.bitfields_[tt_.transport_traffic_days_[t]].test(
+                static_cast<std::size_t>(start_day))) {
+          return {t, static_cast<day_idx_t>(start_day)};
+        }
+      }
+    }
+    return {};
+  }
+
+  // Appends the legs from the start to l, reached at the given time. Like
+  // all legs in reconstruct(), they are appended in reverse order.
+  void add_start_legs(query const& q,
+                      journey const& j,
+                      location_idx_t const l,
+                      delta_t const time,
+                      std::vector<journey::leg>& legs) const {
+    auto const is_intermodal =
+        q.start_match_mode_ == location_match_mode::kIntermodal;
+    auto const start_matches = [&](location_idx_t const x) {
+      return utl::any_of(q.start_, [&](offset const& o) {
+        return matches(tt_, q.start_match_mode_, o.target(), x);
+      });
+    };
+
+    // Offset to x that reaches l with the remaining walk in time.
+    auto const get_offset = [&](location_idx_t const x,
+                                duration_t const walk) -> offset const* {
+      auto const it = utl::find_if(q.start_, [&](offset const& o) {
+        return matches(tt_, q.start_match_mode_, o.target(), x) &&
+               is_better_or_eq(j.start_time_ + o.duration() + walk,
+                               to_unix(time));
+      });
+      return it == end(q.start_) ? nullptr : &*it;
+    };
+
+    if (is_intermodal) {
+      if (auto const o = get_offset(l, 0_minutes); o != nullptr) {
+        legs.emplace_back(SearchDir,
+                          get_special_station(special_station::kStart), l,
+                          j.start_time_, j.start_time_ + o->duration(), *o);
+        return;
+      }
+    } else if (start_matches(l)) {
+      return;
+    }
+
+    for (auto const& fp : tt_.locations_.footpaths_in_[q.prf_idx_][l]) {
+      auto const duration =
+          adjusted_transfer_time(transfer_time_settings_, fp.duration());
+      if (is_intermodal) {
+        if (auto const o = get_offset(fp.target(), duration); o != nullptr) {
+          auto const fp_dep = j.start_time_ + o->duration();
+          legs.emplace_back(SearchDir, fp.target(), l, fp_dep,
+                            fp_dep + duration, footpath{l, duration});
+          legs.emplace_back(SearchDir,
+                            get_special_station(special_station::kStart),
+                            fp.target(), j.start_time_, fp_dep, *o);
+          return;
+        }
+      } else if (start_matches(fp.target())) {
+        legs.emplace_back(SearchDir, fp.target(), l, to_unix(time) - duration,
+                          to_unix(time), footpath{l, duration});
+        return;
+      }
+    }
+
+    throw utl::fail("mc_raptor: no valid journey start found for {}",
+                    location{tt_, l});
+  }
+
+  offset get_dest_offset(query const& q,
+                         location_idx_t const l,
+                         duration_t const egress) const {
+    for (auto const& o : q.destination_) {
+      if (o.duration() == egress &&
+          matches(tt_, q.dest_match_mode_, o.target(), l)) {
+        return o;
+      }
+    }
+    throw utl::fail("mc_raptor: no destination offset found for {}",
+                    location{tt_, l});
+  }
+
+  delta_t time_at_stop(route_idx_t const r,
+                       transport const t,
+                       stop_idx_t const stop_idx,
+                       event_type const ev_type) const {
+    return clamp((as_int(t.day_) - as_int(base_)) * 1440 +
+                 tt_.event_mam(r, t.t_idx_, stop_idx, ev_type).count());
+  }
+
+  unixtime_t to_unix(delta_t const t) const {
+    return delta_to_unix(base(), t);
+  }
+
+  bool is_intermodal_dest() const { return !dist_to_end_.empty(); }
+
+  int as_int(day_idx_t const d) const { return static_cast<int>(d.v_); }
+
+  timetable const& tt_;
+  int n_days_;
+  mc_raptor_state& state_;
+  bitvec const& is_dest_;
+  std::vector<std::uint16_t> const& dist_to_end_;
+  std::vector<std::uint16_t> const& lb_;
+  std::vector<dest_label> dest_;
+  delta_t worst_at_dest_{kInvalid};
+  std::uint32_t gen_{0U};
+  day_idx_t base_;
+  mc_raptor_stats stats_;
+  clasz_mask_t allowed_claszes_;
+  bool require_bike_transport_;
+  bool is_wheelchair_;
+  transfer_time_settings transfer_time_settings_;
+};
+
+}  // namespace nigiri::routing
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cinttypes>
+#include <limits>
+#include <vector>
+
+#include "nigiri/common/delta_t.h"
+#include "nigiri/routing/limits.h"
+#include "nigiri/routing/raptor/mark_set.h"
+#include "nigiri/types.h"
+
+namespace nigiri::routing {
+
+// Maximum number of labels per (round, stop) bag.
+constexpr auto const kMcBagSize = 8U;
+
+using mc_walk_t = std::uint16_t;
+
+constexpr auto const kMcInvalidWalk = std::numeric_limits<mc_walk_t>::max();
+
+struct mc_label_ref {
+  static constexpr auto const kInvalid =
+      std::numeric_limits<std::uint32_t>::max();
+
+  bool is_valid() const { return bag_ != kInvalid; }
+
+  std::uint32_t bag_{kInvalid};
+  std::uint8_t slot_{0U};
+};
+
+// Information only needed for journey reconstruction (cold data).
+// Start labels have an invalid transport.
+struct mc_label_info {
+  // transport that was used to reach the label's stop
+  transport t_{};
+  stop_idx_t enter_{0U}, exit_{0U};
+
+  // set if the label was reached by walking from the exit stop of t_
+  location_idx_t fp_from_{location_idx_t::invalid()};
+
+  // label at the stop where t_ was entered (previous round)
+  mc_label_ref parent_{};
+};
+
+// Fixed-size bag: the criteria of all slots are stored in separate arrays so
+// that dominance checks over all slots compile to a few SIMD compares.
+// Empty slots hold kInvalid times and never dominate anything.
+struct mc_bag {
+  alignas(16) std::array<delta_t, kMcBagSize> time_;
+  alignas(16) std::array<mc_walk_t, kMcBagSize> walk_;
+};
+
+struct mc_raptor_state {
+  mc_raptor_state() = default;
+  mc_raptor_state(mc_raptor_state const&) = delete;
+  mc_raptor_state& operator=(mc_raptor_state const&) = delete;
+  mc_raptor_state(mc_raptor_state&&) = default;
+  mc_raptor_state& operator=(mc_raptor_state&&) = default;
+  ~mc_raptor_state() = default;
+
+  mc_raptor_state& resize(unsigned n_locations, unsigned n_routes);
+
+  // Bag of stop l in round k (kMaxTransfers + 1 = temporary arrival bags).
+  std::uint32_t& bag_idx(unsigned const k, std::uint32_t const l) {
+    return bag_idx_[k * n_locations_ + l];
+  }
+
+  std::uint32_t bag_idx(unsigned const k, std::uint32_t const l) const {
+    return bag_idx_[k * n_locations_ + l];
+  }
+
+  // Returns the bag of stop l in round k. Allocates an empty bag (all times
+  // set to `invalid`) from the pool if there is none, yet.
+  std::uint32_t get_or_create_bag(unsigned k, std::uint32_t l, delta_t invalid);
+
+  // Returns all bags of round k for the given stops to the pool.
+  void free_bags(unsigned k, mark_set& stops);
+
+  // Returns all bags to the pool.
+  void clear_bags();
+
+  unsigned n_locations_{};
+
+  // (kMaxTransfers + 2) x n_locations: index into bags_ or kInvalid
+  std::vector<std::uint32_t> bag_idx_;
+  std::vector<std::uint32_t> used_bag_idx_;
+
+  // pooled bag storage (hot criteria + cold reconstruction info)
+  std::vector<mc_bag> bags_;
+  std::vector<std::array<mc_label_info, kMcBagSize>> infos_;
+  std::vector<std::uint32_t> free_bags_;
+
+  mark_set station_mark_;
+  mark_set prev_station_mark_;
+  mark_set route_mark_;
+  mark_set tmp_mark_;
+};
+
+}  // namespace nigiri::routing
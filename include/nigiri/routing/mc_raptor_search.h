@@ -0,0 +1,18 @@
+#pragma once
+
+#include "nigiri/routing/mc_raptor/mc_raptor.h"
+#include "nigiri/routing/search.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::routing {
+
+// Forward multi-criteria search (arrival time, transfers, walking time) on
+// the static timetable. Via stops are not supported.
+routing_result<mc_raptor_stats> mc_raptor_search(
+    timetable const& tt,
+    search_state& s_state,
+    mc_raptor_state& mc_state,
+    query q,
+    std::optional<std::chrono::seconds> timeout = std::nullopt);
+
+}  // namespace nigiri::routing
@@ -1,14 +1,22 @@
 #pragma once
 
+#include <vector>
+
+#include "nigiri/routing/journey.h"
+#include "nigiri/routing/pareto_set.h"
 #include "nigiri/routing/query.h"
 
 namespace nigiri {
 struct timetable;
+struct rt_timetable;
 struct transport;
 }  // namespace nigiri
 
 namespace nigiri::routing {
 
+struct search_state;
+struct raptor_state;
+
 // Takes a concrete transport and query settings from an existing query object
 // and generates an ontrip-train query by filling in offsets for all stops along
 // the train's stop sequence starting with the given stop_idx.
@@ -17,4 +25,24 @@ void generate_ontrip_train_query(timetable const&,
                                  stop_idx_t,
                                  query&);
 
+struct ontrip_train_result {
+  stop_idx_t stop_idx_;
+  pareto_set<journey> journeys_;
+};
+
+// Batch version of generate_ontrip_train_query() + raptor_search() for all
+// passengers of a transport: computes the results for every stop_idx in
+// [first_stop_idx, n_stops) with a single multi-source forward RAPTOR.
+// The stops are added from the last to the first one without resetting the
+// arrival labels (like rRAPTOR does for start times). Each result equals the
+// result of the ontrip-train query for its stop_idx. Query settings
+// (destination, filters, transfer time settings, etc.) are taken from `q`.
+std::vector<ontrip_train_result> ontrip_train_search(timetable const&,
+                                                     rt_timetable const*,
+                                                     search_state&,
+                                                     raptor_state&,
+                                                     transport const&,
+                                                     stop_idx_t first_stop_idx,
+                                                     query q);
+
 }  // namespace nigiri::routing
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <vector>
+
+#include "nigiri/types.h"
+
+namespace nigiri::routing {
+
+// Set of marked indices (stations, routes, rt transports) for one RAPTOR round.
+// As long as only few indices are marked, they are additionally collected in a
+// queue. Iteration then visits the sorted queue instead of scanning all blocks
+// of the bitvec and reset() only clears the touched bits. Once the number of
+// marked indices exceeds size / kDenseDivisor, the queue is dropped and the
+// set falls back to plain bitvec scanning.
+struct mark_set {
+  static constexpr auto const kDenseDivisor = 64U;
+
+  void resize(std::uint32_t const n) {
+    reset();
+    bits_.resize(n);
+    queue_.reserve(n / kDenseDivisor + 1U);
+  }
+
+  void set(std::uint64_t const i) {
+    if (bits_[i]) {
+      return;
+    }
+    bits_.set(i, true);
+    if (!dense_) {
+      if (queue_.size() >= bits_.size() / kDenseDivisor) {
+        dense_ = true;
+      } else {
+        queue_.emplace_back(static_cast<std::uint32_t>(i));
+      }
+    }
+  }
+
+  bool operator[](std::uint64_t const i) const { return bits_[i]; }
+
+  bool is_dense() const { return dense_; }
+
+  template <typename Fn>
+  void for_each_set_bit(Fn&& f) {
+    if (dense_) {
+      bits_.for_each_set_bit(std::forward<Fn>(f));
+    } else {
+      std::sort(begin(queue_), end(queue_));
+      for (auto const i : queue_) {
+        f(static_cast<std::uint64_t>(i));
+      }
+    }
+  }
+
+  void reset() {
+    if (dense_) {
+      std::fill(begin(bits_.blocks_), end(bits_.blocks_), 0U);
+    } else {
+      for (auto const i : queue_) {
+        bits_.set(i, false);
+      }
+    }
+    queue_.clear();
+    dense_ = false;
+  }
+
+  bitvec bits_;
+  std::vector<std::uint32_t> queue_;
+  bool dense_{false};
+};
+
+}  // namespace nigiri::routing
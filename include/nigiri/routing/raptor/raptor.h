@@ -33,6 +33,13 @@ struct raptor_stats {
          fp_update_prevented_by_lower_bound_},
         {"route_update_prevented_by_lower_bound",
          route_update_prevented_by_lower_bound_},
+        {"n_station_mark_rounds_sparse", n_station_mark_rounds_sparse_},
+        {"n_station_mark_rounds_dense", n_station_mark_rounds_dense_},
+        {"n_route_mark_rounds_sparse", n_route_mark_rounds_sparse_},
+        {"n_route_mark_rounds_dense", n_route_mark_rounds_dense_},
+        {"n_rt_transport_mark_rounds_sparse",
+         n_rt_transport_mark_rounds_sparse_},
+        {"n_rt_transport_mark_rounds_dense", n_rt_transport_mark_rounds_dense_},
     };
   }
 
@@ -44,9 +51,45 @@ struct raptor_stats {
   std::uint64_t n_earliest_arrival_updated_by_footpath_{0ULL};
   std::uint64_t fp_update_prevented_by_lower_bound_{0ULL};
   std::uint64_t route_update_prevented_by_lower_bound_{0ULL};
+
+  // Per round: was the mark set iterated as sorted queue (sparse) or by
+  // scanning the whole bitvec (dense)?
+  std::uint64_t n_station_mark_rounds_sparse_{0ULL};
+  std::uint64_t n_station_mark_rounds_dense_{0ULL};
+  std::uint64_t n_route_mark_rounds_sparse_{0ULL};
+  std::uint64_t n_route_mark_rounds_dense_{0ULL};
+  std::uint64_t n_rt_transport_mark_rounds_sparse_{0ULL};
+  std::uint64_t n_rt_transport_mark_rounds_dense_{0ULL};
+};
+
+// Query features that require runtime checks in the inner loops.
+// Queries that don't use any of them are dispatched to a specialization
+// (kNoRaptorFeatures) without these checks.
+struct raptor_features {
+  // time-dependent footpaths (rt_timetable::td_footpaths_*, only with Rt)
+  bool td_footpaths_{true};
+
+  // non-default transfer_time_settings
+  bool transfer_time_settings_{true};
+
+  // wheelchair profile (in/out allowed wheelchair)
+  bool wheelchair_{true};
+
+  // location_match_mode::kIntermodal destination
+  bool intermodal_dest_{true};
 };
 
-template <direction SearchDir, bool Rt, via_offset_t Vias>
+constexpr auto const kAllRaptorFeatures = raptor_features{};
+constexpr auto const kNoRaptorFeatures = raptor_features{
+    .td_footpaths_ = false,
+    .transfer_time_settings_ = false,
+    .wheelchair_ = false,
+    .intermodal_dest_ = false};
+
+template <direction SearchDir,
+          bool Rt,
+          via_offset_t Vias,
+          raptor_features Features = kAllRaptorFeatures>
 struct raptor {
   using algo_state_t = raptor_state;
   using algo_stats_t = raptor_stats;
@@ -59,6 +102,8 @@ struct raptor {
       std::numeric_limits<std::uint16_t>::max();
   static constexpr auto const kIntermodalTarget =
       to_idx(get_special_station(special_station::kEnd));
+  static constexpr auto const kNoRtRouteTransport =
+      std::numeric_limits<std::uint32_t>::max();
   static constexpr auto const kInvalidArray = []() {
     auto a = std::array<delta_t, Vias + 1>{};
     a.fill(kInvalid);
@@ -95,7 +140,10 @@ struct raptor {
         n_locations_{tt_.n_locations()},
         n_routes_{tt.n_routes()},
         n_rt_transports_{Rt ? rtt->n_rt_transports() : 0U},
-        state_{state.resize(n_locations_, n_routes_, n_rt_transports_)},
+        n_rt_routes_{Rt && rtt->has_rt_routes() ? rtt->n_rt_routes() : 0U},
+        use_rt_routes_{Rt && rtt->has_rt_routes()},
+        state_{state.resize(n_locations_, n_routes_, n_rt_transports_,
+                            n_rt_routes_)},
         tmp_{state_.get_tmp<Vias>()},
         best_{state_.get_best<Vias>()},
         round_times_{state.get_round_times<Vias>()},
@@ -111,6 +159,10 @@ struct raptor {
         is_wheelchair_{is_wheelchair},
         transfer_time_settings_{tts} {
     assert(Vias == via_stops_.size());
+    assert(Features.wheelchair_ || !is_wheelchair_);
+    assert(Features.transfer_time_settings_ ||
+           transfer_time_settings_.default_);
+    assert(Features.intermodal_dest_ || dist_to_end_.empty());
     reset_arrivals();
     // only used for intermodal queries (dist_to_dest != empty)
     for (auto i = 0U; i != dist_to_dest.size(); ++i) {
@@ -131,11 +183,12 @@ struct raptor {
   void next_start_time() {
     utl::fill(best_, kInvalidArray);
     utl::fill(tmp_, kInvalidArray);
-    utl::fill(state_.prev_station_mark_.blocks_, 0U);
-    utl::fill(state_.station_mark_.blocks_, 0U);
-    utl::fill(state_.route_mark_.blocks_, 0U);
+    state_.prev_station_mark_.reset();
+    state_.station_mark_.reset();
+    state_.route_mark_.reset();
     if constexpr (Rt) {
-      utl::fill(state_.rt_transport_mark_.blocks_, 0U);
+      state_.rt_transport_mark_.reset();
+      state_.rt_route_mark_.reset();
     }
   }
 
@@ -144,7 +197,7 @@ struct raptor {
     trace_upd("adding start {}: {}, v={}\n", location{tt_, l}, t, v);
     best_[to_idx(l)][v] = unix_to_delta(base(), t);
     round_times_[0U][to_idx(l)][v] = unix_to_delta(base(), t);
-    state_.station_mark_.set(to_idx(l), true);
+    state_.station_mark_.set(to_idx(l));
   }
 
   void execute(unixtime_t const start_time,
@@ -175,13 +228,21 @@ struct raptor {
       state_.station_mark_.for_each_set_bit([&](std::uint64_t const i) {
         for (auto const& r : tt_.location_routes_[location_idx_t{i}]) {
           any_marked = true;
-          state_.route_mark_.set(to_idx(r), true);
+          state_.route_mark_.set(to_idx(r));
         }
         if constexpr (Rt) {
-          for (auto const& rt_t :
-               rtt_->location_rt_transports_[location_idx_t{i}]) {
-            any_marked = true;
-            state_.rt_transport_mark_.set(to_idx(rt_t), true);
+          if (use_rt_routes_) {
+            for (auto const& rt_r :
+                 rtt_->location_rt_routes_[location_idx_t{i}]) {
+              any_marked = true;
+              state_.rt_route_mark_.set(to_idx(rt_r));
+            }
+          } else {
+            for (auto const& rt_t :
+                 rtt_->location_rt_transports_[location_idx_t{i}]) {
+              any_marked = true;
+              state_.rt_transport_mark_.set(to_idx(rt_t));
+            }
           }
         }
       });
@@ -191,8 +252,19 @@ struct raptor {
         break;
       }
 
+      count_mode(state_.station_mark_, stats_.n_station_mark_rounds_sparse_,
+                 stats_.n_station_mark_rounds_dense_);
+      count_mode(state_.route_mark_, stats_.n_route_mark_rounds_sparse_,
+                 stats_.n_route_mark_rounds_dense_);
+      if constexpr (Rt) {
+        count_mode(use_rt_routes_ ? state_.rt_route_mark_
+                                  : state_.rt_transport_mark_,
+                   stats_.n_rt_transport_mark_rounds_sparse_,
+                   stats_.n_rt_transport_mark_rounds_dense_);
+      }
+
       std::swap(state_.prev_station_mark_, state_.station_mark_);
-      utl::fill(state_.station_mark_.blocks_, 0U);
+      state_.station_mark_.reset();
 
       any_marked =
           (allowed_claszes_ == all_clasz_allowed())
@@ -214,10 +286,14 @@ struct raptor {
         break;
       }
 
-      utl::fill(state_.route_mark_.blocks_, 0U);
+      state_.route_mark_.reset();
+      if constexpr (Rt) {
+        state_.rt_transport_mark_.reset();
+        state_.rt_route_mark_.reset();
+      }
 
       std::swap(state_.prev_station_mark_, state_.station_mark_);
-      utl::fill(state_.station_mark_.blocks_, 0U);
+      state_.station_mark_.reset();
 
       update_transfers(k);
       update_footpaths(k, prf_idx);
@@ -295,6 +371,10 @@ private:
 
   template <bool WithClaszFilter, bool WithBikeFilter>
   bool loop_rt_routes(unsigned const k) {
+    if (use_rt_routes_) {
+      return loop_rt_route_groups<WithClaszFilter, WithBikeFilter>(k);
+    }
+
     auto any_marked = false;
     state_.rt_transport_mark_.for_each_set_bit([&](auto const rt_t_idx) {
       auto const rt_t = rt_transport_idx_t{rt_t_idx};
@@ -328,6 +408,44 @@ private:
     return any_marked;
   }
 
+  // RT routes share stop sequence, section classes and bike info of their
+  // transports. Thus, the filters can be checked on the first transport.
+  template <bool WithClaszFilter, bool WithBikeFilter>
+  bool loop_rt_route_groups(unsigned const k) {
+    auto any_marked = false;
+    state_.rt_route_mark_.for_each_set_bit([&](auto const rt_r_idx) {
+      auto const rt_r = rt_route_idx_t{rt_r_idx};
+      auto const rt_t = rtt_->rt_route_transports_[rt_r][0];
+
+      if constexpr (WithClaszFilter) {
+        if (!is_allowed(allowed_claszes_,
+                        rtt_->rt_transport_section_clasz_[rt_t][0])) {
+          return;
+        }
+      }
+
+      auto section_bike_filter = false;
+      if constexpr (WithBikeFilter) {
+        auto const bikes_allowed_on_all_sections =
+            rtt_->rt_transport_bikes_allowed_.test(to_idx(rt_t) * 2);
+        if (!bikes_allowed_on_all_sections) {
+          auto const bikes_allowed_on_some_sections =
+              rtt_->rt_transport_bikes_allowed_.test(to_idx(rt_t) * 2 + 1);
+          if (!bikes_allowed_on_some_sections) {
+            return;
+          }
+          section_bike_filter = true;
+        }
+      }
+
+      ++stats_.n_routes_visited_;
+      trace("┊ ├k={} updating rt route {}\n", k, rt_r);
+      any_marked |= section_bike_filter ? update_rt_route<true>(k, rt_r)
+                                        : update_rt_route<false>(k, rt_r);
+    });
+    return any_marked;
+  }
+
   void update_transfers(unsigned const k) {
     state_.prev_station_mark_.for_each_set_bit([&](auto&& i) {
       for (auto v = 0U; v != Vias + 1; ++v) {
@@ -351,7 +469,6 @@ private:
             (!is_intermodal_dest() && is_dest)
                 ? 0
                 : dir(adjusted_transfer_time(
-                          transfer_time_settings_,
                           tt_.locations_.transfer_time_[location_idx_t{i}]
                               .count()) +
                       stay.count());
@@ -375,7 +492,7 @@ private:
           ++stats_.n_earliest_arrival_updated_by_footpath_;
           round_times_[k][i][target_v] = fp_target_time;
           best_[i][target_v] = fp_target_time;
-          state_.station_mark_.set(i, true);
+          state_.station_mark_.set(i);
           if (is_dest) {
             update_time_at_dest(k, fp_target_time);
           }
@@ -387,7 +504,7 @@ private:
   void update_footpaths(unsigned const k, profile_idx_t const prf_idx) {
     state_.prev_station_mark_.for_each_set_bit([&](std::uint64_t const i) {
       auto const l_idx = location_idx_t{i};
-      if constexpr (Rt) {
+      if constexpr (Rt && Features.td_footpaths_) {
         if (prf_idx != 0U && (kFwd ? rtt_->has_td_footpaths_out_
                                    : rtt_->has_td_footpaths_in_)[prf_idx]
                                  .test(l_idx)) {
@@ -424,10 +541,10 @@ private:
             stay += via_stops_[start_v].stay_;
           }
 
-          auto const fp_target_time = clamp(
-              tmp_time + dir(adjusted_transfer_time(transfer_time_settings_,
-                                                    fp.duration().count()) +
-                             stay.count()));
+          auto const fp_target_time =
+              clamp(tmp_time + dir(adjusted_transfer_time(
+                                       fp.duration().count()) +
+                                   stay.count()));
 
           if (is_better(fp_target_time, best_[target][target_v]) &&
               is_better(fp_target_time, time_at_dest_[k])) {
@@ -440,8 +557,7 @@ private:
                   "┊ ├k={} *** LB NO UPD: (from={}, tmp={}) --{}--> (to={}, "
                   "best={}) --> update => {}, LB={}, LB_AT_DEST={}, DEST={}\n",
                   k, location{tt_, l_idx}, to_unix(tmp_[to_idx(l_idx)][v]),
-                  adjusted_transfer_time(transfer_time_settings_,
-                                         fp.duration()),
+                  adjusted_transfer_time(fp.duration()),
                   location{tt_, fp.target()}, best_[target][target_v],
                   to_unix(fp_target_time), lower_bound,
                   to_unix(clamp(fp_target_time + dir(lower_bound))),
@@ -453,14 +569,14 @@ private:
                 "┊ ├k={}   footpath: ({}, tmp={}) --{}--> ({}, best={}) --> "
                 "update => {}, v={}->{}, stay={}\n",
                 k, location{tt_, l_idx}, to_unix(tmp_[to_idx(l_idx)][v]),
-                adjusted_transfer_time(transfer_time_settings_, fp.duration()),
+                adjusted_transfer_time(fp.duration()),
                 location{tt_, fp.target()}, to_unix(best_[target][target_v]),
                 to_unix(fp_target_time), v, target_v, stay);
 
             ++stats_.n_earliest_arrival_updated_by_footpath_;
             round_times_[k][target][target_v] = fp_target_time;
             best_[target][target_v] = fp_target_time;
-            state_.station_mark_.set(target, true);
+            state_.station_mark_.set(target);
             if (target_v == Vias && is_dest_[target]) {
               update_time_at_dest(k, fp_target_time);
             }
@@ -470,7 +586,7 @@ private:
                 "[best={}, time_at_dest={}]\n",
                 k, location{tt_, l_idx},
                 to_unix(best_[to_idx(l_idx)][target_v]),
-                adjusted_transfer_time(transfer_time_settings_, fp.duration()),
+                adjusted_transfer_time(fp.duration()),
                 location{tt_, fp.target()}, to_unix(best_[target][target_v]),
                 to_unix(time_at_dest_[k]));
           }
@@ -480,7 +596,7 @@ private:
   }
 
   void update_td_offsets(unsigned const k, profile_idx_t const prf_idx) {
-    if constexpr (!Rt) {
+    if constexpr (!Rt || !Features.td_footpaths_) {
       return;
     }
 
@@ -558,7 +674,7 @@ private:
             ++stats_.n_earliest_arrival_updated_by_footpath_;
             round_times_[k][target][target_v] = fp_target_time;
             best_[target][target_v] = fp_target_time;
-            state_.station_mark_.set(target, true);
+            state_.station_mark_.set(target);
             if (is_dest_[target]) {
               update_time_at_dest(k, fp_target_time);
             }
@@ -567,7 +683,7 @@ private:
                 "┊ ├k={}   NO TD FP UPDATE: {} [best={}] --{}--> {} "
                 "[best={}, time_at_dest={}]\n",
                 k, location{tt_, l_idx}, best_[to_idx(l_idx)][v],
-                adjusted_transfer_time(transfer_time_settings_, fp.duration()),
+                adjusted_transfer_time(fp.duration()),
                 location{tt_, fp.target()}, best_[target][v],
                 to_unix(time_at_dest_[k]));
           }
@@ -579,7 +695,7 @@ private:
   }
 
   void update_intermodal_footpaths(unsigned const k) {
-    if (dist_to_end_.empty()) {
+    if (!is_intermodal_dest()) {
       return;
     }
 
@@ -661,7 +777,7 @@ private:
         for (auto j = 0U; j != Vias + 1; ++j) {
           auto const v = Vias - j;
           auto target_v = v + v_offset[v];
-          if (et[v] && stp.can_finish<SearchDir>(is_wheelchair_)) {
+          if (et[v] && stp.can_finish<SearchDir>(is_wheelchair())) {
             auto const is_via = target_v != Vias && is_via_[target_v][l_idx] &&
                                 via_stops_[target_v].stay_ == 0_minutes;
             if (is_via) {
@@ -697,7 +813,7 @@ private:
               ++stats_.n_earliest_arrival_updated_by_route_;
               tmp_[l_idx][target_v] =
                   get_best(by_transport, tmp_[l_idx][target_v]);
-              state_.station_mark_.set(l_idx, true);
+              state_.station_mark_.set(l_idx);
               current_best = by_transport;
               any_marked = true;
             }
@@ -709,7 +825,7 @@ private:
         break;
       }
 
-      if (is_last || !(stp.can_start<SearchDir>(is_wheelchair_)) ||
+      if (is_last || !(stp.can_start<SearchDir>(is_wheelchair())) ||
           !state_.prev_station_mark_[l_idx]) {
         continue;
       }
@@ -728,6 +844,174 @@ private:
     return any_marked;
   }
 
+  // Same trip scan as update_route() on the column-major event times of an
+  // RT route. Transports are referenced by their position in the RT route.
+  template <bool WithSectionBikeFilter>
+  bool update_rt_route(unsigned const k, rt_route_idx_t const r) {
+    auto const first_rt_t = rtt_->rt_route_transports_[r][0];
+    auto const stop_seq = rtt_->rt_transport_location_seq_[first_rt_t];
+    auto any_marked = false;
+
+    auto et = std::array<std::uint32_t, Vias + 1>{};
+    et.fill(kNoRtRouteTransport);
+    auto v_offset = std::array<std::size_t, Vias + 1>{};
+
+    for (auto i = 0U; i != stop_seq.size(); ++i) {
+      auto const stop_idx =
+          static_cast<stop_idx_t>(kFwd ? i : stop_seq.size() - i - 1U);
+      auto const stp = stop{stop_seq[stop_idx]};
+      auto const l_idx = cista::to_idx(stp.location_idx());
+      auto const is_first = i == 0U;
+      auto const is_last = i == stop_seq.size() - 1U;
+
+      auto current_best = std::array<delta_t, Vias + 1>{};
+      current_best.fill(kInvalid);
+
+      for (auto j = 0U; j != Vias + 1; ++j) {
+        auto const v = Vias - j;
+        if (et[v] == kNoRtRouteTransport &&
+            !state_.prev_station_mark_[l_idx]) {
+          continue;
+        }
+
+        if constexpr (WithSectionBikeFilter) {
+          if (!is_first &&
+              !rtt_->rt_bikes_allowed_per_section_[first_rt_t]
+                                                  [kFwd ? stop_idx - 1
+                                                        : stop_idx]) {
+            et[v] = kNoRtRouteTransport;
+            v_offset[v] = 0;
+          }
+        }
+
+        auto target_v = v + v_offset[v];
+        if (et[v] == kNoRtRouteTransport ||
+            !stp.can_finish<SearchDir>(is_wheelchair())) {
+          continue;
+        }
+
+        auto const by_transport = rt_route_time_at_stop(
+            r, et[v], stop_idx, kFwd ? event_type::kArr : event_type::kDep);
+
+        auto const is_via = target_v != Vias && is_via_[target_v][l_idx] &&
+                            via_stops_[target_v].stay_ == 0_minutes;
+        if (is_via) {
+          ++v_offset[v];
+          ++target_v;
+        }
+
+        current_best[v] =
+            get_best(round_times_[k - 1][l_idx][target_v],
+                     tmp_[l_idx][target_v], best_[l_idx][target_v]);
+
+        auto higher_v_best = kInvalid;
+        for (auto higher_v = Vias; higher_v != target_v; --higher_v) {
+          higher_v_best =
+              get_best(higher_v_best, round_times_[k - 1][l_idx][higher_v],
+                       tmp_[l_idx][higher_v], best_[l_idx][higher_v]);
+        }
+
+        if (is_better(by_transport, current_best[v]) &&
+            is_better(by_transport, time_at_dest_[k]) &&
+            is_better(by_transport, higher_v_best) &&
+            lb_[l_idx] != kUnreachable &&
+            is_better(by_transport + dir(lb_[l_idx]), time_at_dest_[k])) {
+          trace_upd(
+              "┊ │k={} v={}->{}    RT route={}, pos={}, time_by_transport={}, "
+              "BETTER THAN current_best={} => update, marking station {}!\n",
+              k, v, target_v, r, et[v], to_unix(by_transport),
+              to_unix(current_best[v]), location{tt_, stp.location_idx()});
+
+          ++stats_.n_earliest_arrival_updated_by_route_;
+          tmp_[l_idx][target_v] =
+              get_best(by_transport, tmp_[l_idx][target_v]);
+          state_.station_mark_.set(l_idx);
+          current_best[v] = by_transport;
+          any_marked = true;
+        }
+      }
+
+      if (is_last || !stp.can_start<SearchDir>(is_wheelchair()) ||
+          !state_.prev_station_mark_[l_idx]) {
+        continue;
+      }
+
+      if (lb_[l_idx] == kUnreachable) {
+        break;
+      }
+
+      for (auto v = 0U; v != Vias + 1; ++v) {
+        auto const target_v = v + v_offset[v];
+        auto const et_time_at_stop =
+            et[v] != kNoRtRouteTransport
+                ? rt_route_time_at_stop(
+                      r, et[v], stop_idx,
+                      kFwd ? event_type::kDep : event_type::kArr)
+                : kInvalid;
+        auto const prev_round_time = round_times_[k - 1][l_idx][target_v];
+        if (prev_round_time != kInvalid &&
+            is_better_or_eq(prev_round_time, et_time_at_stop)) {
+          auto const new_et = get_earliest_rt_route_transport(
+              k, r, stop_idx, prev_round_time, l_idx);
+          current_best[v] = get_best(current_best[v], best_[l_idx][target_v],
+                                     tmp_[l_idx][target_v]);
+          if (new_et != kNoRtRouteTransport &&
+              (current_best[v] == kInvalid ||
+               is_better_or_eq(
+                   rt_route_time_at_stop(
+                       r, new_et, stop_idx,
+                       kFwd ? event_type::kDep : event_type::kArr),
+                   et_time_at_stop))) {
+            et[v] = new_et;
+            v_offset[v] = 0;
+          }
+        }
+      }
+    }
+    return any_marked;
+  }
+
+  // Position of the first (forward) / last (backward) transport of the RT
+  // route that can be reached at the given time.
+  std::uint32_t get_earliest_rt_route_transport(unsigned const k,
+                                                rt_route_idx_t const r,
+                                                stop_idx_t const stop_idx,
+                                                delta_t const time,
+                                                std::uint32_t const l_idx) {
+    ++stats_.n_earliest_trip_calls_;
+
+    auto const times = rtt_->rt_route_event_times(
+        r, stop_idx, kFwd ? event_type::kDep : event_type::kArr);
+    auto const rt_time =
+        time - (as_int(rtt_->base_day_idx_) - as_int(base_)) * 1440;
+
+    auto pos = std::uint32_t{0U};
+    if constexpr (kFwd) {
+      auto const it = std::lower_bound(
+          begin(times), end(times), rt_time,
+          [](delta_t const a, int const b) { return a < b; });
+      if (it == end(times)) {
+        return kNoRtRouteTransport;
+      }
+      pos = static_cast<std::uint32_t>(std::distance(begin(times), it));
+    } else {
+      auto const it = std::upper_bound(
+          begin(times), end(times), rt_time,
+          [](int const a, delta_t const b) { return a < b; });
+      if (it == begin(times)) {
+        return kNoRtRouteTransport;
+      }
+      pos = static_cast<std::uint32_t>(std::distance(begin(times), it) - 1);
+    }
+
+    if (is_better_or_eq(
+            time_at_dest_[k],
+            to_delta(rtt_->base_day_idx_, times[pos]) + dir(lb_[l_idx]))) {
+      return kNoRtRouteTransport;
+    }
+    return pos;
+  }
+
   template <bool WithSectionBikeFilter>
   bool update_route(unsigned const k, route_idx_t const r) {
     auto const stop_seq = tt_.route_location_seq_[r];
@@ -779,7 +1063,7 @@ private:
 
         auto target_v = v + v_offset[v];
 
-        if (et[v].is_valid() && stp.can_finish<SearchDir>(is_wheelchair_)) {
+        if (et[v].is_valid() && stp.can_finish<SearchDir>(is_wheelchair())) {
           auto const by_transport = time_at_stop(
               r, et[v], stop_idx, kFwd ? event_type::kArr : event_type::kDep);
 
@@ -831,7 +1115,7 @@ private:
             ++stats_.n_earliest_arrival_updated_by_route_;
             tmp_[l_idx][target_v] =
                 get_best(by_transport, tmp_[l_idx][target_v]);
-            state_.station_mark_.set(l_idx, true);
+            state_.station_mark_.set(l_idx);
             current_best[v] = by_transport;
             any_marked = true;
           } else {
@@ -873,7 +1157,7 @@ private:
         }
       }
 
-      if (is_last || !stp.can_start<SearchDir>(is_wheelchair_) ||
+      if (is_last || !stp.can_start<SearchDir>(is_wheelchair()) ||
           !state_.prev_station_mark_[l_idx]) {
         continue;
       }
@@ -1044,6 +1328,14 @@ private:
                     rtt_->event_time(rt_t, stop_idx, ev_type));
   }
 
+  delta_t rt_route_time_at_stop(rt_route_idx_t const r,
+                                std::uint32_t const pos,
+                                stop_idx_t const stop_idx,
+                                event_type const ev_type) {
+    return to_delta(rtt_->base_day_idx_,
+                    rtt_->rt_route_event_times(r, stop_idx, ev_type)[pos]);
+  }
+
   delta_t to_delta(day_idx_t const day, std::int16_t const mam) {
     return clamp((as_int(day) - as_int(base_)) * 1440 + mam);
   }
@@ -1054,7 +1346,37 @@ private:
     return split_day_mam(base_, x);
   }
 
-  bool is_intermodal_dest() const { return !dist_to_end_.empty(); }
+  static void count_mode(mark_set const& m,
+                         std::uint64_t& n_sparse,
+                         std::uint64_t& n_dense) {
+    ++(m.is_dense() ? n_dense : n_sparse);
+  }
+
+  bool is_intermodal_dest() const {
+    if constexpr (Features.intermodal_dest_) {
+      return !dist_to_end_.empty();
+    } else {
+      return false;
+    }
+  }
+
+  bool is_wheelchair() const {
+    if constexpr (Features.wheelchair_) {
+      return is_wheelchair_;
+    } else {
+      return false;
+    }
+  }
+
+  template <typename T>
+  T adjusted_transfer_time(T const duration) const {
+    if constexpr (Features.transfer_time_settings_) {
+      return routing::adjusted_transfer_time(transfer_time_settings_,
+                                             duration);
+    } else {
+      return duration;
+    }
+  }
 
   void update_time_at_dest(unsigned const k, delta_t const t) {
     for (auto i = k; i != time_at_dest_.size(); ++i) {
@@ -1085,7 +1407,8 @@ private:
   timetable const& tt_;
   rt_timetable const* rtt_{nullptr};
   int n_days_;
-  std::uint32_t n_locations_, n_routes_, n_rt_transports_;
+  std::uint32_t n_locations_, n_routes_, n_rt_transports_, n_rt_routes_;
+  bool use_rt_routes_;
   raptor_state& state_;
   std::span<std::array<delta_t, Vias + 1>> tmp_;
   std::span<std::array<delta_t, Vias + 1>> best_;
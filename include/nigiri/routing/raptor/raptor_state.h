@@ -12,6 +12,7 @@
 #include "nigiri/common/delta_t.h"
 #include "nigiri/common/flat_matrix_view.h"
 #include "nigiri/routing/limits.h"
+#include "nigiri/routing/raptor/mark_set.h"
 
 namespace nigiri {
 struct timetable;
@@ -29,7 +30,8 @@ struct raptor_state {
 
   raptor_state& resize(unsigned n_locations,
                        unsigned n_routes,
-                       unsigned n_rt_transports);
+                       unsigned n_rt_transports,
+                       unsigned n_rt_routes);
 
   template <via_offset_t Vias>
   void print(timetable const& tt, date::sys_days, delta_t invalid);
@@ -78,10 +80,11 @@ struct raptor_state {
   std::vector<delta_t> tmp_storage_;
   std::vector<delta_t> best_storage_;
   std::vector<delta_t> round_times_storage_;
-  bitvec station_mark_;
-  bitvec prev_station_mark_;
-  bitvec route_mark_;
-  bitvec rt_transport_mark_;
+  mark_set station_mark_;
+  mark_set prev_station_mark_;
+  mark_set route_mark_;
+  mark_set rt_transport_mark_;
+  mark_set rt_route_mark_;
   bitvec end_reachable_;
 };
 
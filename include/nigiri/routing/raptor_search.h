@@ -15,4 +15,82 @@ routing_result<raptor_stats> raptor_search(
     direction search_dir,
     std::optional<std::chrono::seconds> timeout = std::nullopt);
 
+// True if raptor_search() uses the specialization without runtime feature
+// checks (kNoRaptorFeatures) for this query.
+bool is_raptor_feature_free(query const&, bool is_rt);
+
+// Instantiated once in raptor_search.cc (only the two feature extremes).
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 0, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 0, kAllRaptorFeatures>>;
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 1, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 1, kAllRaptorFeatures>>;
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 2, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 2, kAllRaptorFeatures>>;
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 0, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 0, kAllRaptorFeatures>>;
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 1, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 1, kAllRaptorFeatures>>;
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 2, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 2, kAllRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 0, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 0, kAllRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 1, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 1, kAllRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 2, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 2, kAllRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 0, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 0, kAllRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 1, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 1, kAllRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 2, kNoRaptorFeatures>>;
+extern template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 2, kAllRaptorFeatures>>;
+
 }  // namespace nigiri::routing
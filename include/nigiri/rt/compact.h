@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <iosfwd>
+
+#include "nigiri/types.h"
+
+namespace nigiri {
+struct rt_timetable;
+struct timetable;
+}  // namespace nigiri
+
+namespace nigiri::rt {
+
+struct compact_stats {
+  friend std::ostream& operator<<(std::ostream&, compact_stats const&);
+
+  std::uint32_t removed_transports_{0U};
+  std::uint32_t remaining_transports_{0U};
+  std::size_t bytes_reclaimed_{0U};
+};
+
+// Removes all RT transports whose last event is before the cutoff time (and
+// RT transports without events). Remaining RT transports are renumbered
+// (order is preserved), lookups, trip IDs of additional trips and RT routes
+// are rebuilt. Runs holding RT transport indices from before the
+// compaction are invalid afterwards (e.g. vdv::updater::reset_vdv_run_ids_).
+//
+// Can run in the background by passing it as update to an
+// rt_timetable_publisher.
+compact_stats compact(timetable const&, rt_timetable&, unixtime_t cutoff);
+
+}  // namespace nigiri::rt
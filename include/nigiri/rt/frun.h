@@ -2,6 +2,8 @@
 
 #include <functional>
 #include <iosfwd>
+#include <span>
+#include <vector>
 
 #include "geo/latlng.h"
 
@@ -164,8 +166,26 @@ struct frun : public run {
                      rt_timetable const*,
                      transport const) noexcept;
 
+  // Static event time of t_ via the pointers resolved at construction.
+  unixtime_t static_time(stop_idx_t, event_type) const noexcept;
+
+  // Bulk access to the event times of the whole transport.
+  // Event index: stop_idx * 2 - (ev_type == event_type::kArr ? 1 : 0),
+  // as in rt_timetable::rt_transport_stop_times_.
+  void scheduled_times(std::vector<unixtime_t>&) const;
+  void times(std::vector<unixtime_t>&) const;
+
+  // RT event times relative to the rt base day (empty if not RT).
+  std::span<delta_t const> rt_times() const noexcept;
+
   timetable const* tt_;
   rt_timetable const* rtt_;
+
+  // Static event times of t_ (only if scheduled): event i is at
+  // static_times_[i * static_times_stride_] (column-major route stop times).
+  delta const* static_times_{nullptr};
+  std::uint32_t static_times_stride_{0U};
+  unixtime_t static_day_start_{};
 };
 
 }  // namespace nigiri::rt
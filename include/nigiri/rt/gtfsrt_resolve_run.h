@@ -10,6 +10,8 @@ namespace nigiri::rt {
 
 std::pair<date::days, duration_t> split_rounded(duration_t);
 
+// Trips that are not part of the static timetable resolve to the additional
+// trip with the same ID of the RT timetable (if given).
 std::pair<run, trip_idx_t> gtfsrt_resolve_run(
     date::sys_days const today,
     timetable const&,
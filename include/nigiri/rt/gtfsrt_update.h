@@ -32,7 +32,15 @@ struct statistics {
   int trip_update_without_trip_{0};
   int trip_resolve_error_{0};
   int unsupported_schedule_relationship_{0};
+
+  // full dataset: updated transports missing in this message
+  // differential: deleted entities
+  int reverted_{0};
   date::sys_seconds feed_timestamp_{};
+
+  // trip resolution (parallel) + applying the updates (sequential)
+  std::chrono::microseconds resolve_duration_{0};
+  std::chrono::microseconds apply_duration_{0};
 };
 
 statistics gtfsrt_update_msg(timetable const&,
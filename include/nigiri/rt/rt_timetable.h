@@ -1,5 +1,11 @@
 #pragma once
 
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
 #include "utl/pairwise.h"
 
 #include "nigiri/common/delta_t.h"
@@ -16,15 +22,24 @@ using change_callback_t = std::function<void(transport const transport,
                                              duration_t const delay,
                                              bool const cancelled)>;
 
+// Compact record of one changed stop event (see rt_timetable::change_log_).
+struct event_change {
+  transport transport_;
+  stop_idx_t stop_idx_;
+  event_type ev_type_;
+  duration_t delay_;
+  bool cancelled_;
+};
+
 // General note:
 // - The real-time timetable does not use bitfields. It requires an initial copy
 //   of the bitfields from the static timetable to be able to deactivate bits
 //   for transports that are updated with delays, rerouting (incl. track
 //   changes) or cancellations (without changing the static timetable).
 // - RT transports represent departure and arrival times relative to a base day.
-// - RT transports are currently not grouped into routes to simplify the code.
-//   If this leads to performance issues during the routing, grouping into
-//   routes can be introduced for real-time routing as well.
+// - RT transports are grouped into RT routes (same stop sequence, section
+//   classes and bike info, no overtaking) by build_rt_routes(). The routing
+//   scans RT routes like static routes as long as they are up to date.
 // - All RT transports can be resolved via their static transport if they were
 //   already scheduled in the static timetable.
 // - All RT transports that did not exist in the static timetable, can be looked
@@ -37,6 +52,52 @@ struct rt_timetable {
       std::span<stop::value_type> const& stop_seq = {},
       std::span<delta_t> const& time_seq = {});
 
+  // Adds an RT transport that is not part of the static timetable (additional
+  // trip). It can be looked up with resolve_additional().
+  rt_transport_idx_t add_additional_rt_transport(
+      source_idx_t const,
+      std::string_view trip_id,
+      std::span<stop::value_type const> stop_seq,
+      std::span<delta_t const> time_seq,
+      clasz const);
+
+  // RT transport of the additional trip with the given ID (invalid if there
+  // is none). Linear in the number of additional trips.
+  rt_transport_idx_t resolve_additional(source_idx_t const,
+                                        std::string_view trip_id) const;
+
+  // Removes the day of t from the traffic days of its static transport.
+  // Resulting bitfields are interned, so repeated updates of the same
+  // (transport, day) do not grow bitfields_.
+  void deactivate_static_transport(transport const t);
+
+  // Restores the day of t in the traffic days of its static transport if it
+  // is active in the static timetable.
+  void reactivate_static_transport(timetable const&, transport const t);
+
+  // Reverts all real-time information of the RT transport: stop sequence and
+  // event times are reset to the static schedule and it is not cancelled.
+  // Rerouted RT transports (other number of stops) are cancelled and detached
+  // from their static transport, which is active again. Additional trips are
+  // cancelled and detached as well. Detached RT transports are unreachable
+  // via the lookups, the location index and RT routes.
+  void reset_to_static(timetable const&, rt_transport_idx_t const);
+
+  // Replaces the outgoing footpaths of location l for profile prf_idx with
+  // time-dependent footpaths (e.g. elevator outages). An empty list removes
+  // all footpaths starting at l. The incoming footpaths of the (previous and
+  // new) targets are updated accordingly. Only the buckets of the affected
+  // locations are touched.
+  void set_td_footpaths_out(timetable const&,
+                            profile_idx_t,
+                            location_idx_t l,
+                            std::span<td_footpath const>);
+
+  // Switches the outgoing footpaths of l back to the static footpaths.
+  void reset_td_footpaths_out(timetable const&,
+                              profile_idx_t,
+                              location_idx_t l);
+
   delta_t unix_to_delta(unixtime_t const t) const {
     auto const d =
         (t - std::chrono::time_point_cast<unixtime_t::duration>(base_day_))
@@ -46,10 +107,43 @@ struct rt_timetable {
     return clamp(d);
   }
 
+  // Groups RT transports into RT routes. Has to be called after RT
+  // transports were added or changed. Until then, the routing scans RT
+  // transports one by one. Only the patterns of transports changed since the
+  // last call are regrouped; replaced RT routes stay allocated (unreachable
+  // via location_rt_routes_) until they outnumber the live ones, which
+  // triggers a full rebuild.
+  void build_rt_routes(timetable const&);
+
+  // Drops all RT routes. The next build_rt_routes() call rebuilds them from
+  // scratch (required after RT transports were renumbered).
+  void clear_rt_routes();
+
+  bool has_rt_routes() const noexcept { return !rt_routes_outdated_; }
+
+  // Including replaced RT routes (see build_rt_routes()).
+  std::uint32_t n_rt_routes() const noexcept {
+    return rt_route_transports_.size();
+  }
+
+  // Event times of all transports of the RT route at the given stop.
+  // Sorted ascending because transports of an RT route do not overtake.
+  std::span<delta_t const> rt_route_event_times(
+      rt_route_idx_t const r,
+      stop_idx_t const stop_idx,
+      event_type const ev_type) const {
+    auto const n_transports = rt_route_transports_[r].size();
+    auto const ev_idx = static_cast<std::size_t>(
+        stop_idx * 2 - (ev_type == event_type::kArr ? 1 : 0));
+    auto const times = rt_route_stop_times_[r];
+    return {&times[ev_idx * n_transports], n_transports};
+  }
+
   void update_time(rt_transport_idx_t const rt_t,
                    stop_idx_t const stop_idx,
                    event_type const ev_type,
                    unixtime_t const new_time) {
+    set_rt_transport_changed(rt_t);
     auto const ev_idx = stop_idx * 2 - (ev_type == event_type::kArr ? 1 : 0);
     assert(ev_idx >= 0 && static_cast<stop_idx_t>(ev_idx) <
                               rt_transport_stop_times_[rt_t].size());
@@ -57,17 +151,40 @@ struct rt_timetable {
         unix_to_delta(new_time);
   }
 
+  // Has to be called after the event times or the stop sequence of rt_t were
+  // written directly instead of via update_time().
+  void set_rt_transport_changed(rt_transport_idx_t const rt_t) {
+    rt_routes_outdated_ = true;
+    if (rt_routes_changed_.empty() || rt_routes_changed_.back() != rt_t) {
+      rt_routes_changed_.push_back(rt_t);
+    }
+  }
+
   void set_change_callback(change_callback_t callback) {
     change_callback_ = callback;
   }
 
   void reset_change_callback() { change_callback_ = nullptr; }
 
+  // While enabled, all event changes are appended to the change log.
+  // Consumers read them in bulk with get_changes() after an update and call
+  // clear_changes() afterwards.
+  void set_change_log_enabled(bool const enabled) {
+    change_log_enabled_ = enabled;
+  }
+
+  std::span<event_change const> get_changes() const { return change_log_; }
+
+  void clear_changes() { change_log_.clear(); }
+
   void dispatch_event_change(transport const t,
                              stop_idx_t const stop_idx,
                              event_type const ev_type,
                              duration_t const delay,
                              bool const cancelled) {
+    if (change_log_enabled_) {
+      change_log_.push_back({t, stop_idx, ev_type, delay, cancelled});
+    }
     if (change_callback_) {
       change_callback_(t, stop_idx, ev_type, delay, cancelled);
     }
@@ -119,10 +236,47 @@ struct rt_timetable {
     return rt_transport_src_.size();
   }
 
+  // Snapshot for warm restarts. Change callback and change log are not
+  // stored. read() fails if the snapshot was created for a different static
+  // timetable (see timetable::fingerprint_). It copies the serialized members
+  // into a new rt_timetable, so the change callback and log of the result
+  // are default constructed and owned as usual.
+  //
+  // Unlike timetable::read(), the result is not a cista::wrapped view of the
+  // file buffer: the RT timetable keeps being updated. Containers of the
+  // buffer that grow move to the heap, and the object of a cista::wrapped is
+  // never destroyed, so these allocations (and the change log) would leak.
+  // The copy is made once per restart.
+  void write(std::filesystem::path const&) const;
+  static rt_timetable read(std::filesystem::path const&, timetable const&);
+
+  // Serialized members: everything except the change callback and log.
+  auto cista_members() noexcept {
+    return std::tie(
+        has_td_footpaths_out_, has_td_footpaths_in_, td_footpaths_out_,
+        td_footpaths_in_, transport_traffic_days_, bitfields_,
+        bitfield_indices_, src_updated_transports_, src_cancelled_transports_,
+        location_rt_transports_, rt_route_transports_, rt_route_stop_times_,
+        rt_route_location_seq_, location_rt_routes_, rt_transport_route_,
+        rt_routes_changed_, n_removed_rt_routes_, rt_routes_outdated_,
+        base_day_, base_day_idx_, static_tt_fingerprint_, static_trip_lookup_,
+        additional_trips_lookup_, rt_transport_static_transport_,
+        trip_id_strings_, rt_transport_src_, rt_transport_train_nr_,
+        rt_transport_stop_times_, rt_transport_location_seq_,
+        rt_transport_display_names_, rt_transport_line_,
+        rt_transport_section_clasz_, rt_transport_is_cancelled_,
+        rt_transport_bikes_allowed_, rt_bikes_allowed_per_section_);
+  }
+
   array<bitvec_map<location_idx_t>, kMaxProfiles> has_td_footpaths_out_;
   array<bitvec_map<location_idx_t>, kMaxProfiles> has_td_footpaths_in_;
-  array<vecvec<location_idx_t, td_footpath>, kMaxProfiles> td_footpaths_out_;
-  array<vecvec<location_idx_t, td_footpath>, kMaxProfiles> td_footpaths_in_;
+  // Location -> time-dependent footpaths (sorted by target, valid_from), used
+  // instead of the static footpaths if the has_td_footpaths_* bit is set.
+  // Buckets can be replaced in place (see set_td_footpaths_out()).
+  array<mutable_fws_multimap<location_idx_t, td_footpath>, kMaxProfiles>
+      td_footpaths_out_;
+  array<mutable_fws_multimap<location_idx_t, td_footpath>, kMaxProfiles>
+      td_footpaths_in_;
 
   // Updated transport traffic days from the static timetable.
   // Initial: 100% copy from static, then adapted according to real-time
@@ -130,15 +284,55 @@ struct rt_timetable {
   vector_map<transport_idx_t, bitfield_idx_t> transport_traffic_days_;
   vector_map<bitfield_idx_t, bitfield> bitfields_;
 
+  // Bitfield -> index for bitfields created by real-time updates.
+  hash_map<bitfield, bitfield_idx_t> bitfield_indices_;
+
+  // Source -> RT transports (incl. additional trips) updated by the GTFS-RT
+  // messages since the last full dataset (sorted). Updates of transports
+  // that are missing in the next full dataset of the source are reverted.
+  vector_map<source_idx_t, vector<rt_transport_idx_t>> src_updated_transports_;
+
+  // Source -> static transports cancelled without RT transport since the
+  // last full dataset (sorted), reactivated the same way.
+  vector_map<source_idx_t, vector<transport>> src_cancelled_transports_;
+
   // Location -> RT transports that stop at this location
   mutable_fws_multimap<location_idx_t, rt_transport_idx_t>
       location_rt_transports_;
 
+  // RT route -> RT transports, sorted by departure at the first stop
+  vecvec<rt_route_idx_t, rt_transport_idx_t> rt_route_transports_;
+
+  // RT route -> event times, column-major: for each event (dep, arr, dep,
+  // arr, ... as in rt_transport_stop_times_) the times of all transports.
+  vecvec<rt_route_idx_t, delta_t> rt_route_stop_times_;
+
+  // RT route -> stop sequence at the time the RT route was built
+  vecvec<rt_route_idx_t, stop::value_type> rt_route_location_seq_;
+
+  // Location -> live RT routes that stop at this location
+  mutable_fws_multimap<location_idx_t, rt_route_idx_t> location_rt_routes_;
+
+  // RT transport -> live RT route containing it
+  vector_map<rt_transport_idx_t, rt_route_idx_t> rt_transport_route_;
+
+  // RT transports changed after the last build_rt_routes() call.
+  vector<rt_transport_idx_t> rt_routes_changed_;
+
+  // Number of replaced RT routes that are still allocated.
+  std::uint32_t n_removed_rt_routes_{0U};
+
+  // Set if RT transports changed after the last build_rt_routes() call.
+  bool rt_routes_outdated_{true};
+
   // Base-day: all real-time timestamps (departures + arrivals in
   // rt_transport_stop_times_) are given relative to this base day.
   date::sys_days base_day_;
   day_idx_t base_day_idx_;
 
+  // timetable::fingerprint_ of the static timetable (set on creation)
+  std::uint64_t static_tt_fingerprint_{0U};
+
   // Lookup: static transport -> realtime transport
   // only works for transport that existed in the static timetable
   hash_map<transport, rt_transport_idx_t> static_trip_lookup_;
@@ -179,6 +373,9 @@ struct rt_timetable {
   vecvec<rt_transport_idx_t, bool> rt_bikes_allowed_per_section_;
 
   change_callback_t change_callback_;
+
+  bool change_log_enabled_{false};
+  std::vector<event_change> change_log_;
 };
 
 }  // namespace nigiri
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <functional>
+#include <mutex>
+
+#include "date/date.h"
+
+#include "nigiri/rt/rt_timetable.h"
+
+namespace nigiri {
+struct timetable;
+}  // namespace nigiri
+
+namespace nigiri::rt {
+
+// Double-buffered real-time timetable for one writer and many readers.
+//
+// Readers pin the published version with snapshot() for the duration of a
+// query. Pinning does not take a lock: it only increments the reader counter
+// of the published buffer.
+//
+// The writer applies an update to the unpublished buffer and publishes it
+// atomically. The same update is replayed on the other buffer right before
+// its next update, once all readers released it. Thus, an update costs two
+// applications of the delta instead of a copy of the whole rt_timetable.
+//
+// Trade-off: unlike RCU, old versions are not kept alive until their last
+// reader is gone. With only two buffers, the writer has to wait until the
+// readers of the previous version released it. A long running query (e.g.
+// raptor_search) therefore delays the next update (the writer spins) but
+// never the queries themselves.
+//
+// Updates have to be deterministic (same input + same state = same result)
+// and must not throw because they are applied to both buffers. Change
+// callbacks and the change log only see the first application.
+//
+// State kept outside of the rt_timetable has to exist once per buffer: an
+// update function is called with both buffers (alternating), so it has to
+// select its state by the rt_timetable it gets. Example: vdv::updater caches
+// VDV run ids -> RT transports of the rt_timetable it updated last. Sharing
+// one updater between both buffers resolves runs to RT transports of the
+// other buffer. Use one vdv::updater per buffer (keyed by &rtt, see
+// nigiri-rt-benchmark).
+struct rt_timetable_publisher {
+  using update_fn_t = std::function<void(rt_timetable&)>;
+
+  struct snapshot {
+    snapshot(snapshot const&) = delete;
+    snapshot& operator=(snapshot const&) = delete;
+    snapshot(snapshot&&) noexcept;
+    snapshot& operator=(snapshot&&) = delete;
+    ~snapshot();
+
+    rt_timetable const& get() const { return p_->buffers_[idx_]; }
+    rt_timetable const& operator*() const { return get(); }
+    rt_timetable const* operator->() const { return &get(); }
+
+  private:
+    friend struct rt_timetable_publisher;
+
+    snapshot(rt_timetable_publisher const&, unsigned buffer_idx);
+
+    rt_timetable_publisher const* p_;
+    unsigned idx_;
+  };
+
+  rt_timetable_publisher(timetable const&, date::sys_days base_day);
+
+  // Pins the currently published version.
+  snapshot get_snapshot() const;
+
+  // Applies the update and publishes the result. Blocks while readers still
+  // use the unpublished buffer (i.e. pinned it before the last publish).
+  //
+  // The update function is invoked twice: now, and again on the other buffer
+  // during the next update() call. It is stored until then, so it has to own
+  // its inputs (e.g. capture the feed message by value, not by reference).
+  void update(update_fn_t);
+
+private:
+  void wait_for_readers(unsigned buffer_idx) const;
+
+  std::array<rt_timetable, 2U> buffers_;
+  std::atomic<unsigned> published_{0U};
+  mutable std::array<std::atomic<std::uint32_t>, 2U> readers_{};
+
+  // Last update, not yet applied to the unpublished buffer.
+  std::mutex write_mutex_;
+  update_fn_t pending_;
+};
+
+}  // namespace nigiri::rt
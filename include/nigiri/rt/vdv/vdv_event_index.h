@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+
+#include "nigiri/types.h"
+
+namespace nigiri {
+struct timetable;
+}  // namespace nigiri
+
+namespace nigiri::rt::vdv {
+
+// Scheduled events by location for VDV run matching. Only the event used for
+// matching is stored for each route stop: the departure, or the arrival at
+// the last stop. The index only depends on the static timetable and can be
+// shared by all updaters of the timetable.
+struct event_index {
+  struct event {
+    transport_idx_t t_;
+    stop_idx_t stop_idx_;
+    bool is_last_;
+    delta ev_time_;
+  };
+
+  explicit event_index(timetable const&);
+
+  // Calls fn(event const&) for all events at location l that are at most
+  // max_dist minutes away from the given minute after midnight (the search
+  // window wraps around midnight).
+  template <typename Fn>
+  void for_each_event(location_idx_t const l,
+                      std::int32_t const mam,
+                      std::int32_t const max_dist,
+                      Fn&& fn) const {
+    auto const events = events_[l];
+    auto const visit = [&](std::int32_t const from, std::int32_t const to) {
+      auto const by_mam = [](event const& e, std::int32_t const x) {
+        return e.ev_time_.mam() < x;
+      };
+      for (auto it = std::lower_bound(begin(events), end(events), from, by_mam);
+           it != end(events) && it->ev_time_.mam() <= to; ++it) {
+        fn(*it);
+      }
+    };
+
+    auto const from = mam - max_dist;
+    auto const to = mam + max_dist;
+    if (from < 0) {
+      visit(0, to);
+      visit(from + 1440, 1439);
+    } else if (to >= 1440) {
+      visit(from, 1439);
+      visit(0, to - 1440);
+    } else {
+      visit(from, to);
+    }
+  }
+
+  // location -> all locations l' with matches(kEquivalent, l', location)
+  vecvec<location_idx_t, location_idx_t> matching_locations_;
+
+  // location -> events sorted by minute after midnight
+  vecvec<location_idx_t, event> events_;
+};
+
+}  // namespace nigiri::rt::vdv
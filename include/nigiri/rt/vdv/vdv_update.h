@@ -1,5 +1,10 @@
 #pragma once
 
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+
 #include "nigiri/rt/run.h"
 #include "nigiri/types.h"
 
@@ -37,8 +42,14 @@ struct statistics {
   std::uint32_t excess_vdv_stops_{0U};
   std::uint32_t updated_events_{0U};
   std::uint32_t propagated_delays_{0U};
+
+  // run matching (find_run)
+  std::uint32_t index_probes_{0U};
+  std::chrono::microseconds match_duration_{0};
 };
 
+struct event_index;
+
 struct updater {
   static constexpr auto const kExactMatchScore = 1000;
   static constexpr auto const kAllowedTimeDiscrepancy = []() {
@@ -51,13 +62,25 @@ struct updater {
 
   updater(timetable const&, source_idx_t);
 
+  // Matches runs with the event index instead of scanning all routes at the
+  // VDV stops. The index has to outlive the updater.
+  updater(timetable const&, source_idx_t, event_index const&);
+
   void reset_vdv_run_ids_();
 
   statistics const& get_stats() const;
 
   void update(rt_timetable&, pugi::xml_document const&);
 
+  // Same as update(rtt, doc) without building a DOM for the whole message:
+  // IstFahrt elements are parsed and processed one at a time.
+  void update(rt_timetable&, std::string_view xml);
+
 private:
+  friend struct update_stream;
+
+  void process_ist_fahrt(rt_timetable&, pugi::xml_node ist_fahrt);
+
   static std::optional<unixtime_t> get_opt_time(pugi::xml_node const&,
                                                 char const*);
 
@@ -87,8 +110,34 @@ private:
 
   timetable const& tt_;
   source_idx_t src_idx_;
+  event_index const* idx_{nullptr};
   statistics stats_{};
   hash_map<std::string, run> vdv_nigiri_{};
 };
 
-}  // namespace nigiri::rt::vdv
\ No newline at end of file
+// Incremental ingestion of a VDV AUS message that arrives in chunks.
+// Only the current (incomplete) IstFahrt element is buffered. Its DOM is
+// built in place in the reused input buffer and dropped after processing.
+struct update_stream {
+  update_stream(updater&, rt_timetable&);
+  ~update_stream();
+
+  update_stream(update_stream const&) = delete;
+  update_stream& operator=(update_stream const&) = delete;
+
+  // Processes all IstFahrt elements completed by this chunk.
+  void feed(std::string_view chunk);
+
+  // Has to be called after the last chunk.
+  void finish();
+
+private:
+  updater& updater_;
+  rt_timetable& rtt_;
+  std::string buf_;
+  std::unique_ptr<pugi::xml_document> run_doc_;
+  bool prolog_checked_{false};
+  bool latin1_{false};
+};
+
+}  // namespace nigiri::rt::vdv
@@ -108,7 +108,7 @@ std::optional<duration_t> get_td_duration(direction const search_dir,
 template <direction SearchDir, typename Collection, typename Fn>
 void for_each_footpath(Collection const& c, unixtime_t const t, Fn&& f) {
   utl::equal_ranges_linear(
-      begin(c), end(c),
+      std::begin(c), std::end(c),
       [](td_footpath const& a, td_footpath const& b) {
         return a.target_ == b.target_;
       },
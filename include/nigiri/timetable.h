@@ -144,6 +144,7 @@ struct timetable {
     trip_id_src_.emplace_back(src);
 
     trip_id_to_idx_.emplace_back(trip_id_idx, trip_idx);
+    trip_id_index_.clear();
     trip_display_names_.emplace_back(display_name);
     trip_debug_.emplace_back().emplace_back(dbg);
     trip_ids_.emplace_back().emplace_back(trip_id_idx);
@@ -361,6 +362,19 @@ struct timetable {
         trip_debug_[trip_idx].front().line_number_to_};
   }
 
+  // Builds trip_id_index_. Requires trip_id_to_idx_ to be sorted.
+  void build_trip_id_index();
+
+  // Returns the first entry of trip_id_to_idx_ matching (src, id), end if
+  // there is none. Uses the trip id index if it is built, binary search
+  // otherwise.
+  vector<pair<trip_id_idx_t, trip_idx_t>>::const_iterator find_trip_id(
+      source_idx_t, std::string_view id) const;
+
+  // Hashes the timetable contents (stops, trips, routes, traffic days).
+  // Called once by finalize(), use fingerprint_.
+  std::uint64_t compute_fingerprint() const;
+
   friend std::ostream& operator<<(std::ostream&, timetable const&);
 
   void write(cista::memory_holder&) const;
@@ -370,9 +384,19 @@ struct timetable {
   // Schedule range.
   interval<date::sys_days> date_range_;
 
+  // Identifies the timetable contents to detect data derived from a
+  // different timetable (e.g. RT snapshots). Set by finalize().
+  std::uint64_t fingerprint_{0U};
+
   // Trip access: external trip id -> internal trip index
   vector<pair<trip_id_idx_t, trip_idx_t>> trip_id_to_idx_;
 
+  // Open addressing hash index (linear probing, power of two size) over the
+  // distinct (source, trip id) pairs of trip_id_to_idx_.
+  // Slot: (upper 32 bits of the hash, position in trip_id_to_idx_ + 1).
+  // Position 0 marks an empty slot. Empty if not built.
+  vector<pair<std::uint32_t, std::uint32_t>> trip_id_index_;
+
   // Trip index -> list of external trip ids
   mutable_fws_multimap<trip_idx_t, trip_id_idx_t> trip_ids_;
 
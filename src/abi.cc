@@ -2,6 +2,7 @@
 #include <cstring>
 #include <filesystem>
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "date/date.h"
@@ -32,6 +33,10 @@ using namespace date;
 struct nigiri_timetable {
   std::shared_ptr<nigiri::timetable> tt;
   std::shared_ptr<nigiri::rt_timetable> rtt;
+
+  // Changes of the last real-time update. Reused to avoid an allocation
+  // per update.
+  mutable std::vector<nigiri_event_change_t> changes;
 };
 
 nigiri_timetable_t* nigiri_load_from_dir(nigiri::loader::dir const& d,
@@ -198,30 +203,15 @@ void nigiri_destroy_location(const nigiri_location_t* location) {
   delete location;
 }
 
-void nigiri_update_with_rt_from_buf(const nigiri_timetable_t* t,
-                                    std::string_view protobuf,
-                                    void (*callback)(nigiri_event_change_t,
-                                                     void* context),
-                                    void* context) {
+namespace {
+
+std::span<nigiri_event_change_t const> nigiri_apply_rt_buf(
+    const nigiri_timetable_t* t, std::string_view protobuf) {
   auto const src = nigiri::source_idx_t{0U};
   auto const tag = "";
 
-  auto const rtt_callback =
-      [&](nigiri::transport const transport, nigiri::stop_idx_t const stop_idx,
-          nigiri::event_type const ev_type, nigiri::duration_t const delay,
-          bool const cancelled) {
-        nigiri_event_change_t const c = {
-            .transport_idx =
-                static_cast<nigiri::transport_idx_t::value_t>(transport.t_idx_),
-            .day_idx = static_cast<nigiri::day_idx_t::value_t>(transport.day_),
-            .stop_idx = stop_idx,
-            .is_departure = ev_type != nigiri::event_type::kArr,
-            .delay = delay.count(),
-            .cancelled = cancelled};
-        callback(c, context);
-      };
-
-  t->rtt->set_change_callback(rtt_callback);
+  t->rtt->clear_changes();
+  t->rtt->set_change_log_enabled(true);
   try {
     nigiri::rt::gtfsrt_update_buf(*t->tt, *t->rtt, src, tag, protobuf);
   } catch (std::exception const& e) {
@@ -231,7 +221,54 @@ void nigiri_update_with_rt_from_buf(const nigiri_timetable_t* t,
     nigiri::log(nigiri::log_lvl::error, "main",
                 "Unknown GTFS-RT update error (tag={})", tag);
   }
-  t->rtt->reset_change_callback();
+  t->rtt->set_change_log_enabled(false);
+
+  auto& converted = t->changes;
+  converted.clear();
+  for (auto const& c : t->rtt->get_changes()) {
+    converted.push_back(
+        {.transport_idx =
+             static_cast<nigiri::transport_idx_t::value_t>(c.transport_.t_idx_),
+         .day_idx = static_cast<nigiri::day_idx_t::value_t>(c.transport_.day_),
+         .stop_idx = c.stop_idx_,
+         .is_departure = c.ev_type_ != nigiri::event_type::kArr,
+         .delay = c.delay_.count(),
+         .cancelled = c.cancelled_});
+  }
+  t->rtt->clear_changes();
+  return converted;
+}
+
+}  // namespace
+
+void nigiri_update_with_rt_from_buf(const nigiri_timetable_t* t,
+                                    std::string_view protobuf,
+                                    void (*callback)(nigiri_event_change_t,
+                                                     void* context),
+                                    void* context) {
+  for (auto const& c : nigiri_apply_rt_buf(t, protobuf)) {
+    callback(c, context);
+  }
+}
+
+void nigiri_update_with_rt_batch_from_buf(
+    const nigiri_timetable_t* t,
+    std::string_view protobuf,
+    void (*callback)(const nigiri_event_change_t* changes,
+                     uint32_t n_changes,
+                     void* context),
+    void* context) {
+  auto const changes = nigiri_apply_rt_buf(t, protobuf);
+  callback(changes.data(), static_cast<uint32_t>(changes.size()), context);
+}
+
+uint32_t nigiri_update_with_rt_changes_from_buf(
+    const nigiri_timetable_t* t,
+    std::string_view protobuf,
+    const nigiri_event_change_t** changes) {
+  auto const c = nigiri_apply_rt_buf(t, protobuf);
+  *changes = c.data();
+  return static_cast<uint32_t>(c.size());
 }
 
 void nigiri_update_with_rt(const nigiri_timetable_t* t,
@@ -242,3 +279,22 @@ void nigiri_update_with_rt(const nigiri_timetable_t* t,
   auto const file = cista::mmap{gtfsrt_pb_path, cista::mmap::protection::READ};
   return nigiri_update_with_rt_from_buf(t, file.view(), callback, context);
 }
+
+void nigiri_update_with_rt_batch(
+    const nigiri_timetable_t* t,
+    const char* gtfsrt_pb_path,
+    void (*callback)(const nigiri_event_change_t* changes,
+                     uint32_t n_changes,
+                     void* context),
+    void* context) {
+  auto const file = cista::mmap{gtfsrt_pb_path, cista::mmap::protection::READ};
+  return nigiri_update_with_rt_batch_from_buf(t, file.view(), callback,
+                                              context);
+}
+
+uint32_t nigiri_update_with_rt_changes(const nigiri_timetable_t* t,
+                                       const char* gtfsrt_pb_path,
+                                       const nigiri_event_change_t** changes) {
+  auto const file = cista::mmap{gtfsrt_pb_path, cista::mmap::protection::READ};
+  return nigiri_update_with_rt_changes_from_buf(t, file.view(), changes);
+}
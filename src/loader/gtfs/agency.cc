@@ -2,14 +2,10 @@
 
 #include "date/tz.h"
 
-#include "utl/get_or_create.h"
-#include "utl/parser/buf_reader.h"
 #include "utl/parser/csv_range.h"
-#include "utl/parser/line_range.h"
-#include "utl/pipes/transform.h"
-#include "utl/pipes/vec.h"
 #include "utl/progress_tracker.h"
 
+#include "nigiri/loader/gtfs/csv_scanner.h"
 #include "nigiri/timetable.h"
 
 namespace nigiri::loader::gtfs {
@@ -28,17 +24,27 @@ agency_map_t read_agencies(timetable& tt,
   progress_tracker->status("Parse Agencies")
       .out_bounds(0.F, 1.F)
       .in_high(file_content.size());
-  return utl::line_range{utl::make_buf_reader(
-             file_content, progress_tracker->update_fn())}  //
-         | utl::csv<agency>()  //
-         | utl::transform([&](agency const& a) {
-             return std::pair{
-                 a.id_->to_str(),
-                 tt.register_provider(
-                     {a.id_->view(), a.name_->view(), a.url_->view(),
-                      get_tz_idx(tt, timezones, a.tz_name_->trim().view())})};
-           })  //
-         | utl::to<agency_map_t>();
+  auto csv = csv_scanner{file_content};
+  auto const id_col = csv.column("agency_id");
+  auto const name_col = csv.column("agency_name");
+  auto const url_col = csv.column("agency_url");
+  auto const tz_name_col = csv.column("agency_timezone");
+
+  auto agencies = agency_map_t{};
+  auto a = agency{};
+  while (csv.next()) {
+    parse_field(csv[id_col], *a.id_);
+    parse_field(csv[name_col], *a.name_);
+    parse_field(csv[url_col], *a.url_);
+    parse_field(csv[tz_name_col], *a.tz_name_);
+    agencies.emplace(
+        a.id_->to_str(),
+        tt.register_provider(
+            {a.id_->view(), a.name_->view(), a.url_->view(),
+             get_tz_idx(tt, timezones, a.tz_name_->trim().view())}));
+  }
+  progress_tracker->update(file_content.size());
+  return agencies;
 }
 
 }  // namespace nigiri::loader::gtfs
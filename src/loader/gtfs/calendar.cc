@@ -1,12 +1,9 @@
 #include "nigiri/loader/gtfs/calendar.h"
 
-#include "utl/parser/buf_reader.h"
 #include "utl/parser/csv_range.h"
-#include "utl/parser/line_range.h"
-#include "utl/pipes/transform.h"
-#include "utl/pipes/vec.h"
 #include "utl/progress_tracker.h"
 
+#include "nigiri/loader/gtfs/csv_scanner.h"
 #include "nigiri/loader/gtfs/parse_date.h"
 
 namespace nigiri::loader::gtfs {
@@ -29,26 +26,49 @@ hash_map<std::string, calendar> read_calendar(std::string_view file_content) {
   progress_tracker->status("Parse Calendar")
       .out_bounds(29.F, 31.F)
       .in_high(file_content.size());
-  return utl::line_range{utl::make_buf_reader(
-             file_content, progress_tracker->update_fn())}  //
-         | utl::csv<calendar_entry>()  //
-         | utl::transform([&](calendar_entry const& e) {
-             std::bitset<7> days;
-             days.set(0, *e.sunday_ == 1);
-             days.set(1, *e.monday_ == 1);
-             days.set(2, *e.tuesday_ == 1);
-             days.set(3, *e.wednesday_ == 1);
-             days.set(4, *e.thursday_ == 1);
-             days.set(5, *e.friday_ == 1);
-             days.set(6, *e.saturday_ == 1);
-
-             return std::pair{e.id_->to_str(),
-                              calendar{.week_days_ = days,
-                                       .interval_ = {parse_date(*e.start_date_),
-                                                     parse_date(*e.end_date_) +
-                                                         date::days{1}}}};
-           })  //
-         | utl::to<hash_map<std::string, calendar>>();
+  auto csv = csv_scanner{file_content};
+  auto const id_col = csv.column("service_id");
+  auto const monday_col = csv.column("monday");
+  auto const tuesday_col = csv.column("tuesday");
+  auto const wednesday_col = csv.column("wednesday");
+  auto const thursday_col = csv.column("thursday");
+  auto const friday_col = csv.column("friday");
+  auto const saturday_col = csv.column("saturday");
+  auto const sunday_col = csv.column("sunday");
+  auto const start_date_col = csv.column("start_date");
+  auto const end_date_col = csv.column("end_date");
+
+  auto calendars = hash_map<std::string, calendar>{};
+  auto e = calendar_entry{};
+  while (csv.next()) {
+    parse_field(csv[id_col], *e.id_);
+    parse_field(csv[monday_col], *e.monday_);
+    parse_field(csv[tuesday_col], *e.tuesday_);
+    parse_field(csv[wednesday_col], *e.wednesday_);
+    parse_field(csv[thursday_col], *e.thursday_);
+    parse_field(csv[friday_col], *e.friday_);
+    parse_field(csv[saturday_col], *e.saturday_);
+    parse_field(csv[sunday_col], *e.sunday_);
+    parse_field(csv[start_date_col], *e.start_date_);
+    parse_field(csv[end_date_col], *e.end_date_);
+
+    std::bitset<7> days;
+    days.set(0, *e.sunday_ == 1);
+    days.set(1, *e.monday_ == 1);
+    days.set(2, *e.tuesday_ == 1);
+    days.set(3, *e.wednesday_ == 1);
+    days.set(4, *e.thursday_ == 1);
+    days.set(5, *e.friday_ == 1);
+    days.set(6, *e.saturday_ == 1);
+
+    calendars.emplace(
+        e.id_->to_str(),
+        calendar{.week_days_ = days,
+                 .interval_ = {parse_date(*e.start_date_),
+                               parse_date(*e.end_date_) + date::days{1}}});
+  }
+  progress_tracker->update(file_content.size());
+  return calendars;
 }
 
 }  // namespace nigiri::loader::gtfs
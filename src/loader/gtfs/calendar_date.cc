@@ -1,12 +1,9 @@
 #include "nigiri/loader/gtfs/calendar_date.h"
 
-#include "utl/parser/buf_reader.h"
 #include "utl/parser/csv_range.h"
-#include "utl/parser/line_range.h"
-#include "utl/pipes/for_each.h"
-#include "utl/pipes/vec.h"
 #include "utl/progress_tracker.h"
 
+#include "nigiri/loader/gtfs/csv_scanner.h"
 #include "nigiri/loader/gtfs/parse_date.h"
 #include "nigiri/common/cached_lookup.h"
 
@@ -27,16 +24,27 @@ hash_map<std::string, std::vector<calendar_date>> read_calendar_date(
   progress_tracker->status("Parse Calendar Date")
       .out_bounds(31.F, 33.F)
       .in_high(file_content.size());
-  utl::line_range{
-      utl::make_buf_reader(file_content, progress_tracker->update_fn())}  //
-      | utl::csv<entry>()  //
-      | utl::for_each([&](entry const& e) {
-          lookup_service(e.id_->view())
-              .emplace_back(calendar_date{
-                  .type_ = (*e.exception_type_ == 1 ? calendar_date::kAdd
-                                                    : calendar_date::kRemove),
-                  .day_ = parse_date(*e.date_)});
-        });
+  auto csv = csv_scanner{file_content};
+  auto const id_col = csv.column("service_id");
+  auto const date_col = csv.column("date");
+  auto const exception_type_col = csv.column("exception_type");
+
+  auto e = entry{};
+  for (auto n = 0U; csv.next(); ++n) {
+    if (n % 65536U == 0U) {
+      progress_tracker->update(csv.position());
+    }
+
+    parse_field(csv[id_col], *e.id_);
+    parse_field(csv[date_col], *e.date_);
+    parse_field(csv[exception_type_col], *e.exception_type_);
+    lookup_service(e.id_->view())
+        .emplace_back(calendar_date{
+            .type_ = (*e.exception_type_ == 1 ? calendar_date::kAdd
+                                              : calendar_date::kRemove),
+            .day_ = parse_date(*e.date_)});
+  }
+  progress_tracker->update(file_content.size());
   return services;
 }
 
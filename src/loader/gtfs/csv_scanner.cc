@@ -0,0 +1,165 @@
+#include "nigiri/loader/gtfs/csv_scanner.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace nigiri::loader::gtfs {
+
+namespace {
+
+constexpr auto const kBom = std::string_view{"\xEF\xBB\xBF"};
+
+constexpr std::uint64_t broadcast(char const c) {
+  return 0x0101010101010101ULL * static_cast<std::uint8_t>(c);
+}
+
+// Sets the high bit of every byte of x that is zero (and no other bit).
+constexpr std::uint64_t zero_bytes(std::uint64_t const x) {
+  constexpr auto const kLow7 = 0x7F7F7F7F7F7F7F7FULL;
+  return ~(((x & kLow7) + kLow7) | x | kLow7);
+}
+
+constexpr bool is_special(char const c) {
+  return c == ',' || c == '"' || c == '\n';
+}
+
+// First ',', '"' or '\n' in [p, end), end if there is none.
+char const* find_special(char const* p, char const* const end) {
+  if constexpr (std::endian::native == std::endian::little) {
+    while (end - p >= 8) {
+      auto w = std::uint64_t{};
+      std::memcpy(&w, p, sizeof(w));
+      auto const mask = zero_bytes(w ^ broadcast(',')) |
+                        zero_bytes(w ^ broadcast('"')) |
+                        zero_bytes(w ^ broadcast('\n'));
+      if (mask != 0U) {
+        return p + std::countr_zero(mask) / 8;
+      }
+      p += 8;
+    }
+  }
+  while (p != end && !is_special(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+// First '"' in [p, end), end if there is none.
+char const* find_quote(char const* const p, char const* const end) {
+  auto const q = std::memchr(p, '"', static_cast<std::size_t>(end - p));
+  return q == nullptr ? end : static_cast<char const*>(q);
+}
+
+utl::cstr make_cstr(char const* const from, char const* const to) {
+  return {from, static_cast<std::size_t>(to - from)};
+}
+
+std::string_view header_line(std::string_view const csv) {
+  auto const nl = csv.find('\n');
+  return nl == std::string_view::npos ? csv : csv.substr(0U, nl + 1U);
+}
+
+std::string_view trim(std::string_view s) {
+  auto const first = s.find_first_not_of(" \t\r");
+  if (first == std::string_view::npos) {
+    return {};
+  }
+  return s.substr(first, s.find_last_not_of(" \t\r") - first + 1U);
+}
+
+}  // namespace
+
+csv_scanner::csv_scanner(std::string_view const csv)
+    : csv_scanner{header_line(csv), csv.substr(header_line(csv).size())} {}
+
+csv_scanner::csv_scanner(std::string_view header, std::string_view const rows)
+    : rows_{header}, pos_{header.data()} {
+  if (header.starts_with(kBom)) {
+    rows_ = header.substr(kBom.size());
+    pos_ = rows_.data();
+  }
+  read_row();
+  for (auto const& f : fields_) {
+    header_.emplace_back(trim(f.view()));
+  }
+
+  rows_ = rows;
+  pos_ = rows_.data();
+  fields_.clear();
+}
+
+std::size_t csv_scanner::column(std::string_view const name) const {
+  auto const it = std::find(begin(header_), end(header_), name);
+  return it == end(header_) ? kMissing
+                            : static_cast<std::size_t>(it - begin(header_));
+}
+
+bool csv_scanner::next() {
+  auto const end = rows_.data() + rows_.size();
+  while (pos_ != end) {
+    read_row();
+    if (fields_.size() != 1U || !fields_.front().empty()) {
+      return true;
+    }
+  }
+  fields_.clear();
+  return false;
+}
+
+void csv_scanner::read_row() {
+  auto const end = rows_.data() + rows_.size();
+  fields_.clear();
+
+  while (true) {
+    if (pos_ != end && *pos_ == '"') {
+      auto const from = pos_ + 1;
+      auto to = find_quote(from, end);
+      if (to + 1 < end && to[1] == '"') {
+        // Escaped quotes: collect the unescaped field.
+        auto& s = unescaped_.emplace_back(from, to + 1);
+        pos_ = to + 2;
+        while (true) {
+          to = find_quote(pos_, end);
+          s.append(pos_, to);
+          if (to + 1 < end && to[1] == '"') {
+            s.push_back('"');
+            pos_ = to + 2;
+          } else {
+            break;
+          }
+        }
+        fields_.emplace_back(s.data(), s.size());
+      } else {
+        fields_.emplace_back(make_cstr(from, to));
+      }
+
+      // Skip whatever follows the closing quote up to the next delimiter.
+      pos_ = to == end ? end : to + 1;
+      while (pos_ != end && *pos_ != ',' && *pos_ != '\n') {
+        ++pos_;
+      }
+    } else {
+      // Quotes within unquoted fields are taken literally.
+      auto to = find_special(pos_, end);
+      while (to != end && *to == '"') {
+        to = find_special(to + 1, end);
+      }
+      fields_.emplace_back(make_cstr(pos_, to));
+      pos_ = to;
+    }
+
+    if (pos_ == end || *pos_++ == '\n') {
+      break;
+    }
+  }
+
+  // CRLF line endings.
+  auto& last = fields_.back();
+  if (last.len != 0U && last.str[last.len - 1U] == '\r') {
+    --last.len;
+  }
+}
+
+}  // namespace nigiri::loader::gtfs
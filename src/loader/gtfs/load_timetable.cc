@@ -1,11 +1,13 @@
 #include "nigiri/loader/gtfs/load_timetable.h"
 
+#include <algorithm>
 #include <charconv>
 #include <filesystem>
 #include <numeric>
 #include <string>
 
 #include "utl/get_or_create.h"
+#include "utl/parallel_for.h"
 #include "utl/progress_tracker.h"
 
 #include "cista/hash.h"
@@ -13,7 +15,6 @@
 
 #include "wyhash.h"
 
-#include "nigiri/loader/get_index.h"
 #include "nigiri/loader/gtfs/agency.h"
 #include "nigiri/loader/gtfs/calendar.h"
 #include "nigiri/loader/gtfs/calendar_date.h"
@@ -80,6 +81,62 @@ bool applicable(dir const& d) {
   return d.exists(kCalenderFile) || d.exists(kCalendarDatesFile);
 }
 
+namespace {
+
+// Partitions the services of one route key into sub-routes in which no
+// service overtakes another one. Services are appended in the order of their
+// first departure, so each service is only compared to the last service of
+// a sub-route.
+std::vector<std::vector<utc_trip>> build_sub_routes(
+    std::vector<utc_trip> services) {
+  auto const time_of_day = [](utc_trip const& s, std::size_t const i) {
+    return s.utc_times_[i] % 1440;
+  };
+
+  // Services with equal first departure: the last expanded one comes first.
+  std::reverse(begin(services), end(services));
+  std::stable_sort(begin(services), end(services),
+                   [&](utc_trip const& a, utc_trip const& b) {
+                     return time_of_day(a, 0U) < time_of_day(b, 0U);
+                   });
+
+  auto sub_routes = std::vector<std::vector<utc_trip>>{};
+  for (auto& s : services) {
+    auto const it = std::find_if(
+        begin(sub_routes), end(sub_routes),
+        [&](std::vector<utc_trip> const& r) {
+          for (auto i = 0U; i != s.utc_times_.size(); ++i) {
+            if (time_of_day(s, i) < time_of_day(r.back(), i)) {
+              return false;
+            }
+          }
+          return true;
+        });
+    if (it == end(sub_routes)) {
+      sub_routes.emplace_back().emplace_back(std::move(s));
+    } else {
+      it->emplace_back(std::move(s));
+    }
+  }
+  return sub_routes;
+}
+
+void open_stop_times(dir const& d, prepared_gtfs& p) {
+  if (d.exists(kStopTimesFile)) {
+    p.stop_times_file_ = d.get_file(kStopTimesFile);
+  }
+  p.stop_times_ = split_stop_times(p.stop_times_file_.data());
+}
+
+}  // namespace
+
+std::unique_ptr<prepared_gtfs> prepare(dir const& d) {
+  auto p = std::make_unique<prepared_gtfs>();
+  open_stop_times(d, *p);
+  parse_stop_times(p->stop_times_);
+  return p;
+}
+
 void load_timetable(loader_config const& config,
                     source_idx_t const src,
                     dir const& d,
@@ -98,6 +155,20 @@ void load_timetable(loader_config const& config,
                     hash_map<bitfield, bitfield_idx_t>& bitfield_indices,
                     assistance_times* assistance,
                     shapes_storage* shapes_data) {
+  auto p = prepared_gtfs{};
+  open_stop_times(d, p);
+  load_timetable(config, src, d, p, tt, bitfield_indices, assistance,
+                 shapes_data);
+}
+
+void load_timetable(loader_config const& config,
+                    source_idx_t const src,
+                    dir const& d,
+                    prepared_gtfs& prepared,
+                    timetable& tt,
+                    hash_map<bitfield, bitfield_idx_t>& bitfield_indices,
+                    assistance_times* assistance,
+                    shapes_storage* shapes_data) {
   nigiri::scoped_timer const global_timer{"gtfs parser"};
 
   auto const load = [&](std::string_view file_name) -> file {
@@ -124,7 +195,7 @@ void load_timetable(loader_config const& config,
       read_trips(tt, routes, service, shape_states, load(kTripsFile).data(),
                  config.bikes_allowed_default_);
   read_frequencies(trip_data, load(kFrequenciesFile).data());
-  read_stop_times(tt, trip_data, stops, load(kStopTimesFile).data(),
+  read_stop_times(tt, trip_data, stops, prepared.stop_times_,
                   shapes_data != nullptr);
 
   {
@@ -147,6 +218,8 @@ void load_timetable(loader_config const& config,
     }
   }
 
+  // All services of a route key are collected in the first vector and
+  // partitioned into sub-routes once all trips are expanded.
   hash_map<route_key_t, std::vector<std::vector<utc_trip>>, route_key_hash,
            route_key_equals>
       route_services;
@@ -188,18 +261,13 @@ void load_timetable(loader_config const& config,
           auto const it = route_services.find(
               route_key_ptr_t{clasz, stop_seq, bikes_allowed_seq});
           if (it != end(route_services)) {
-            for (auto& r : it->second) {
-              auto const idx = get_index(r, s);
-              if (idx.has_value()) {
-                r.insert(std::next(begin(r), static_cast<int>(*idx)), s);
-                return;
-              }
-            }
-            it->second.emplace_back(std::vector<utc_trip>{std::move(s)});
+            it->second.front().emplace_back(std::move(s));
           } else {
+            auto services = std::vector<std::vector<utc_trip>>(1U);
+            services.front().emplace_back(std::move(s));
             route_services.emplace(
                 route_key_t{clasz, *stop_seq, *bikes_allowed_seq},
-                std::vector<std::vector<utc_trip>>{{s}});
+                std::move(services));
           }
         });
   };
@@ -232,6 +300,19 @@ void load_timetable(loader_config const& config,
     }
   }
 
+  {
+    auto const timer = scoped_timer{"loader.gtfs.routes.partition"};
+    auto services = std::vector<std::vector<std::vector<utc_trip>>*>{};
+    services.reserve(route_services.size());
+    for (auto& [_, sub_routes] : route_services) {
+      services.emplace_back(&sub_routes);
+    }
+    utl::parallel_for_run(services.size(), [&](std::size_t const i) {
+      auto& sub_routes = *services[i];
+      sub_routes = build_sub_routes(std::move(sub_routes.front()));
+    });
+  }
+
   {
     progress_tracker->status("Write Trips")
         .out_bounds(85.F, 98.F)
@@ -1,5 +1,6 @@
 #include "nigiri/loader/gtfs/loader.h"
 
+#include "nigiri/loader/gtfs/files.h"
 #include "nigiri/loader/gtfs/load_timetable.h"
 
 namespace nigiri::loader::gtfs {
@@ -20,10 +21,41 @@ void gtfs_loader::load(
       c, src, d, tt, global_bitfield_indices, assistance, shapes_data);
 }
 
+std::unique_ptr<prepared_source> gtfs_loader::prepare(loader_config const&,
+                                                      dir const& d) const {
+  return nigiri::loader::gtfs::prepare(d);
+}
+
+void gtfs_loader::load_prepared(
+    prepared_source& p,
+    loader_config const& c,
+    source_idx_t const src,
+    dir const& d,
+    timetable& tt,
+    hash_map<bitfield, bitfield_idx_t>& global_bitfield_indices,
+    assistance_times* assistance,
+    shapes_storage* shapes_data) const {
+  return nigiri::loader::gtfs::load_timetable(
+      c, src, d, static_cast<prepared_gtfs&>(p), tt, global_bitfield_indices,
+      assistance, shapes_data);
+}
+
 cista::hash_t gtfs_loader::hash(dir const& d) const {
   return ::nigiri::loader::gtfs::hash(d);
 }
 
 std::string_view gtfs_loader::name() const { return "gtfs"; }
 
+std::vector<std::filesystem::path> gtfs_loader::files(
+    bool const with_shapes) const {
+  auto files = std::vector<std::filesystem::path>{
+      kAgencyFile,    kStopFile,     kRoutesFile,        kTripsFile,
+      kStopTimesFile, kCalenderFile, kCalendarDatesFile, kTransfersFile,
+      kFrequenciesFile};
+  if (with_shapes) {
+    files.emplace_back(kShapesFile);
+  }
+  return files;
+}
+
 }  // namespace nigiri::loader::gtfs
\ No newline at end of file
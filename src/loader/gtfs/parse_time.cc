@@ -6,23 +6,48 @@
 
 namespace nigiri::loader::gtfs {
 
+namespace {
+
+constexpr bool is_digit(char const c) { return c >= '0' && c <= '9'; }
+
+constexpr int digit(char const c) { return c - '0'; }
+
+}  // namespace
+
 duration_t hhmm_to_min(utl::cstr s) {
   if (s.empty()) {
     return kInterpolate;
-  } else {
-    int hours = 0;
-    parse_arg(s, hours, 0);
-    if (s) {
-      ++s;
-    } else {
-      return kInterpolate;
-    }
-
-    int minutes = 0;
-    parse_arg(s, minutes, 0);
+  }
 
+  // Fast path for the common layouts H:MM[:SS] and HH:MM[:SS].
+  auto const h_len = s.len > 1U && s.str[1] == ':' ? 1U : 2U;
+  auto const fixed_layout =
+      (s.len == h_len + 3U || (s.len == h_len + 6U && s.str[h_len + 3] == ':' &&
+                               is_digit(s.str[h_len + 4]) &&
+                               is_digit(s.str[h_len + 5]))) &&
+      s.str[h_len] == ':' && is_digit(s.str[0]) &&
+      (h_len == 1U || is_digit(s.str[1])) && is_digit(s.str[h_len + 1]) &&
+      is_digit(s.str[h_len + 2]);
+  if (fixed_layout) {
+    auto const hours =
+        h_len == 1U ? digit(s.str[0]) : digit(s.str[0]) * 10 + digit(s.str[1]);
+    auto const minutes =
+        digit(s.str[h_len + 1]) * 10 + digit(s.str[h_len + 2]);
     return duration_t{hours * 60 + minutes};
   }
+
+  int hours = 0;
+  parse_arg(s, hours, 0);
+  if (s) {
+    ++s;
+  } else {
+    return kInterpolate;
+  }
+
+  int minutes = 0;
+  parse_arg(s, minutes, 0);
+
+  return duration_t{hours * 60 + minutes};
 }
 
 }  // namespace nigiri::loader::gtfs
@@ -1,13 +1,10 @@
 #include "nigiri/loader/gtfs/route.h"
 
 #include "utl/get_or_create.h"
-#include "utl/parser/buf_reader.h"
 #include "utl/parser/csv_range.h"
-#include "utl/parser/line_range.h"
-#include "utl/pipes/transform.h"
-#include "utl/pipes/vec.h"
 #include "utl/progress_tracker.h"
 
+#include "nigiri/loader/gtfs/csv_scanner.h"
 #include "nigiri/logging.h"
 #include "nigiri/timetable.h"
 
@@ -167,40 +164,61 @@ route_map_t read_routes(timetable& tt,
   progress_tracker->status("Parse Routes")
       .out_bounds(27.F, 29.F)
       .in_high(file_content.size());
-  return utl::line_range{utl::make_buf_reader(
-             file_content, progress_tracker->update_fn())}  //
-         | utl::csv<csv_route>()  //
-         |
-         utl::transform([&](csv_route const& r) {
-           auto const agency =
-               agencies.size() == 1U
-                   ? agencies.begin()->second
-                   : utl::get_or_create(agencies, r.agency_id_->view(), [&]() {
-                       log(log_lvl::error, "gtfs.route",
-                           "agency {} not found, using UNKNOWN with local "
-                           "timezone",
-                           r.agency_id_->view());
-
-                       auto const id = r.agency_id_->view().empty()
-                                           ? "UKN"
-                                           : r.agency_id_->view();
-                       return tt.register_provider(
-                           {id, "UNKNOWN_AGENCY", "",
-                            get_tz_idx(tt, timezones, default_tz)});
-                     });
-           return std::pair{
-               r.route_id_->to_str(),
-               std::make_unique<route>(route{
-                   .agency_ = agency,
-                   .id_ = r.route_id_->to_str(),
-                   .short_name_ = r.route_short_name_->to_str(),
-                   .long_name_ = r.route_long_name_->to_str(),
-                   .desc_ = r.route_desc_->to_str(),
-                   .clasz_ = to_clasz(*r.route_type_),
-                   .color_ = to_color(r.route_color_->to_str()),
-                   .text_color_ = to_color(r.route_text_color_->to_str())})};
-         })  //
-         | utl::to<route_map_t>();
+  auto csv = csv_scanner{file_content};
+  auto const route_id_col = csv.column("route_id");
+  auto const agency_id_col = csv.column("agency_id");
+  auto const route_short_name_col = csv.column("route_short_name");
+  auto const route_long_name_col = csv.column("route_long_name");
+  auto const route_desc_col = csv.column("route_desc");
+  auto const route_type_col = csv.column("route_type");
+  auto const route_color_col = csv.column("route_color");
+  auto const route_text_color_col = csv.column("route_text_color");
+
+  auto routes = route_map_t{};
+  auto r = csv_route{};
+  for (auto n = 0U; csv.next(); ++n) {
+    if (n % 65536U == 0U) {
+      progress_tracker->update(csv.position());
+    }
+
+    parse_field(csv[route_id_col], *r.route_id_);
+    parse_field(csv[agency_id_col], *r.agency_id_);
+    parse_field(csv[route_short_name_col], *r.route_short_name_);
+    parse_field(csv[route_long_name_col], *r.route_long_name_);
+    parse_field(csv[route_desc_col], *r.route_desc_);
+    parse_field(csv[route_type_col], *r.route_type_);
+    parse_field(csv[route_color_col], *r.route_color_);
+    parse_field(csv[route_text_color_col], *r.route_text_color_);
+
+    auto const agency =
+        agencies.size() == 1U
+            ? agencies.begin()->second
+            : utl::get_or_create(agencies, r.agency_id_->view(), [&]() {
+                log(log_lvl::error, "gtfs.route",
+                    "agency {} not found, using UNKNOWN with local timezone",
+                    r.agency_id_->view());
+
+                auto const id = r.agency_id_->view().empty()
+                                    ? "UKN"
+                                    : r.agency_id_->view();
+                return tt.register_provider(
+                    {id, "UNKNOWN_AGENCY", "",
+                     get_tz_idx(tt, timezones, default_tz)});
+              });
+    routes.emplace(
+        r.route_id_->to_str(),
+        std::make_unique<route>(
+            route{.agency_ = agency,
+                  .id_ = r.route_id_->to_str(),
+                  .short_name_ = r.route_short_name_->to_str(),
+                  .long_name_ = r.route_long_name_->to_str(),
+                  .desc_ = r.route_desc_->to_str(),
+                  .clasz_ = to_clasz(*r.route_type_),
+                  .color_ = to_color(r.route_color_->to_str()),
+                  .text_color_ = to_color(r.route_text_color_->to_str())}));
+  }
+  progress_tracker->update(file_content.size());
+  return routes;
 }
 
 }  // namespace nigiri::loader::gtfs
@@ -2,13 +2,11 @@
 
 #include "geo/latlng.h"
 
-#include "utl/parser/buf_reader.h"
 #include "utl/parser/csv_range.h"
-#include "utl/parser/line_range.h"
-#include "utl/pipes/for_each.h"
 #include "utl/progress_tracker.h"
 #include "utl/sort_by.h"
 
+#include "nigiri/loader/gtfs/csv_scanner.h"
 #include "nigiri/common/cached_lookup.h"
 #include "nigiri/logging.h"
 #include "nigiri/shapes_storage.h"
@@ -36,32 +34,49 @@ shape_loader_state parse_shapes(std::string_view const data,
   progress_tracker->status("Parse Shapes")
       .out_bounds(37.F, 38.F)
       .in_high(data.size());
-  utl::line_range{utl::make_buf_reader(data, progress_tracker->update_fn())}  //
-      | utl::csv<shape_entry>()  //
-      | utl::for_each([&](shape_entry const entry) {
-          auto const shape_idx = lookup(entry.id_->view(), [&] {
-            auto const idx = static_cast<shape_idx_t>(shapes.size());
-            shapes.emplace_back_empty();
-            states.distances_.emplace_back();
-            seq.emplace_back();
-            return idx;
-          });
-          auto polyline = shapes[shape_idx];
-          polyline.push_back(geo::latlng{*entry.lat_, *entry.lon_});
-          auto const state_idx = states.get_relative_idx(shape_idx);
-          seq[state_idx].push_back(*entry.seq_);
-          auto& distances = states.distances_[state_idx];
-          if (distances.empty()) {
-            if (*entry.distance_ != 0.0) {
-              for (auto i = 0U; i != polyline.size(); ++i) {
-                distances.push_back(0.0);
-              }
-              distances.back() = *entry.distance_;
-            }
-          } else {
-            distances.push_back(*entry.distance_);
-          }
-        });
+  auto csv = csv_scanner{data};
+  auto const id_col = csv.column("shape_id");
+  auto const lat_col = csv.column("shape_pt_lat");
+  auto const lon_col = csv.column("shape_pt_lon");
+  auto const seq_col = csv.column("shape_pt_sequence");
+  auto const distance_col = csv.column("shape_dist_traveled");
+
+  auto entry = shape_entry{};
+  for (auto n = 0U; csv.next(); ++n) {
+    if (n % 65536U == 0U) {
+      progress_tracker->update(csv.position());
+    }
+
+    parse_field(csv[id_col], *entry.id_);
+    parse_field(csv[lat_col], *entry.lat_);
+    parse_field(csv[lon_col], *entry.lon_);
+    parse_field(csv[seq_col], *entry.seq_);
+    parse_field(csv[distance_col], *entry.distance_);
+
+    auto const shape_idx = lookup(entry.id_->view(), [&] {
+      auto const idx = static_cast<shape_idx_t>(shapes.size());
+      shapes.emplace_back_empty();
+      states.distances_.emplace_back();
+      seq.emplace_back();
+      return idx;
+    });
+    auto polyline = shapes[shape_idx];
+    polyline.push_back(geo::latlng{*entry.lat_, *entry.lon_});
+    auto const state_idx = states.get_relative_idx(shape_idx);
+    seq[state_idx].push_back(*entry.seq_);
+    auto& distances = states.distances_[state_idx];
+    if (distances.empty()) {
+      if (*entry.distance_ != 0.0) {
+        for (auto i = 0U; i != polyline.size(); ++i) {
+          distances.push_back(0.0);
+        }
+        distances.back() = *entry.distance_;
+      }
+    } else {
+      distances.push_back(*entry.distance_);
+    }
+  }
+  progress_tracker->update(data.size());
 
   auto polyline = std::vector<geo::latlng>();
   for (auto const i :
@@ -8,13 +8,11 @@
 
 #include "utl/get_or_create.h"
 #include "utl/parallel_for.h"
-#include "utl/parser/buf_reader.h"
 #include "utl/parser/csv_range.h"
-#include "utl/parser/line_range.h"
-#include "utl/pipes/for_each.h"
 #include "utl/progress_tracker.h"
 #include "utl/to_vec.h"
 
+#include "nigiri/loader/gtfs/csv_scanner.h"
 #include "nigiri/logging.h"
 #include "nigiri/timetable.h"
 
@@ -124,40 +122,53 @@ void read_transfers(stop_map_t& stops, std::string_view file_content) {
       .out_bounds(15.F, 17.F)
       .in_high(file_content.size());
 
-  utl::line_range{
-      utl::make_buf_reader(file_content, progress_tracker->update_fn())}  //
-      | utl::csv<csv_transfer>()  //
-      |
-      utl::for_each([&](csv_transfer const& t) {
-        auto const from_stop_it = stops.find(t.from_stop_id_->view());
-        if (from_stop_it == end(stops)) {
-          log(log_lvl::error, "loader.gtfs.transfers", "stop {} not found\n",
-              t.from_stop_id_->view());
-          return;
-        }
+  auto csv = csv_scanner{file_content};
+  auto const from_stop_id_col = csv.column("from_stop_id");
+  auto const to_stop_id_col = csv.column("to_stop_id");
+  auto const transfer_type_col = csv.column("transfer_type");
+  auto const min_transfer_time_col = csv.column("min_transfer_time");
 
-        auto const to_stop_it = stops.find(t.to_stop_id_->view());
-        if (to_stop_it == end(stops)) {
-          log(log_lvl::error, "loader.gtfs.transfers", "stop {} not found\n",
-              t.to_stop_id_->view());
-          return;
-        }
+  auto t = csv_transfer{};
+  for (auto n = 0U; csv.next(); ++n) {
+    if (n % 65536U == 0U) {
+      progress_tracker->update(csv.position());
+    }
 
-        auto const type = static_cast<transfer_type>(*t.transfer_type_);
-        if (type == transfer_type::kNotPossible || from_stop_it == to_stop_it) {
-          return;
-        }
+    parse_field(csv[from_stop_id_col], *t.from_stop_id_);
+    parse_field(csv[to_stop_id_col], *t.to_stop_id_);
+    parse_field(csv[transfer_type_col], *t.transfer_type_);
+    parse_field(csv[min_transfer_time_col], *t.min_transfer_time_);
 
-        auto& footpaths = from_stop_it->second->footpaths_;
-        auto const it = std::find_if(
-            begin(footpaths), end(footpaths), [&](footpath const& fp) {
-              return fp.target() == to_stop_it->second->location_;
-            });
-        if (it == end(footpaths)) {
-          footpaths.emplace_back(to_stop_it->second->location_,
-                                 duration_t{*t.min_transfer_time_ / 60});
-        }
-      });
+    auto const from_stop_it = stops.find(t.from_stop_id_->view());
+    if (from_stop_it == end(stops)) {
+      log(log_lvl::error, "loader.gtfs.transfers", "stop {} not found\n",
+          t.from_stop_id_->view());
+      continue;
+    }
+
+    auto const to_stop_it = stops.find(t.to_stop_id_->view());
+    if (to_stop_it == end(stops)) {
+      log(log_lvl::error, "loader.gtfs.transfers", "stop {} not found\n",
+          t.to_stop_id_->view());
+      continue;
+    }
+
+    auto const type = static_cast<transfer_type>(*t.transfer_type_);
+    if (type == transfer_type::kNotPossible || from_stop_it == to_stop_it) {
+      continue;
+    }
+
+    auto& footpaths = from_stop_it->second->footpaths_;
+    auto const it = std::find_if(
+        begin(footpaths), end(footpaths), [&](footpath const& fp) {
+          return fp.target() == to_stop_it->second->location_;
+        });
+    if (it == end(footpaths)) {
+      footpaths.emplace_back(to_stop_it->second->location_,
+                             duration_t{*t.min_transfer_time_ / 60});
+    }
+  }
+  progress_tracker->update(file_content.size());
 }
 
 locations_map read_stops(source_idx_t const src,
@@ -186,34 +197,55 @@ locations_map read_stops(source_idx_t const src,
   locations_map locations;
   stop_map_t stops;
   hash_map<std::string_view, std::vector<stop*>> equal_names;
-  utl::line_range{utl::make_buf_reader(stops_file_content,
-                                       progress_tracker->update_fn())}  //
-      | utl::csv<csv_stop>()  //
-      |
-      utl::for_each([&](csv_stop& s) {
-        auto const new_stop = utl::get_or_create(stops, s.id_->view(), [&]() {
-                                return std::make_unique<stop>();
-                              }).get();
-
-        new_stop->id_ = s.id_->view();
-        new_stop->name_ = std::move(*s.name_);
-        new_stop->coord_ = {utl::parse<double>(s.lat_->trim()),
-                            utl::parse<double>(s.lon_->trim())};
-        new_stop->platform_code_ = s.platform_code_->view();
-        new_stop->timezone_ = s.timezone_->trim().view();
-
-        if (!s.parent_station_->trim().empty()) {
-          auto const parent =
-              utl::get_or_create(stops, s.parent_station_->trim().view(), []() {
-                return std::make_unique<stop>();
-              }).get();
-          parent->id_ = s.parent_station_->trim().view();
-          parent->children_.emplace(new_stop);
-          new_stop->parent_ = parent;
-        }
 
-        equal_names[new_stop->name_.view()].emplace_back(new_stop);
-      });
+  // Stop IDs are views into the input or the scanner, which outlive stops.
+  auto csv = csv_scanner{stops_file_content};
+  auto const id_col = csv.column("stop_id");
+  auto const name_col = csv.column("stop_name");
+  auto const timezone_col = csv.column("stop_timezone");
+  auto const parent_station_col = csv.column("parent_station");
+  auto const platform_code_col = csv.column("platform_code");
+  auto const lat_col = csv.column("stop_lat");
+  auto const lon_col = csv.column("stop_lon");
+
+  auto row = csv_stop{};
+  for (auto n = 0U; csv.next(); ++n) {
+    if (n % 65536U == 0U) {
+      progress_tracker->update(csv.position());
+    }
+
+    parse_field(csv[id_col], *row.id_);
+    parse_field(csv[name_col], *row.name_);
+    parse_field(csv[timezone_col], *row.timezone_);
+    parse_field(csv[parent_station_col], *row.parent_station_);
+    parse_field(csv[platform_code_col], *row.platform_code_);
+    parse_field(csv[lat_col], *row.lat_);
+    parse_field(csv[lon_col], *row.lon_);
+
+    auto const new_stop = utl::get_or_create(stops, row.id_->view(), [&]() {
+                            return std::make_unique<stop>();
+                          }).get();
+
+    new_stop->id_ = row.id_->view();
+    new_stop->name_ = std::move(*row.name_);
+    new_stop->coord_ = {utl::parse<double>(row.lat_->trim()),
+                        utl::parse<double>(row.lon_->trim())};
+    new_stop->platform_code_ = row.platform_code_->view();
+    new_stop->timezone_ = row.timezone_->trim().view();
+
+    if (!row.parent_station_->trim().empty()) {
+      auto const parent =
+          utl::get_or_create(stops, row.parent_station_->trim().view(), []() {
+            return std::make_unique<stop>();
+          }).get();
+      parent->id_ = row.parent_station_->trim().view();
+      parent->children_.emplace(new_stop);
+      new_stop->parent_ = parent;
+    }
+
+    equal_names[new_stop->name_.view()].emplace_back(new_stop);
+  }
+  progress_tracker->update(stops_file_content.size());
 
   auto const stop_vec =
       utl::to_vec(stops, [](auto const& s) { return s.second.get(); });
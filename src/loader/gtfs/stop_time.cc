@@ -1,26 +1,117 @@
 #include "nigiri/loader/gtfs/stop_time.h"
 
 #include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
 #include <tuple>
+#include <vector>
 
 #include "utl/enumerate.h"
+#include "utl/parallel_for.h"
 #include "utl/parser/arg_parser.h"
-#include "utl/parser/buf_reader.h"
 #include "utl/parser/csv.h"
 #include "utl/parser/csv_range.h"
-#include "utl/parser/line_range.h"
 #include "utl/pipes/transform.h"
 #include "utl/pipes/vec.h"
 #include "utl/progress_tracker.h"
 
+#include "nigiri/loader/gtfs/csv_scanner.h"
 #include "nigiri/loader/gtfs/parse_time.h"
 #include "nigiri/loader/gtfs/trip.h"
 #include "nigiri/common/cached_lookup.h"
 #include "nigiri/logging.h"
-#include "utl/pipes/for_each.h"
 
 namespace nigiri::loader::gtfs {
 
+namespace {
+
+struct csv_stop_time {
+  utl::csv_col<utl::cstr, UTL_NAME("trip_id")> trip_id_;
+  utl::csv_col<utl::cstr, UTL_NAME("arrival_time")> arrival_time_;
+  utl::csv_col<utl::cstr, UTL_NAME("departure_time")> departure_time_;
+  utl::csv_col<utl::cstr, UTL_NAME("stop_id")> stop_id_;
+  utl::csv_col<std::uint16_t, UTL_NAME("stop_sequence")> stop_sequence_;
+  utl::csv_col<utl::cstr, UTL_NAME("stop_headsign")> stop_headsign_;
+  utl::csv_col<int, UTL_NAME("pickup_type")> pickup_type_;
+  utl::csv_col<int, UTL_NAME("drop_off_type")> drop_off_type_;
+  utl::csv_col<double, UTL_NAME("shape_dist_traveled")> distance_;
+};
+
+void parse(std::string_view const header, stop_time_chunk& c) {
+  c.scanner_ = std::make_unique<csv_scanner>(header, c.content_);
+  auto& csv = *c.scanner_;
+  auto const trip_id_col = csv.column("trip_id");
+  auto const arrival_time_col = csv.column("arrival_time");
+  auto const departure_time_col = csv.column("departure_time");
+  auto const stop_id_col = csv.column("stop_id");
+  auto const stop_sequence_col = csv.column("stop_sequence");
+  auto const stop_headsign_col = csv.column("stop_headsign");
+  auto const pickup_type_col = csv.column("pickup_type");
+  auto const drop_off_type_col = csv.column("drop_off_type");
+  auto const distance_col = csv.column("shape_dist_traveled");
+
+  auto s = csv_stop_time{};
+  while (csv.next()) {
+    parse_field(csv[trip_id_col], *s.trip_id_);
+    parse_field(csv[arrival_time_col], *s.arrival_time_);
+    parse_field(csv[departure_time_col], *s.departure_time_);
+    parse_field(csv[stop_id_col], *s.stop_id_);
+    parse_field(csv[stop_sequence_col], *s.stop_sequence_);
+    parse_field(csv[stop_headsign_col], *s.stop_headsign_);
+    parse_field(csv[pickup_type_col], *s.pickup_type_);
+    parse_field(csv[drop_off_type_col], *s.drop_off_type_);
+    parse_field(csv[distance_col], *s.distance_);
+
+    auto& row = c.rows_.emplace_back(
+        stop_time_row{.trip_id_ = *s.trip_id_,
+                      .stop_id_ = *s.stop_id_,
+                      .headsign_ = *s.stop_headsign_,
+                      .arr_ = {},
+                      .dep_ = {},
+                      .distance_ = *s.distance_,
+                      .trip_ = gtfs_trip_idx_t::invalid(),
+                      .stop_ = {},
+                      .stop_sequence_ = *s.stop_sequence_,
+                      .in_allowed_ = *s.pickup_type_ != 1,
+                      .out_allowed_ = *s.drop_off_type_ != 1,
+                      .valid_times_ = false,
+                      .valid_ = false});
+    try {
+      row.arr_ = hhmm_to_min(*s.arrival_time_);
+      row.dep_ = hhmm_to_min(*s.departure_time_);
+      row.valid_times_ = true;
+    } catch (...) {
+      // Reported like an unknown stop if the trip exists.
+    }
+  }
+  c.parsed_ = true;
+}
+
+// Resolves trips and stops. Reads shared data only.
+void resolve(trip_data const& trips,
+             locations_map const& stops,
+             stop_time_chunk& c) {
+  for (auto& row : c.rows_) {
+    auto const trip_it = trips.trips_.find(row.trip_id_.view());
+    if (trip_it == end(trips.trips_)) {
+      continue;
+    }
+    row.trip_ = trip_it->second;
+
+    auto const stop_it = stops.find(row.stop_id_.view());
+    if (!row.valid_times_ || stop_it == end(stops)) {
+      continue;
+    }
+    row.stop_ = stop{stop_it->second, row.in_allowed_, row.out_allowed_,
+                     row.in_allowed_, row.out_allowed_}
+                    .value();
+    row.valid_ = true;
+  }
+}
+
+}  // namespace
+
 void add_distance(auto& trip_data, double const distance) {
   auto& distances = trip_data.distance_traveled_;
   if (distances.empty()) {
@@ -33,96 +124,139 @@ void add_distance(auto& trip_data, double const distance) {
   }
 }
 
+stop_time_chunks split_stop_times(std::string_view const file_content,
+                            std::size_t const chunk_size) {
+  auto const header_end = file_content.find('\n');
+  if (header_end == std::string_view::npos) {
+    return {};
+  }
+
+  auto st =
+      stop_time_chunks{.header_ = file_content.substr(0U, header_end + 1U)};
+  auto const rows = file_content.substr(header_end + 1U);
+  auto from = std::size_t{0U};
+  while (from < rows.size()) {
+    auto to = std::min(from + std::max(chunk_size, std::size_t{1U}),
+                       rows.size());
+    if (to != rows.size()) {
+      auto const nl = rows.find('\n', to);
+      to = nl == std::string_view::npos ? rows.size() : nl + 1U;
+    }
+    st.chunks_.emplace_back().content_ = rows.substr(from, to - from);
+    from = to;
+  }
+  return st;
+}
+
+void parse_stop_times(stop_time_chunks& st) {
+  utl::parallel_for_run(st.chunks_.size(), [&](std::size_t const i) {
+    parse(st.header_, st.chunks_[i]);
+  });
+}
+
 void read_stop_times(timetable& tt,
                      trip_data& trips,
                      locations_map const& stops,
                      std::string_view file_content,
-                     bool const store_distances) {
-  struct csv_stop_time {
-    utl::csv_col<utl::cstr, UTL_NAME("trip_id")> trip_id_;
-    utl::csv_col<utl::cstr, UTL_NAME("arrival_time")> arrival_time_;
-    utl::csv_col<utl::cstr, UTL_NAME("departure_time")> departure_time_;
-    utl::csv_col<utl::cstr, UTL_NAME("stop_id")> stop_id_;
-    utl::csv_col<std::uint16_t, UTL_NAME("stop_sequence")> stop_sequence_;
-    utl::csv_col<utl::cstr, UTL_NAME("stop_headsign")> stop_headsign_;
-    utl::csv_col<int, UTL_NAME("pickup_type")> pickup_type_;
-    utl::csv_col<int, UTL_NAME("drop_off_type")> drop_off_type_;
-    utl::csv_col<double, UTL_NAME("shape_dist_traveled")> distance_;
-  };
+                     bool const store_distances,
+                     std::size_t const chunk_size) {
+  auto st = split_stop_times(file_content, chunk_size);
+  read_stop_times(tt, trips, stops, st, store_distances);
+}
 
+void read_stop_times(timetable& tt,
+                     trip_data& trips,
+                     locations_map const& stops,
+                     stop_time_chunks& st,
+                     bool const store_distances) {
   auto const timer = scoped_timer{"read stop times"};
-  std::string last_trip_id;
+
+  // Apply rows in file order. Trips spanning multiple chunks are continued
+  // exactly like in a sequential pass.
   trip* last_trip = nullptr;
   auto i = 1U;
-  auto const progress_tracker = utl::get_active_progress_tracker();
-  progress_tracker->status("Read Stop Times")
-      .out_bounds(43.F, 68.F)
-      .in_high(file_content.size());
   auto lookup_direction = cached_lookup(trips.directions_);
-  utl::line_range{
-      utl::make_buf_reader(file_content, progress_tracker->update_fn())}  //
-      | utl::csv<csv_stop_time>()  //
-      |
-      utl::for_each([&](csv_stop_time const& s) {
-        ++i;
-
-        trip* t = nullptr;
-        auto const t_id = s.trip_id_->view();
-        if (last_trip != nullptr && t_id == last_trip_id) {
-          t = last_trip;
-        } else {
-          if (last_trip != nullptr) {
-            last_trip->to_line_ = i - 1;
-          }
-
-          auto const trip_it = trips.trips_.find(t_id);
-          if (trip_it == end(trips.trips_)) {
-            log(log_lvl::error, "loader.gtfs.stop_time",
-                "stop_times.txt:{} trip \"{}\" not found", i, t_id);
-            return;
-          }
-          t = &trips.data_[trip_it->second];
-          last_trip_id = t_id;
-          last_trip = t;
-
-          t->from_line_ = i;
+  auto const apply = [&](stop_time_chunk const& c) {
+    for (auto const& row : c.rows_) {
+      ++i;
+
+      trip* t = nullptr;
+      if (last_trip != nullptr && row.trip_ != gtfs_trip_idx_t::invalid() &&
+          &trips.data_[row.trip_] == last_trip) {
+        t = last_trip;
+      } else {
+        if (last_trip != nullptr) {
+          last_trip->to_line_ = i - 1;
         }
 
-        try {
-          auto const arrival_time = hhmm_to_min(*s.arrival_time_);
-          auto const departure_time = hhmm_to_min(*s.departure_time_);
-          auto const in_allowed = *s.pickup_type_ != 1;
-          auto const out_allowed = *s.drop_off_type_ != 1;
-
-          t->requires_interpolation_ |= arrival_time == kInterpolate;
-          t->requires_interpolation_ |= departure_time == kInterpolate;
-          t->requires_sorting_ |= (!t->seq_numbers_.empty() &&
-                                   t->seq_numbers_.back() > *s.stop_sequence_);
-
-          t->seq_numbers_.emplace_back(*s.stop_sequence_);
-          t->stop_seq_.push_back(stop{stops.at(s.stop_id_->view()), in_allowed,
-                                      out_allowed, in_allowed, out_allowed}
-                                     .value());
-          t->event_times_.emplace_back(
-              stop_events{.arr_ = arrival_time, .dep_ = departure_time});
-          if (store_distances) {
-            add_distance(*t, *s.distance_);
-          }
-
-          if (!s.stop_headsign_->empty()) {
-            t->stop_headsigns_.resize(t->seq_numbers_.size(),
-                                      trip_direction_idx_t::invalid());
-            t->stop_headsigns_.back() =
-                lookup_direction(s.stop_headsign_->view(), [&]() {
-                  return trips.get_or_create_direction(
-                      tt, s.stop_headsign_->view());
-                });
-          }
-        } catch (...) {
+        if (row.trip_ == gtfs_trip_idx_t::invalid()) {
           log(log_lvl::error, "loader.gtfs.stop_time",
-              "stop_times.txt:{}: unknown stop \"{}\"", i, s.stop_id_->view());
+              "stop_times.txt:{} trip \"{}\" not found", i,
+              row.trip_id_.view());
+          continue;
         }
-      });
+        t = &trips.data_[row.trip_];
+        last_trip = t;
+
+        t->from_line_ = i;
+      }
+
+      if (!row.valid_) {
+        log(log_lvl::error, "loader.gtfs.stop_time",
+            "stop_times.txt:{}: unknown stop \"{}\"", i, row.stop_id_.view());
+        continue;
+      }
+
+      t->requires_interpolation_ |= row.arr_ == kInterpolate;
+      t->requires_interpolation_ |= row.dep_ == kInterpolate;
+      t->requires_sorting_ |= (!t->seq_numbers_.empty() &&
+                               t->seq_numbers_.back() > row.stop_sequence_);
+
+      t->seq_numbers_.emplace_back(row.stop_sequence_);
+      t->stop_seq_.push_back(row.stop_);
+      t->event_times_.emplace_back(
+          stop_events{.arr_ = row.arr_, .dep_ = row.dep_});
+      if (store_distances) {
+        add_distance(*t, row.distance_);
+      }
+
+      if (!row.headsign_.empty()) {
+        auto const headsign = row.headsign_.view();
+        t->stop_headsigns_.resize(t->seq_numbers_.size(),
+                                  trip_direction_idx_t::invalid());
+        t->stop_headsigns_.back() = lookup_direction(headsign, [&]() {
+          return trips.get_or_create_direction(tt, headsign);
+        });
+      }
+    }
+  };
+
+  // Parse (if not done before) and resolve one wave of chunks in parallel,
+  // then apply it before the next wave. Without prior parsing, at most one
+  // wave of parsed rows is held in memory.
+  auto& chunks = st.chunks_;
+  auto const progress_tracker = utl::get_active_progress_tracker();
+  progress_tracker->status("Read Stop Times")
+      .out_bounds(43.F, 68.F)
+      .in_high(chunks.size());
+  auto const wave_size =
+      std::max(std::size_t{std::thread::hardware_concurrency()},
+               std::size_t{1U});
+  for (auto from = std::size_t{0U}; from < chunks.size(); from += wave_size) {
+    auto const to = std::min(from + wave_size, chunks.size());
+    utl::parallel_for_run(to - from, [&](std::size_t const j) {
+      auto& c = chunks[from + j];
+      if (!c.parsed_) {
+        parse(st.header_, c);
+      }
+      resolve(trips, stops, c);
+      progress_tracker->increment();
+    });
+    for (auto j = from; j != to; ++j) {
+      apply(chunks[j]);
+      chunks[j] = stop_time_chunk{};  // Parsed rows are not needed anymore.
+    }
+  }
 
   if (last_trip != nullptr) {
     last_trip->to_line_ = i;
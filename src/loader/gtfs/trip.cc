@@ -10,15 +10,13 @@
 #include "utl/erase_if.h"
 #include "utl/get_or_create.h"
 #include "utl/helpers/algorithm.h"
-#include "utl/parser/buf_reader.h"
 #include "utl/parser/csv.h"
 #include "utl/parser/csv_range.h"
-#include "utl/parser/line_range.h"
-#include "utl/pipes/for_each.h"
 #include "utl/progress_tracker.h"
 #include "utl/to_vec.h"
 #include "utl/verify.h"
 
+#include "nigiri/loader/gtfs/csv_scanner.h"
 #include "nigiri/loader/gtfs/parse_time.h"
 #include "nigiri/logging.h"
 #include "nigiri/timetable.h"
@@ -280,56 +278,77 @@ trip_data read_trips(
   progress_tracker->status("Read Trips")
       .out_bounds(38.F, 42.F)
       .in_high(file_content.size());
-  utl::line_range{
-      utl::make_buf_reader(file_content, progress_tracker->update_fn())}  //
-      | utl::csv<csv_trip>()  //
-      | utl::for_each([&](csv_trip const& t) {
-          auto const traffic_days_it = services.find(t.service_id_->view());
-          if (traffic_days_it == end(services)) {
-            log(log_lvl::error, "loader.gtfs.trip",
-                R"(trip "{}": service_id "{}" not found)", t.trip_id_->view(),
-                t.service_id_->view());
-            return;
-          }
-
-          auto const route_it = routes.find(t.route_id_->view());
-          if (route_it == end(routes)) {
-            log(log_lvl::error, "loader.gtfs.trip",
-                R"(trip "{}": route_id "{}" not found)", t.trip_id_->view(),
-                t.route_id_->view());
-            return;
-          }
-
-          auto const shape_it = shapes.find(t.shape_id_->view());
-          auto const shape_idx = (shape_it == end(shapes))
-                                     ? shape_idx_t::invalid()
-                                     : shape_it->second;
-
-          auto bikes_allowed = bikes_allowed_default[static_cast<std::size_t>(
-              route_it->second->clasz_)];
-          if (t.bikes_allowed_.val() == 1) {
-            bikes_allowed = true;
-          } else if (t.bikes_allowed_.val() == 2) {
-            bikes_allowed = false;
-          }
-
-          auto const blk = t.block_id_->trim().empty()
-                               ? nullptr
-                               : utl::get_or_create(
-                                     ret.blocks_, t.block_id_->trim().view(),
-                                     []() { return std::make_unique<block>(); })
-                                     .get();
-          auto const trp_idx = gtfs_trip_idx_t{ret.data_.size()};
-          ret.data_.emplace_back(
-              route_it->second.get(), traffic_days_it->second.get(), blk,
-              t.trip_id_->to_str(),
-              ret.get_or_create_direction(tt, t.trip_headsign_->view()),
-              t.trip_short_name_->to_str(), shape_idx, bikes_allowed);
-          ret.trips_.emplace(t.trip_id_->to_str(), trp_idx);
-          if (blk != nullptr) {
-            blk->trips_.emplace_back(trp_idx);
-          }
-        });
+  auto csv = csv_scanner{file_content};
+  auto const route_id_col = csv.column("route_id");
+  auto const service_id_col = csv.column("service_id");
+  auto const trip_id_col = csv.column("trip_id");
+  auto const trip_headsign_col = csv.column("trip_headsign");
+  auto const trip_short_name_col = csv.column("trip_short_name");
+  auto const block_id_col = csv.column("block_id");
+  auto const shape_id_col = csv.column("shape_id");
+  auto const bikes_allowed_col = csv.column("bikes_allowed");
+
+  auto t = csv_trip{};
+  for (auto n = 0U; csv.next(); ++n) {
+    if (n % 65536U == 0U) {
+      progress_tracker->update(csv.position());
+    }
+
+    parse_field(csv[route_id_col], *t.route_id_);
+    parse_field(csv[service_id_col], *t.service_id_);
+    parse_field(csv[trip_id_col], *t.trip_id_);
+    parse_field(csv[trip_headsign_col], *t.trip_headsign_);
+    parse_field(csv[trip_short_name_col], *t.trip_short_name_);
+    parse_field(csv[block_id_col], *t.block_id_);
+    parse_field(csv[shape_id_col], *t.shape_id_);
+    parse_field(csv[bikes_allowed_col], *t.bikes_allowed_);
+
+    auto const traffic_days_it = services.find(t.service_id_->view());
+    if (traffic_days_it == end(services)) {
+      log(log_lvl::error, "loader.gtfs.trip",
+          R"(trip "{}": service_id "{}" not found)", t.trip_id_->view(),
+          t.service_id_->view());
+      continue;
+    }
+
+    auto const route_it = routes.find(t.route_id_->view());
+    if (route_it == end(routes)) {
+      log(log_lvl::error, "loader.gtfs.trip",
+          R"(trip "{}": route_id "{}" not found)", t.trip_id_->view(),
+          t.route_id_->view());
+      continue;
+    }
+
+    auto const shape_it = shapes.find(t.shape_id_->view());
+    auto const shape_idx =
+        (shape_it == end(shapes)) ? shape_idx_t::invalid() : shape_it->second;
+
+    auto bikes_allowed = bikes_allowed_default[static_cast<std::size_t>(
+        route_it->second->clasz_)];
+    if (t.bikes_allowed_.val() == 1) {
+      bikes_allowed = true;
+    } else if (t.bikes_allowed_.val() == 2) {
+      bikes_allowed = false;
+    }
+
+    auto const blk =
+        t.block_id_->trim().empty()
+            ? nullptr
+            : utl::get_or_create(ret.blocks_, t.block_id_->trim().view(), []() {
+                return std::make_unique<block>();
+              }).get();
+    auto const trp_idx = gtfs_trip_idx_t{ret.data_.size()};
+    ret.data_.emplace_back(
+        route_it->second.get(), traffic_days_it->second.get(), blk,
+        t.trip_id_->to_str(),
+        ret.get_or_create_direction(tt, t.trip_headsign_->view()),
+        t.trip_short_name_->to_str(), shape_idx, bikes_allowed);
+    ret.trips_.emplace(t.trip_id_->to_str(), trp_idx);
+    if (blk != nullptr) {
+      blk->trips_.emplace_back(trp_idx);
+    }
+  }
+  progress_tracker->update(file_content.size());
   return ret;
 }
 
@@ -350,43 +369,57 @@ void read_frequencies(trip_data& trips, std::string_view file_content) {
   progress_tracker->status("Read Frequencies")
       .out_bounds(42.F, 43.F)
       .in_high(file_content.size());
-  return utl::line_range{utl::make_buf_reader(
-             file_content, progress_tracker->update_fn())}  //
-         | utl::csv<csv_frequency>()  //
-         |
-         utl::for_each([&](csv_frequency const& freq) {
-           auto const t = freq.trip_id_->trim().view();
-           auto const trip_it = trips.trips_.find(t);
-           if (trip_it == end(trips.trips_)) {
-             log(log_lvl::error, "loader.gtfs.frequencies",
-                 "frequencies.txt: skipping frequency (trip \"{}\" not found)",
-                 t);
-             return;
-           }
-
-           auto const headway_secs_str = *freq.headway_secs_;
-           auto const headway_secs = parse<int>(headway_secs_str, -1);
-           if (headway_secs == -1) {
-             log(log_lvl::error, "loader.gtfs.frequencies",
-                 R"(frequencies.txt: skipping frequency (invalid headway secs "{}"))",
-                 headway_secs_str.view());
-             return;
-           }
-
-           auto const exact = freq.exact_times_->view();
-           auto const schedule_relationship =
-               exact == "1" ? frequency::schedule_relationship::kScheduled
-                            : frequency::schedule_relationship::kUnscheduled;
-
-           auto& frequencies = trips.data_[trip_it->second].frequency_;
-           if (!frequencies.has_value()) {
-             frequencies = std::vector<frequency>{};
-           }
-           frequencies->emplace_back(
-               frequency{hhmm_to_min(freq.start_time_->view()),
-                         hhmm_to_min(freq.end_time_->view()),
-                         duration_t{headway_secs / 60}, schedule_relationship});
-         });
+  auto csv = csv_scanner{file_content};
+  auto const trip_id_col = csv.column("trip_id");
+  auto const start_time_col = csv.column("start_time");
+  auto const end_time_col = csv.column("end_time");
+  auto const headway_secs_col = csv.column("headway_secs");
+  auto const exact_times_col = csv.column("exact_times");
+
+  auto freq = csv_frequency{};
+  for (auto n = 0U; csv.next(); ++n) {
+    if (n % 65536U == 0U) {
+      progress_tracker->update(csv.position());
+    }
+
+    parse_field(csv[trip_id_col], *freq.trip_id_);
+    parse_field(csv[start_time_col], *freq.start_time_);
+    parse_field(csv[end_time_col], *freq.end_time_);
+    parse_field(csv[headway_secs_col], *freq.headway_secs_);
+    parse_field(csv[exact_times_col], *freq.exact_times_);
+
+    auto const t = freq.trip_id_->trim().view();
+    auto const trip_it = trips.trips_.find(t);
+    if (trip_it == end(trips.trips_)) {
+      log(log_lvl::error, "loader.gtfs.frequencies",
+          "frequencies.txt: skipping frequency (trip \"{}\" not found)", t);
+      continue;
+    }
+
+    auto const headway_secs_str = *freq.headway_secs_;
+    auto const headway_secs = parse<int>(headway_secs_str, -1);
+    if (headway_secs == -1) {
+      log(log_lvl::error, "loader.gtfs.frequencies",
+          R"(frequencies.txt: skipping frequency (invalid headway secs "{}"))",
+          headway_secs_str.view());
+      continue;
+    }
+
+    auto const exact = freq.exact_times_->view();
+    auto const schedule_relationship =
+        exact == "1" ? frequency::schedule_relationship::kScheduled
+                     : frequency::schedule_relationship::kUnscheduled;
+
+    auto& frequencies = trips.data_[trip_it->second].frequency_;
+    if (!frequencies.has_value()) {
+      frequencies = std::vector<frequency>{};
+    }
+    frequencies->emplace_back(
+        frequency{hhmm_to_min(freq.start_time_->view()),
+                  hhmm_to_min(freq.end_time_->view()),
+                  duration_t{headway_secs / 60}, schedule_relationship});
+  }
+  progress_tracker->update(file_content.size());
 }
 
-}  // namespace nigiri::loader::gtfs
\ No newline at end of file
+}  // namespace nigiri::loader::gtfs
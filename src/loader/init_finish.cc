@@ -44,9 +44,14 @@ void finalize(timetable& tt, finalize_options const opt) {
                             tt.trip_id_strings_[b.first].view());
         });
   }
+  {
+    auto const timer = scoped_timer{"loader.build_trip_id_index"};
+    tt.build_trip_id_index();
+  }
   build_footpaths(tt, opt);
   build_lb_graph<direction::kForward>(tt);
   build_lb_graph<direction::kBackward>(tt);
+  tt.fingerprint_ = tt.compute_fingerprint();
 }
 
 void finalize(timetable& tt,
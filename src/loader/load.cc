@@ -1,8 +1,20 @@
 #include "nigiri/loader/load.h"
 
+#include <deque>
+#include <fstream>
+#include <future>
+#include <map>
+#include <set>
+
+#include "fmt/format.h"
 #include "fmt/std.h"
 
-#include "utl/enumerate.h"
+#include "cista/hash.h"
+#include "cista/type_hash/type_hash.h"
+
+#include "utl/helpers/algorithm.h"
+#include "utl/parallel_for.h"
+#include "utl/verify.h"
 
 #include "nigiri/loader/dir.h"
 #include "nigiri/loader/gtfs/loader.h"
@@ -12,6 +24,224 @@
 
 namespace nigiri::loader {
 
+namespace {
+
+// Number of sources that are opened, extracted and prepared ahead of the
+// source that is currently loaded into the timetable.
+constexpr auto const kPrefetchedSources = 4U;
+
+// No further sources are prefetched while the queued ones exceed this size:
+// the extracted files plus the prepared data, estimated at the size of the
+// files the loader reads.
+constexpr auto const kPrefetchedBytes = std::size_t{2U} * 1024U * 1024U * 1024U;
+
+// Zip archive with the files the loader reads already extracted. Inflating is
+// the expensive part of reading a zip and does not depend on the timetable.
+// Path, type and hash are the ones of the archive, so loading yields the same
+// timetable.
+struct extracted_dir final : public dir {
+  struct view_content final : public file::content {
+    explicit view_content(std::string_view s) : s_{s} {}
+    std::string_view get() const final { return s_; }
+    std::string_view s_;
+  };
+
+  extracted_dir(std::unique_ptr<dir> d,
+                std::vector<std::filesystem::path> const& files)
+      : dir{d->path()}, d_{std::move(d)} {
+    for (auto const& p : files) {
+      files_.emplace(p, d_->get_file(p));
+    }
+  }
+
+  std::vector<std::filesystem::path> list_files(
+      std::filesystem::path const& p) const final {
+    return d_->list_files(p);
+  }
+  file get_file(std::filesystem::path const& p) const final {
+    auto const it = files_.find(p);
+    return it == end(files_)
+               ? d_->get_file(p)
+               : file{p.string(),
+                      std::make_unique<view_content>(it->second.data())};
+  }
+  bool exists(std::filesystem::path const& p) const final {
+    return d_->exists(p);
+  }
+  std::size_t file_size(std::filesystem::path const& p) const final {
+    return d_->file_size(p);
+  }
+  dir_type type() const final { return d_->type(); }
+  std::uint64_t hash() const final { return d_->hash(); }
+
+  std::unique_ptr<dir> d_;
+  std::map<std::filesystem::path, file> files_;
+};
+
+struct source {
+  std::unique_ptr<dir> dir_;
+  loader_interface const* loader_{nullptr};
+  std::unique_ptr<prepared_source> prepared_;
+};
+
+source open_source(
+    std::string const& path,
+    std::vector<std::unique_ptr<loader_interface>> const& loaders) {
+  auto s = source{};
+  if (path.starts_with("\n#")) {
+    // hack to load strings in integration tests
+    s.dir_ = std::make_unique<mem_dir>(mem_dir::read(path));
+  } else {
+    s.dir_ = make_dir(path);
+  }
+  auto const it = utl::find_if(
+      loaders, [&](auto&& l) { return l->applicable(*s.dir_); });
+  if (it != end(loaders)) {
+    s.loader_ = it->get();
+  }
+  return s;
+}
+
+// Files that the loader of the source will read.
+std::vector<std::filesystem::path> files_to_read(source const& s,
+                                                 bool const with_shapes) {
+  if (s.loader_ == nullptr) {
+    return {};
+  }
+  auto files = s.loader_->files(with_shapes);
+  std::erase_if(files, [&](auto const& p) { return !s.dir_->exists(p); });
+  return files;
+}
+
+// Increment when loaders change their output for unchanged input, so that
+// checkpoints written by older builds are not restored.
+constexpr auto const kCheckpointVersion = 1U;
+
+constexpr auto const kCheckpointPrefix = std::string_view{"checkpoint-"};
+constexpr auto const kManifestPrefix = std::string_view{"manifest-"};
+
+// Identifies a source configuration independent of the source contents:
+// paths (position for in-memory sources), loader configs and date range.
+// Several configurations can share one cache directory, each one only
+// removes checkpoints it wrote itself.
+cista::hash_t configuration_hash(
+    std::vector<std::pair<std::string, loader_config>> const& paths,
+    interval<date::sys_days> const& date_range) {
+  auto h = cista::hash_combine(cista::BASE_HASH, kCheckpointVersion,
+                               date_range.from_.time_since_epoch().count(),
+                               date_range.to_.time_since_epoch().count());
+  for (auto const& [path, c] : paths) {
+    h = cista::hash_combine(
+        h, path.starts_with("\n#") ? cista::BASE_HASH : cista::hash(path),
+        c.link_stop_distance_, cista::hash(c.default_tz_));
+    for (auto const b : c.bikes_allowed_default_) {
+      h = cista::hash_combine(h, b);
+    }
+  }
+  return h;
+}
+
+// Hash of the first i+1 sources (result[i]) including everything else that
+// influences the timetable before finalize.
+std::vector<cista::hash_t> checkpoint_hashes(
+    std::vector<std::pair<std::string, loader_config>> const& paths,
+    std::vector<std::unique_ptr<loader_interface>> const& loaders,
+    interval<date::sys_days> const& date_range) {
+  auto source_hashes = std::vector<cista::hash_t>(paths.size());
+  utl::parallel_for_run(paths.size(), [&](std::size_t const i) {
+    auto const& [path, c] = paths[i];
+    auto const s = open_source(path, loaders);
+    auto h = cista::hash_combine(
+        cista::BASE_HASH, c.link_stop_distance_, cista::hash(c.default_tz_));
+    for (auto const b : c.bikes_allowed_default_) {
+      h = cista::hash_combine(h, b);
+    }
+    source_hashes[i] =
+        s.loader_ == nullptr
+            ? h
+            : cista::hash_combine(h, cista::hash(s.loader_->name()),
+                                  s.loader_->hash(*s.dir_));
+  });
+
+  auto h = cista::hash_combine(
+      cista::BASE_HASH, kCheckpointVersion, cista::type_hash<timetable>(),
+      date_range.from_.time_since_epoch().count(),
+      date_range.to_.time_since_epoch().count());
+  auto hashes = std::vector<cista::hash_t>{};
+  for (auto const source_hash : source_hashes) {
+    h = cista::hash_combine(h, source_hash);
+    hashes.emplace_back(h);
+  }
+  return hashes;
+}
+
+std::filesystem::path checkpoint_path(std::filesystem::path const& cache_dir,
+                                      cista::hash_t const h) {
+  return cache_dir / fmt::format("{}{:016x}.bin", kCheckpointPrefix, h);
+}
+
+// A checkpoint is written every `interval` sources and after the last one.
+bool is_checkpoint(std::size_t const idx,
+                   std::size_t const n_sources,
+                   unsigned const interval) {
+  return (idx + 1U) % interval == 0U || idx + 1U == n_sources;
+}
+
+std::filesystem::path manifest_path(std::filesystem::path const& cache_dir,
+                                    cista::hash_t const h) {
+  return cache_dir / fmt::format("{}{:016x}.txt", kManifestPrefix, h);
+}
+
+// Checkpoint file names listed in a manifest, one per line.
+std::set<std::string> read_manifest(std::filesystem::path const& p) {
+  auto names = std::set<std::string>{};
+  auto in = std::ifstream{p};
+  for (auto line = std::string{}; std::getline(in, line);) {
+    if (!line.empty()) {
+      names.emplace(std::move(line));
+    }
+  }
+  return names;
+}
+
+// Replaces the manifest of this configuration with the checkpoints of the
+// current sources. Checkpoints listed in the previous manifest are removed
+// unless they are still in use by this or another configuration. Files not
+// listed in any manifest are never touched.
+void update_manifest(std::filesystem::path const& cache_dir,
+                     cista::hash_t const config,
+                     std::vector<cista::hash_t> const& hashes,
+                     unsigned const interval) {
+  auto current = std::set<std::string>{};
+  for (auto i = 0U; i != hashes.size(); ++i) {
+    if (is_checkpoint(i, hashes.size(), interval)) {
+      current.emplace(
+          checkpoint_path(cache_dir, hashes[i]).filename().generic_string());
+    }
+  }
+
+  auto const own = manifest_path(cache_dir, config);
+  auto in_use = current;
+  for (auto const& e : std::filesystem::directory_iterator{cache_dir}) {
+    if (e.path().filename().generic_string().starts_with(kManifestPrefix) &&
+        e.path() != own) {
+      in_use.merge(read_manifest(e.path()));
+    }
+  }
+  for (auto const& name : read_manifest(own)) {
+    if (!in_use.contains(name)) {
+      std::filesystem::remove(cache_dir / name);
+    }
+  }
+
+  auto out = std::ofstream{own};
+  for (auto const& name : current) {
+    out << name << "\n";
+  }
+}
+
+}  // namespace
+
 std::vector<std::unique_ptr<loader_interface>> get_loaders() {
   auto loaders = std::vector<std::unique_ptr<loader_interface>>{};
   loaders.emplace_back(std::make_unique<gtfs::gtfs_loader>());
@@ -27,7 +257,11 @@ timetable load(std::vector<std::pair<std::string, loader_config>> const& paths,
                interval<date::sys_days> const& date_range,
                assistance_times* a,
                shapes_storage* shapes,
-               bool ignore) {
+               bool ignore,
+               std::filesystem::path const& cache_dir,
+               unsigned const checkpoint_interval) {
+  utl::verify(checkpoint_interval != 0U, "checkpoint interval must be > 0");
+
   auto const loaders = get_loaders();
 
   auto tt = timetable{};
@@ -35,26 +269,118 @@ timetable load(std::vector<std::pair<std::string, loader_config>> const& paths,
   register_special_stations(tt);
 
   auto bitfields = hash_map<bitfield, bitfield_idx_t>{};
-  for (auto const [idx, in] : utl::enumerate(paths)) {
-    auto const& [path, local_config] = in;
+
+  // Shapes and assistance times are not part of the checkpoint hashes.
+  auto const use_cache =
+      !cache_dir.empty() && a == nullptr && shapes == nullptr;
+  if (!cache_dir.empty() && !use_cache) {
+    log(log_lvl::info, "loader.load",
+        "cache disabled: not supported with shapes or assistance times");
+  }
+
+  // Continue from the checkpoint covering the most sources.
+  auto first = std::size_t{0U};
+  auto hashes = std::vector<cista::hash_t>{};
+  if (use_cache) {
+    std::filesystem::create_directories(cache_dir);
+    hashes = checkpoint_hashes(paths, loaders, date_range);
+    for (auto i = paths.size(); i != 0U; --i) {
+      auto const p = checkpoint_path(cache_dir, hashes[i - 1U]);
+      if (is_checkpoint(i - 1U, paths.size(), checkpoint_interval) &&
+          std::filesystem::exists(p)) {
+        log(log_lvl::info, "loader.load", "restoring {} sources from {}", i,
+            p);
+        tt = *timetable::read(p);
+        tt.locations_.resolve_timezones();
+        for (auto j = 0U; j != tt.bitfields_.size(); ++j) {
+          bitfields.emplace(tt.bitfields_[bitfield_idx_t{j}],
+                            bitfield_idx_t{j});
+        }
+        first = i;
+        break;
+      }
+    }
+  }
+
+  // Upcoming sources are extracted and prepared (i.e. parsed as far as this
+  // is possible without the timetable) in parallel, bounded by
+  // kPrefetchedSources and kPrefetchedBytes. Loading the prepared data into
+  // the timetable stays sequential in source order, so indices are assigned
+  // exactly as without prefetching.
+  struct prefetched_source {
+    std::future<source> source_;
+    std::size_t bytes_;
+  };
+  auto prefetched = std::deque<prefetched_source>{};
+  auto prefetched_bytes = std::size_t{0U};
+  auto next = first;
+  auto const prefetch = [&]() {
+    while (next != paths.size() && prefetched.size() < kPrefetchedSources &&
+           (prefetched.empty() || prefetched_bytes < kPrefetchedBytes)) {
+      auto s = open_source(paths[next].first, loaders);
+      auto files = files_to_read(s, shapes != nullptr);
+      auto bytes = std::size_t{0U};
+      for (auto const& p : files) {
+        bytes += s.dir_->file_size(p);
+      }
+      if (s.dir_->type() == dir_type::kZip) {
+        bytes *= 2U;
+      } else {
+        files.clear();  // Nothing to extract.
+      }
+      prefetched_bytes += bytes;
+      prefetched.emplace_back(prefetched_source{
+          .source_ = std::async(
+              std::launch::async,
+              [s = std::move(s), files = std::move(files),
+               &c = paths[next].second]() mutable {
+                if (!files.empty()) {
+                  s.dir_ = std::make_unique<extracted_dir>(std::move(s.dir_),
+                                                           files);
+                }
+                if (s.loader_ != nullptr) {
+                  s.prepared_ = s.loader_->prepare(c, *s.dir_);
+                }
+                return std::move(s);
+              }),
+          .bytes_ = bytes});
+      ++next;
+    }
+  };
+
+  for (auto idx = first; idx != paths.size(); ++idx) {
+    prefetch();
+    auto s = prefetched.front().source_.get();
+    prefetched_bytes -= prefetched.front().bytes_;
+    prefetched.pop_front();
+
+    auto const& [path, local_config] = paths[idx];
     auto const is_in_memory = path.starts_with("\n#");
     auto const src = source_idx_t{idx};
-    auto const dir = is_in_memory
-                         // hack to load strings in integration tests
-                         ? std::make_unique<mem_dir>(mem_dir::read(path))
-                         : make_dir(path);
-    auto const it =
-        utl::find_if(loaders, [&](auto&& l) { return l->applicable(*dir); });
-    if (it != end(loaders)) {
+    if (s.loader_ != nullptr) {
       if (!is_in_memory) {
         log(log_lvl::info, "loader.load", "loading {}", path);
       }
-      (*it)->load(local_config, src, *dir, tt, bitfields, a, shapes);
+      if (s.prepared_ != nullptr) {
+        s.loader_->load_prepared(*s.prepared_, local_config, src, *s.dir_, tt,
+                                 bitfields, a, shapes);
+      } else {
+        s.loader_->load(local_config, src, *s.dir_, tt, bitfields, a, shapes);
+      }
     } else if (!ignore) {
       throw utl::fail("no loader for {} found", path);
     } else {
       log(log_lvl::error, "loader.load", "no loader for {} found", path);
     }
+
+    if (use_cache && is_checkpoint(idx, paths.size(), checkpoint_interval)) {
+      tt.write(checkpoint_path(cache_dir, hashes[idx]));
+    }
+  }
+
+  if (use_cache) {
+    update_manifest(cache_dir, configuration_hash(paths, date_range), hashes,
+                    checkpoint_interval);
   }
 
   finalize(tt, finalize_opt);
@@ -62,4 +388,4 @@ timetable load(std::vector<std::pair<std::string, loader_config>> const& paths,
   return tt;
 }
 
-}  // namespace nigiri::loader
\ No newline at end of file
+}  // namespace nigiri::loader
@@ -2,6 +2,29 @@
 
 namespace nigiri::loader {
 
+prepared_source::~prepared_source() = default;
+
 loader_interface::~loader_interface() = default;
 
+std::vector<std::filesystem::path> loader_interface::files(bool) const {
+  return {};
+}
+
+std::unique_ptr<prepared_source> loader_interface::prepare(loader_config const&,
+                                                           dir const&) const {
+  return nullptr;
+}
+
+void loader_interface::load_prepared(
+    prepared_source&,
+    loader_config const& c,
+    source_idx_t const src,
+    dir const& d,
+    timetable& tt,
+    hash_map<bitfield, bitfield_idx_t>& bitfields,
+    assistance_times* assistance,
+    shapes_storage* shapes) const {
+  load(c, src, d, tt, bitfields, assistance, shapes);
+}
+
 }  // namespace nigiri::loader
\ No newline at end of file
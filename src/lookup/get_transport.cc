@@ -18,13 +18,7 @@ void for_each_schedule_transport(timetable const& tt,
            tt.trip_id_strings_[t_id_idx].view() == id.id_;
   };
 
-  auto const lb = std::lower_bound(
-      begin(tt.trip_id_to_idx_), end(tt.trip_id_to_idx_), id,
-      [&](pair<trip_id_idx_t, trip_idx_t> const& a, trip_id const& b) {
-        return std::tuple(tt.trip_id_src_[a.first],
-                          tt.trip_id_strings_[a.first].view()) <
-               std::tuple(b.src_, std::string_view{b.id_});
-      });
+  auto const lb = tt.find_trip_id(id.src_, id.id_);
 
   // One trip can have several transports associated to it. Reasons:
   //  - local to UTC time conversion results in different time strings, the
@@ -0,0 +1,65 @@
+#include "nigiri/routing/mc_raptor/mc_raptor_state.h"
+
+#include "utl/helpers/algorithm.h"
+
+namespace nigiri::routing {
+
+mc_raptor_state& mc_raptor_state::resize(unsigned const n_locations,
+                                         unsigned const n_routes) {
+  clear_bags();
+  n_locations_ = n_locations;
+  bag_idx_.resize((kMaxTransfers + 2U) * n_locations, mc_label_ref::kInvalid);
+  station_mark_.resize(n_locations);
+  prev_station_mark_.resize(n_locations);
+  route_mark_.resize(n_routes);
+  tmp_mark_.resize(n_locations);
+  return *this;
+}
+
+std::uint32_t mc_raptor_state::get_or_create_bag(unsigned const k,
+                                                 std::uint32_t const l,
+                                                 delta_t const invalid) {
+  auto& idx = bag_idx(k, l);
+  if (idx != mc_label_ref::kInvalid) {
+    return idx;
+  }
+
+  if (free_bags_.empty()) {
+    idx = static_cast<std::uint32_t>(bags_.size());
+    bags_.emplace_back();
+    infos_.emplace_back();
+  } else {
+    idx = free_bags_.back();
+    free_bags_.pop_back();
+  }
+
+  auto& b = bags_[idx];
+  b.time_.fill(invalid);
+  b.walk_.fill(kMcInvalidWalk);
+  used_bag_idx_.emplace_back(k * n_locations_ + l);
+  return idx;
+}
+
+void mc_raptor_state::free_bags(unsigned const k, mark_set& stops) {
+  stops.for_each_set_bit([&](std::uint64_t const l) {
+    auto& idx = bag_idx(k, static_cast<std::uint32_t>(l));
+    if (idx != mc_label_ref::kInvalid) {
+      free_bags_.emplace_back(idx);
+      idx = mc_label_ref::kInvalid;
+    }
+  });
+}
+
+void mc_raptor_state::clear_bags() {
+  for (auto const i : used_bag_idx_) {
+    bag_idx_[i] = mc_label_ref::kInvalid;
+  }
+  used_bag_idx_.clear();
+
+  free_bags_.resize(bags_.size());
+  for (auto i = 0U; i != bags_.size(); ++i) {
+    free_bags_[i] = static_cast<std::uint32_t>(bags_.size() - i - 1U);
+  }
+}
+
+}  // namespace nigiri::routing
@@ -0,0 +1,25 @@
+#include "nigiri/routing/mc_raptor_search.h"
+
+#include <utility>
+
+#include "utl/verify.h"
+
+namespace nigiri::routing {
+
+routing_result<mc_raptor_stats> mc_raptor_search(
+    timetable const& tt,
+    search_state& s_state,
+    mc_raptor_state& mc_state,
+    query q,
+    std::optional<std::chrono::seconds> const timeout) {
+  utl::verify(q.via_stops_.empty(), "mc_raptor_search: via stops unsupported");
+  utl::verify(q.td_dest_.empty() && q.td_start_.empty(),
+              "mc_raptor_search: time-dependent offsets unsupported");
+
+  using algo_t = mc_raptor<direction::kForward>;
+  return search<direction::kForward, algo_t>{
+      tt, nullptr, s_state, mc_state, std::move(q), timeout}
+      .execute();
+}
+
+}  // namespace nigiri::routing
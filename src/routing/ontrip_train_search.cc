@@ -0,0 +1,200 @@
+#include "nigiri/routing/ontrip_train.h"
+
+#include <algorithm>
+
+#include "utl/enumerate.h"
+#include "utl/verify.h"
+
+#include "nigiri/logging.h"
+#include "nigiri/routing/dijkstra.h"
+#include "nigiri/routing/get_fastest_direct.h"
+#include "nigiri/routing/raptor/raptor.h"
+#include "nigiri/routing/sanitize_via_stops.h"
+#include "nigiri/routing/search.h"
+#include "nigiri/routing/start_times.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::routing {
+
+namespace {
+
+template <bool Rt, via_offset_t Vias>
+std::vector<ontrip_train_result> ontrip_train_search_with_vias(
+    timetable const& tt,
+    rt_timetable const* rtt,
+    search_state& s_state,
+    raptor_state& r_state,
+    transport const& t,
+    stop_idx_t const first_stop_idx,
+    query& q) {
+  using algo_t = raptor<direction::kForward, Rt, Vias>;
+
+  auto const location_seq =
+      tt.route_location_seq_[tt.transport_route_[t.t_idx_]];
+  auto const n_stops = static_cast<stop_idx_t>(location_seq.size());
+
+  auto& tts = q.transfer_time_settings_;
+  tts.factor_ = std::max(tts.factor_, 1.0F);
+  if (tts.factor_ == 1.0F && tts.min_transfer_time_ == 0_minutes) {
+    tts.default_ = true;
+  }
+
+  collect_destinations(tt, q.destination_, q.dest_match_mode_,
+                       s_state.is_destination_, s_state.dist_to_dest_);
+  for (auto const [i, via] : utl::enumerate(q.via_stops_)) {
+    collect_via_destinations(tt, via.location_, s_state.is_via_[i]);
+  }
+  dijkstra(tt, q, tt.fwd_search_lb_graph_, s_state.travel_time_lower_bound_);
+
+  auto const time_at_first =
+      tt.event_time(t, first_stop_idx, event_type::kArr);
+  auto algo = algo_t{
+      tt,
+      rtt,
+      r_state,
+      s_state.is_destination_,
+      s_state.is_via_,
+      s_state.dist_to_dest_,
+      q.td_dest_,
+      s_state.travel_time_lower_bound_,
+      q.via_stops_,
+      day_idx_t{std::chrono::duration_cast<date::days>(
+                    std::chrono::round<std::chrono::days>(time_at_first) -
+                    tt.internal_interval().from_)
+                    .count()},
+      q.allowed_claszes_,
+      q.require_bike_transport_,
+      q.prf_idx_ == 2U,
+      tts};
+
+  // Arrival time incl. transfer time at each remaining stop of the train.
+  auto time_at_stop = std::vector<unixtime_t>(n_stops);
+  for (auto i = first_stop_idx; i != n_stops; ++i) {
+    auto const l = stop{location_seq[i]}.location_idx();
+    time_at_stop[i] = tt.event_time(t, i, event_type::kArr) +
+                      tt.locations_.transfer_time_[l];
+  }
+
+  // Passengers at stop i can alight at every stop j >= i. Processing the stops
+  // back to front, the start set of stop i is a superset of the start set of
+  // stop i + 1. Thus, all labels stay valid and only the newly added start
+  // needs to be propagated.
+  auto results = std::vector<ontrip_train_result>(n_stops - first_stop_idx);
+  auto starts = std::vector<start>{};
+  for (auto i = n_stops; i != first_stop_idx; --i) {
+    auto const stop_idx = static_cast<stop_idx_t>(i - 1U);
+    auto const l = stop{location_seq[stop_idx]}.location_idx();
+    auto const start_time = tt.event_time(t, stop_idx, event_type::kArr);
+
+    auto q_stop = query{q};
+    q_stop.start_time_ = start_time;
+    q_stop.start_.clear();
+    for (auto j = stop_idx; j != n_stops; ++j) {
+      q_stop.start_.emplace_back(stop{location_seq[j]}.location_idx(),
+                                 time_at_stop[j] - start_time,
+                                 static_cast<std::uint8_t>(j));
+    }
+
+    starts.clear();
+    get_starts(direction::kForward, tt, rtt, start_time,
+               {offset{l, time_at_stop[stop_idx] - start_time,
+                       static_cast<std::uint8_t>(stop_idx)}},
+               {}, kMaxTravelTime, q.start_match_mode_, q.use_start_footpaths_,
+               starts, true, q.prf_idx_, tts);
+
+    algo.next_start_time();
+    for (auto const& s : starts) {
+      algo.add_start(s.stop_, s.time_at_stop_);
+    }
+
+    auto& r = results[stop_idx - first_stop_idx];
+    r.stop_idx_ = stop_idx;
+    auto const fastest_direct =
+        get_fastest_direct(tt, q_stop, direction::kForward);
+    auto const worst_time_at_dest =
+        start_time + std::min(fastest_direct, kMaxTravelTime);
+    algo.execute(start_time, q.max_transfers_, worst_time_at_dest, q.prf_idx_,
+                 r.journeys_);
+
+    // Labels reused from later stops were bounded by the fastest direct
+    // connection of those stops. Apply the bound of this stop.
+    r.journeys_.erase(
+        std::remove_if(begin(r.journeys_), end(r.journeys_),
+                       [&](journey const& j) {
+                         return j.dest_time_ > worst_time_at_dest;
+                       }),
+        end(r.journeys_));
+
+    for (auto& j : r.journeys_) {
+      if (!j.legs_.empty()) {
+        continue;
+      }
+      try {
+        algo.reconstruct(q_stop, j);
+      } catch (std::exception const& e) {
+        j.error_ = true;
+        log(log_lvl::error, "ontrip_train_search", "reconstruct failed: {}",
+            e.what());
+      }
+    }
+  }
+
+  return results;
+}
+
+template <bool Rt>
+std::vector<ontrip_train_result> ontrip_train_search_with_rt(
+    timetable const& tt,
+    rt_timetable const* rtt,
+    search_state& s_state,
+    raptor_state& r_state,
+    transport const& t,
+    stop_idx_t const first_stop_idx,
+    query& q) {
+  static_assert(kMaxVias == 2,
+                "ontrip_train_search.cc needs to be adjusted for kMaxVias");
+
+  switch (q.via_stops_.size()) {
+    case 0:
+      return ontrip_train_search_with_vias<Rt, 0>(tt, rtt, s_state, r_state, t,
+                                                  first_stop_idx, q);
+    case 1:
+      return ontrip_train_search_with_vias<Rt, 1>(tt, rtt, s_state, r_state, t,
+                                                  first_stop_idx, q);
+    case 2:
+      return ontrip_train_search_with_vias<Rt, 2>(tt, rtt, s_state, r_state, t,
+                                                  first_stop_idx, q);
+  }
+  std::unreachable();
+}
+
+}  // namespace
+
+std::vector<ontrip_train_result> ontrip_train_search(
+    timetable const& tt,
+    rt_timetable const* rtt,
+    search_state& s_state,
+    raptor_state& r_state,
+    transport const& t,
+    stop_idx_t const first_stop_idx,
+    query q) {
+  utl::verify(first_stop_idx != 0U, "first arrival time not defined");
+
+  auto const n_stops =
+      tt.route_location_seq_[tt.transport_route_.at(t.t_idx_)].size();
+  utl::verify(first_stop_idx < n_stops, "invalid stop index {} [{} stops]",
+              first_stop_idx, n_stops);
+
+  sanitize_via_stops(tt, q);
+  utl::verify(q.via_stops_.size() <= kMaxVias,
+              "too many via stops: {}, limit: {}", q.via_stops_.size(),
+              kMaxVias);
+
+  return rtt == nullptr
+             ? ontrip_train_search_with_rt<false>(tt, rtt, s_state, r_state, t,
+                                                  first_stop_idx, q)
+             : ontrip_train_search_with_rt<true>(tt, rtt, s_state, r_state, t,
+                                                 first_stop_idx, q);
+}
+
+}  // namespace nigiri::routing
@@ -20,28 +20,46 @@ namespace nigiri::routing {
 
 namespace {
 
-template <direction SearchDir, via_offset_t Vias>
-routing_result<raptor_stats> raptor_search_with_vias(
+template <direction SearchDir, bool Rt, via_offset_t Vias>
+routing_result<raptor_stats> raptor_search_with_features(
     timetable const& tt,
     rt_timetable const* rtt,
     search_state& s_state,
     raptor_state& r_state,
     query q,
     std::optional<std::chrono::seconds> const timeout) {
-
-  if (rtt == nullptr) {
-    using algo_t = raptor<SearchDir, false, Vias>;
+  // Only the two extremes are instantiated to keep the binary size in check:
+  // queries using any of the features take the generic path.
+  if (is_raptor_feature_free(q, Rt)) {
+    using algo_t = raptor<SearchDir, Rt, Vias, kNoRaptorFeatures>;
     return search<SearchDir, algo_t>{tt,      rtt,          s_state,
                                      r_state, std::move(q), timeout}
         .execute();
   } else {
-    using algo_t = raptor<SearchDir, true, Vias>;
+    using algo_t = raptor<SearchDir, Rt, Vias, kAllRaptorFeatures>;
     return search<SearchDir, algo_t>{tt,      rtt,          s_state,
                                      r_state, std::move(q), timeout}
         .execute();
   }
 }
 
+template <direction SearchDir, via_offset_t Vias>
+routing_result<raptor_stats> raptor_search_with_vias(
+    timetable const& tt,
+    rt_timetable const* rtt,
+    search_state& s_state,
+    raptor_state& r_state,
+    query q,
+    std::optional<std::chrono::seconds> const timeout) {
+  if (rtt == nullptr) {
+    return raptor_search_with_features<SearchDir, false, Vias>(
+        tt, rtt, s_state, r_state, std::move(q), timeout);
+  } else {
+    return raptor_search_with_features<SearchDir, true, Vias>(
+        tt, rtt, s_state, r_state, std::move(q), timeout);
+  }
+}
+
 template <direction SearchDir>
 routing_result<raptor_stats> raptor_search_with_dir(
     timetable const& tt,
@@ -85,6 +103,15 @@ std::string_view location_match_mode_str(location_match_mode const mode) {
 
 }  // namespace
 
+bool is_raptor_feature_free(query const& q, bool const is_rt) {
+  auto const& tts = q.transfer_time_settings_;
+  auto const default_tts =
+      tts.default_ ||
+      (tts.factor_ <= 1.0F && tts.min_transfer_time_ == 0_minutes);
+  return (!is_rt || q.prf_idx_ == 0U) && default_tts && q.prf_idx_ != 2U &&
+         q.dest_match_mode_ != location_match_mode::kIntermodal;
+}
+
 routing_result<raptor_stats> raptor_search(
     timetable const& tt,
     rt_timetable const* rtt,
@@ -151,4 +178,77 @@ routing_result<raptor_stats> raptor_search(
   }
 }
 
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 0, kNoRaptorFeatures>>;
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 0, kAllRaptorFeatures>>;
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 1, kNoRaptorFeatures>>;
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 1, kAllRaptorFeatures>>;
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 2, kNoRaptorFeatures>>;
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, false, 2, kAllRaptorFeatures>>;
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 0, kNoRaptorFeatures>>;
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 0, kAllRaptorFeatures>>;
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 1, kNoRaptorFeatures>>;
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 1, kAllRaptorFeatures>>;
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 2, kNoRaptorFeatures>>;
+template struct search<
+    direction::kForward,
+    raptor<direction::kForward, true, 2, kAllRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 0, kNoRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 0, kAllRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 1, kNoRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 1, kAllRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 2, kNoRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, false, 2, kAllRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 0, kNoRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 0, kAllRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 1, kNoRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 1, kAllRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 2, kNoRaptorFeatures>>;
+template struct search<
+    direction::kBackward,
+    raptor<direction::kBackward, true, 2, kAllRaptorFeatures>>;
+
 }  // namespace nigiri::routing
@@ -0,0 +1,186 @@
+#include "nigiri/rt/compact.h"
+
+#include <algorithm>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+#include "utl/enumerate.h"
+
+#include "nigiri/rt/rt_timetable.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::rt {
+
+namespace {
+
+template <typename T>
+std::size_t bytes(T const& v) {
+  return v.size() * sizeof(typename std::decay_t<T>::value_type);
+}
+
+template <typename K, typename V>
+std::size_t bytes(vecvec<K, V> const& v) {
+  return bytes(v.data_) + bytes(v.bucket_starts_);
+}
+
+std::size_t rt_transport_bytes(rt_timetable const& rtt) {
+  auto n = std::size_t{0U};
+  for (auto l = 0U; l != rtt.location_rt_transports_.size(); ++l) {
+    n += rtt.location_rt_transports_[location_idx_t{l}].size() *
+         sizeof(rt_transport_idx_t);
+  }
+  return n + bytes(rtt.rt_transport_static_transport_) +
+         bytes(rtt.rt_transport_src_) + bytes(rtt.rt_transport_train_nr_) +
+         bytes(rtt.rt_transport_stop_times_) +
+         bytes(rtt.rt_transport_location_seq_) +
+         bytes(rtt.rt_transport_display_names_) +
+         bytes(rtt.rt_transport_line_) +
+         bytes(rtt.rt_transport_section_clasz_) +
+         bytes(rtt.trip_id_strings_) +
+         bytes(rtt.rt_bikes_allowed_per_section_) +
+         (rtt.rt_transport_is_cancelled_.size() +
+          rtt.rt_transport_bikes_allowed_.size()) /
+             8U +
+         rtt.static_trip_lookup_.size() *
+             sizeof(pair<transport, rt_transport_idx_t>) +
+         rtt.additional_trips_lookup_.size() *
+             sizeof(pair<rt_add_trip_id_idx_t, rt_transport_idx_t>);
+}
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& out, compact_stats const& s) {
+  return out << "removed_transports=" << s.removed_transports_
+             << ", remaining_transports=" << s.remaining_transports_
+             << ", bytes_reclaimed=" << s.bytes_reclaimed_;
+}
+
+compact_stats compact(timetable const& tt,
+                      rt_timetable& rtt,
+                      unixtime_t const cutoff) {
+  auto const n_rt_transports = rtt.n_rt_transports();
+
+  // Old RT transport index -> new RT transport index (invalid = removed).
+  auto new_idx = vector_map<rt_transport_idx_t, rt_transport_idx_t>{};
+  new_idx.resize(n_rt_transports, rt_transport_idx_t::invalid());
+  auto kept = std::vector<rt_transport_idx_t>{};
+  for (auto x = 0U; x != n_rt_transports; ++x) {
+    auto const i = rt_transport_idx_t{x};
+    auto const times = rtt.rt_transport_stop_times_[i];
+    auto const is_expired =  // transports without events are expired, too
+        times.empty() ||
+        rtt.base_day_ + std::chrono::minutes{times[times.size() - 1U]} <
+            cutoff;
+    if (!is_expired) {
+      new_idx[i] = rt_transport_idx_t{kept.size()};
+      kept.emplace_back(i);
+    }
+  }
+
+  auto const n_kept = static_cast<std::uint32_t>(kept.size());
+  auto stats = compact_stats{.removed_transports_ = n_rt_transports - n_kept,
+                             .remaining_transports_ = n_kept};
+  if (n_kept == n_rt_transports) {
+    return stats;
+  }
+
+  auto const bytes_before = rt_transport_bytes(rtt);
+
+  auto const compact_vec = [&](auto& v) {
+    auto next = std::decay_t<decltype(v)>{};
+    for (auto const i : kept) {
+      next.emplace_back(v[i]);
+    }
+    v = std::move(next);
+  };
+  compact_vec(rtt.rt_transport_static_transport_);
+
+  // Trip IDs of additional trips: only the ones of kept transports remain.
+  auto new_add_idx = vector_map<rt_add_trip_id_idx_t, rt_add_trip_id_idx_t>{};
+  new_add_idx.resize(rtt.trip_id_strings_.size(),
+                     rt_add_trip_id_idx_t::invalid());
+  auto trip_id_strings = vecvec<rt_add_trip_id_idx_t, char>{};
+  for (auto& static_t : rtt.rt_transport_static_transport_) {
+    if (holds_alternative<rt_add_trip_id_idx_t>(static_t)) {
+      auto const old = static_t.as<rt_add_trip_id_idx_t>();
+      new_add_idx[old] = rt_add_trip_id_idx_t{trip_id_strings.size()};
+      trip_id_strings.emplace_back(rtt.trip_id_strings_[old]);
+      static_t = new_add_idx[old];
+    }
+  }
+  rtt.trip_id_strings_ = std::move(trip_id_strings);
+  compact_vec(rtt.rt_transport_src_);
+  compact_vec(rtt.rt_transport_train_nr_);
+  compact_vec(rtt.rt_transport_stop_times_);
+  compact_vec(rtt.rt_transport_location_seq_);
+  compact_vec(rtt.rt_transport_display_names_);
+  compact_vec(rtt.rt_transport_line_);
+  compact_vec(rtt.rt_transport_section_clasz_);
+  compact_vec(rtt.rt_bikes_allowed_per_section_);
+
+  auto is_cancelled = bitvec{};
+  auto bikes_allowed = bitvec{};
+  is_cancelled.resize(n_kept);
+  bikes_allowed.resize(n_kept * 2U);
+  for (auto const [i, old] : utl::enumerate(kept)) {
+    auto const o = to_idx(old);
+    is_cancelled.set(i, rtt.rt_transport_is_cancelled_.test(o));
+    bikes_allowed.set(i * 2U, rtt.rt_transport_bikes_allowed_.test(o * 2U));
+    bikes_allowed.set(i * 2U + 1U,
+                      rtt.rt_transport_bikes_allowed_.test(o * 2U + 1U));
+  }
+  rtt.rt_transport_is_cancelled_ = std::move(is_cancelled);
+  rtt.rt_transport_bikes_allowed_ = std::move(bikes_allowed);
+
+  auto location_rt_transports =
+      mutable_fws_multimap<location_idx_t, rt_transport_idx_t>{};
+  location_rt_transports[location_idx_t{tt.n_locations() - 1U}];
+  for (auto l = 0U; l != rtt.location_rt_transports_.size(); ++l) {
+    for (auto const old : rtt.location_rt_transports_[location_idx_t{l}]) {
+      if (new_idx[old] != rt_transport_idx_t::invalid()) {
+        location_rt_transports[location_idx_t{l}].push_back(new_idx[old]);
+      }
+    }
+  }
+  rtt.location_rt_transports_ = std::move(location_rt_transports);
+
+  auto additional_trips_lookup =
+      hash_map<rt_add_trip_id_idx_t, rt_transport_idx_t>{};
+  for (auto const [add_trip, old] : rtt.additional_trips_lookup_) {
+    if (new_idx[old] != rt_transport_idx_t::invalid()) {
+      additional_trips_lookup.emplace(new_add_idx[add_trip], new_idx[old]);
+    }
+  }
+  rtt.additional_trips_lookup_ = std::move(additional_trips_lookup);
+
+  // Detached RT copies (see rt_timetable::reset_to_static()) stay detached.
+  auto static_trip_lookup = hash_map<transport, rt_transport_idx_t>{};
+  for (auto const [t, old] : rtt.static_trip_lookup_) {
+    if (new_idx[old] != rt_transport_idx_t::invalid()) {
+      static_trip_lookup.emplace(t, new_idx[old]);
+    }
+  }
+  rtt.static_trip_lookup_ = std::move(static_trip_lookup);
+
+  // Removed transports must not be reverted by the next full dataset.
+  for (auto& updated : rtt.src_updated_transports_) {
+    auto remaining = vector<rt_transport_idx_t>{};
+    for (auto const old : updated) {
+      if (new_idx[old] != rt_transport_idx_t::invalid()) {
+        remaining.push_back(new_idx[old]);  // order is preserved
+      }
+    }
+    updated = std::move(remaining);
+  }
+
+  rtt.clear_rt_routes();
+  rtt.build_rt_routes(tt);
+
+  auto const bytes_after = rt_transport_bytes(rtt);
+  stats.bytes_reclaimed_ =
+      bytes_before > bytes_after ? bytes_before - bytes_after : 0U;
+  return stats;
+}
+
+}  // namespace nigiri::rt
@@ -83,7 +83,7 @@ location_idx_t run_stop::get_scheduled_location_idx() const noexcept {
 unixtime_t run_stop::scheduled_time(event_type const ev_type) const noexcept {
   assert(fr_->size() > stop_idx_);
   return fr_->is_scheduled()
-             ? tt().event_time(fr_->t_, stop_idx_, ev_type)
+             ? fr_->static_time(stop_idx_, ev_type)
              : rtt()->unix_event_time(fr_->rt_, stop_idx_, ev_type);
 }
 
@@ -91,7 +91,7 @@ unixtime_t run_stop::time(event_type const ev_type) const noexcept {
   assert(fr_->size() > stop_idx_);
   return (fr_->is_rt() && rtt() != nullptr)
              ? rtt()->unix_event_time(fr_->rt_, stop_idx_, ev_type)
-             : tt().event_time(fr_->t_, stop_idx_, ev_type);
+             : fr_->static_time(stop_idx_, ev_type);
 }
 
 duration_t run_stop::delay(event_type const ev_type) const noexcept {
@@ -297,6 +297,66 @@ frun::frun(timetable const& tt, rt_timetable const* rtt, run r)
       r.rt_ != rt_transport_idx_t::invalid()) {
     t_ = rtt->resolve_static(r.rt_);
   }
+  if (is_scheduled()) {
+    auto const route = tt.transport_route_[t_.t_idx_];
+    auto const transports = tt.route_transport_ranges_[route];
+    static_times_ =
+        &tt.route_stop_times_[tt.route_stop_time_ranges_[route].from_ +
+                              to_idx(t_.t_idx_) - to_idx(transports.from_)];
+    static_times_stride_ = static_cast<std::uint32_t>(transports.size());
+    static_day_start_ = unixtime_t{tt.internal_interval_days().from_ +
+                                   to_idx(t_.day_) * 1_days};
+  }
+}
+
+unixtime_t frun::static_time(stop_idx_t const stop_idx,
+                             event_type const ev_type) const noexcept {
+  assert(static_times_ != nullptr);
+  auto const ev_idx = static_cast<unsigned>(
+      stop_idx * 2 - (ev_type == event_type::kArr ? 1 : 0));
+  return static_day_start_ +
+         static_times_[ev_idx * static_times_stride_].as_duration();
+}
+
+void frun::scheduled_times(std::vector<unixtime_t>& out) const {
+  out.clear();
+  if (!is_scheduled()) {
+    auto const rt = rt_times();
+    out.reserve(rt.size());
+    for (auto const t : rt) {
+      out.emplace_back(rtt_->base_day_ + std::chrono::minutes{t});
+    }
+    return;
+  }
+
+  auto const n_events = static_cast<unsigned>(
+      2U * tt_->route_location_seq_[tt_->transport_route_[t_.t_idx_]].size() -
+      2U);
+  out.resize(n_events);
+  for (auto i = 0U; i != n_events; ++i) {
+    out[i] = static_day_start_ +
+             static_times_[i * static_times_stride_].as_duration();
+  }
+}
+
+void frun::times(std::vector<unixtime_t>& out) const {
+  if (!is_rt() || rtt_ == nullptr) {
+    scheduled_times(out);
+    return;
+  }
+
+  auto const rt = rt_times();
+  out.resize(rt.size());
+  for (auto i = 0U; i != rt.size(); ++i) {
+    out[i] = rtt_->base_day_ + std::chrono::minutes{rt[i]};
+  }
+}
+
+std::span<delta_t const> frun::rt_times() const noexcept {
+  if (!is_rt() || rtt_ == nullptr) {
+    return {};
+  }
+  return std::span<delta_t const>{rtt_->rt_transport_stop_times_[rt_]};
 }
 
 std::string_view frun::name() const noexcept {
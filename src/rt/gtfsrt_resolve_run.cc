@@ -35,13 +35,7 @@ void resolve_static(date::sys_days const today,
   using loader::gtfs::parse_date;
 
   auto const& trip_id = td.trip_id();
-  auto const lb = std::lower_bound(
-      begin(tt.trip_id_to_idx_), end(tt.trip_id_to_idx_), trip_id,
-      [&](pair<trip_id_idx_t, trip_idx_t> const& a, string const& b) {
-        return std::tuple(tt.trip_id_src_[a.first],
-                          tt.trip_id_strings_[a.first].view()) <
-               std::tuple(src, std::string_view{b});
-      });
+  auto const lb = tt.find_trip_id(src, trip_id);
 
   auto const start_date = td.has_start_date()
                               ? std::make_optional(parse_date(
@@ -113,7 +107,11 @@ std::pair<run, trip_idx_t> gtfsrt_resolve_run(
   trip_idx_t trip;
   resolve_static(today, tt, src, td, r, trip);
   if (rtt != nullptr) {
-    resolve_rt(*rtt, r);
+    if (r.is_scheduled()) {
+      resolve_rt(*rtt, r);
+    } else {
+      r.rt_ = rtt->resolve_additional(src, td.trip_id());
+    }
   }
   return {r, trip};
 }
@@ -1,6 +1,18 @@
 #include "nigiri/rt/gtfsrt_update.h"
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "utl/enumerate.h"
 #include "utl/pairwise.h"
+#include "utl/parallel_for.h"
 
 #include "nigiri/loader/gtfs/stop_seq_number_encoding.h"
 #include "nigiri/get_otel_tracer.h"
@@ -49,13 +61,30 @@ std::ostream& operator<<(std::ostream& out, statistics const& s) {
   print_if_no_empty("trip_resolve_error", s.trip_resolve_error_, true);
   print_if_no_empty("unsupported_schedule_relationship",
                     s.unsupported_schedule_relationship_, true);
+  print_if_no_empty("reverted", s.reverted_);
+  print_if_no_empty("resolve_duration_us", s.resolve_duration_.count());
+  print_if_no_empty("apply_duration_us", s.apply_duration_.count());
 
   return out;
 }
 
-struct delay_propagation {
-  unixtime_t pred_time_;
-  duration_t pred_delay_;
+// Update of one event of a run, derived from the stop time updates.
+struct event_update {
+  enum class kind : std::uint8_t {
+    kNoEvent,  // first arrival / last departure
+    kPropagate,  // no update: propagate the delay of the predecessor
+    kDelay,
+    kTime
+  };
+
+  kind kind_;
+  i32_minutes value_;  // kDelay: delay, kTime: time since epoch
+};
+
+// Scratch buffers of update_run(), reused for all entities of a message.
+struct delay_profile {
+  std::vector<event_update> updates_;
+  std::vector<unixtime_t> static_times_;
 };
 
 std::string remove_nl(std::string s) {
@@ -63,44 +92,94 @@ std::string remove_nl(std::string s) {
   return s;
 }
 
-delay_propagation update_delay(timetable const& tt,
-                               rt_timetable& rtt,
-                               run const& r,
-                               stop_idx_t const stop_idx,
-                               event_type const ev_type,
-                               duration_t const delay,
-                               std::optional<unixtime_t> const min) {
-  auto const static_time = tt.event_time(r.t_, stop_idx, ev_type);
-  rtt.update_time(r.rt_, stop_idx, ev_type,
-                  min.has_value() ? std::max(*min, static_time + delay)
-                                  : static_time + delay);
-  rtt.dispatch_event_change(r.t_, stop_idx, ev_type, delay, false);
-  return {rtt.unix_event_time(r.rt_, stop_idx, ev_type), delay};
-}
-
-delay_propagation update_event(timetable const& tt,
-                               rt_timetable& rtt,
-                               run const& r,
-                               stop_idx_t const stop_idx,
-                               event_type const ev_type,
-                               gtfsrt::TripUpdate_StopTimeEvent const& ev,
-                               std::optional<unixtime_t> const pred_time) {
+event_update to_event_update(gtfsrt::TripUpdate_StopTimeEvent const& ev) {
   if (ev.has_delay()) {
-    return update_delay(tt, rtt, r, stop_idx, ev_type,
-                        std::chrono::duration_cast<unixtime_t::duration>(
-                            std::chrono::seconds{ev.delay()}),
-                        pred_time);
+    return {event_update::kind::kDelay,
+            std::chrono::duration_cast<i32_minutes>(
+                std::chrono::seconds{ev.delay()})};
   } else /* if (ev.has_time()) */ {
-    auto const static_time = tt.event_time(r.t_, stop_idx, ev_type);
-    auto const new_time =
-        unixtime_t{std::chrono::duration_cast<unixtime_t::duration>(
-            std::chrono::seconds{ev.time()})};
-    rtt.update_time(
-        r.rt_, stop_idx, ev_type,
-        pred_time.has_value() ? std::max(*pred_time, new_time) : new_time);
-    rtt.dispatch_event_change(r.t_, stop_idx, ev_type, new_time - static_time,
-                              false);
-    return {new_time, new_time - static_time};
+    return {event_update::kind::kTime,
+            std::chrono::duration_cast<i32_minutes>(
+                std::chrono::seconds{ev.time()})};
+  }
+}
+
+// Applies the delay profile to the run in one pass over its events:
+// - static times of the run are materialized once (instead of a route
+//   lookup for each event),
+// - explicit updates are applied, events without update get the delay of
+//   their predecessor,
+// - times never decrease along the run (max with the predecessor).
+void apply_delay_profile(timetable const& tt,
+                         rt_timetable& rtt,
+                         run const& r,
+                         delay_profile& p) {
+  auto const& updates = p.updates_;
+  auto const n_events = updates.size();
+
+  // Event i of the profile is event (2 * from + i - 1) of the transport:
+  // arrival at from (never updated), departure at from, arrival at from+1,
+  // ...
+  auto const first_ev_idx = 2U * r.stop_range_.from_;
+
+  auto& static_times = p.static_times_;
+  static_times.resize(n_events);
+  {
+    auto const route = tt.transport_route_[r.t_.t_idx_];
+    auto const transports = tt.route_transport_ranges_[route];
+    auto const n_transports = static_cast<unsigned>(transports.size());
+    auto const t_offset = static_cast<unsigned>(
+        tt.route_stop_time_ranges_[route].from_ +
+        (to_idx(r.t_.t_idx_) - to_idx(transports.from_)));
+    auto const day_start = unixtime_t{tt.internal_interval_days().from_ +
+                                      to_idx(r.t_.day_) * 1_days};
+    auto const* route_stop_times = &tt.route_stop_times_[0];
+    for (auto i = 0U; i != n_events; ++i) {
+      if (updates[i].kind_ != event_update::kind::kNoEvent) {
+        auto const ev_idx = first_ev_idx + i - 1U;
+        static_times[i] =
+            day_start +
+            route_stop_times[t_offset + n_transports * ev_idx].as_duration();
+      }
+    }
+  }
+
+  rtt.set_rt_transport_changed(r.rt_);
+  auto const rt_times = rtt.rt_transport_stop_times_[r.rt_];
+  auto has_pred = r.stop_range_.from_ > 0U;
+  auto pred_time = has_pred ? rtt.unix_event_time(r.rt_, r.stop_range_.from_,
+                                                  event_type::kArr)
+                            : unixtime_t{0_minutes};
+  auto pred_delay = duration_t{0_minutes};
+  for (auto i = 0U; i != n_events; ++i) {
+    auto const& upd = updates[i];
+    if (upd.kind_ == event_update::kind::kNoEvent ||
+        (upd.kind_ == event_update::kind::kPropagate && !has_pred)) {
+      continue;
+    }
+
+    auto const ev_idx = first_ev_idx + i - 1U;
+    auto const static_time = static_times[i];
+    auto delay = pred_delay;
+    if (upd.kind_ == event_update::kind::kTime) {
+      auto const new_time = unixtime_t{upd.value_};
+      delay = new_time - static_time;
+      rt_times[ev_idx] = rtt.unix_to_delta(std::max(pred_time, new_time));
+      pred_time = new_time;
+    } else {
+      if (upd.kind_ == event_update::kind::kDelay) {
+        delay = duration_t{upd.value_};
+      }
+      rt_times[ev_idx] =
+          rtt.unix_to_delta(std::max(pred_time, static_time + delay));
+      pred_time = rtt.base_day_ + std::chrono::minutes{rt_times[ev_idx]};
+    }
+    pred_delay = delay;
+    has_pred = true;
+
+    rtt.dispatch_event_change(
+        r.t_, static_cast<stop_idx_t>((ev_idx + 1U) / 2U),
+        ev_idx % 2U == 0U ? event_type::kDep : event_type::kArr, delay, false);
   }
 }
 
@@ -109,10 +188,32 @@ void cancel_run(timetable const&, rt_timetable& rtt, run& r) {
     rtt.rt_transport_is_cancelled_.set(to_idx(r.rt_), true);
   }
   if (r.is_scheduled()) {
-    auto const bf = rtt.bitfields_[rtt.transport_traffic_days_[r.t_.t_idx_]];
-    rtt.bitfields_.emplace_back(bf).set(to_idx(r.t_.day_), false);
-    rtt.transport_traffic_days_[r.t_.t_idx_] =
-        bitfield_idx_t{rtt.bitfields_.size() - 1U};
+    rtt.deactivate_static_transport(r.t_);
+  }
+}
+
+void revert_run(timetable const& tt, rt_timetable& rtt, run const& r) {
+  if (r.is_rt()) {
+    rtt.reset_to_static(tt, r.rt_);
+  } else {
+    rtt.reactivate_static_transport(tt, r.t_);  // cancelled without RT copy
+  }
+  if (!r.is_scheduled()) {
+    return;  // additional trip
+  }
+
+  auto const t = r.t_;
+  auto const n_stops = static_cast<stop_idx_t>(
+      tt.route_location_seq_[tt.transport_route_[t.t_idx_]].size());
+  for (auto stop_idx = stop_idx_t{0U}; stop_idx != n_stops; ++stop_idx) {
+    if (stop_idx != 0U) {
+      rtt.dispatch_event_change(t, stop_idx, event_type::kArr, 0_minutes,
+                                false);
+    }
+    if (stop_idx != n_stops - 1U) {
+      rtt.dispatch_event_change(t, stop_idx, event_type::kDep, 0_minutes,
+                                false);
+    }
   }
 }
 
@@ -122,7 +223,8 @@ void update_run(
     rt_timetable& rtt,
     trip_idx_t const trip,
     run& r,
-    protob::RepeatedPtrField<gtfsrt::TripUpdate_StopTimeUpdate> const& stops) {
+    protob::RepeatedPtrField<gtfsrt::TripUpdate_StopTimeUpdate> const& stops,
+    delay_profile& profile) {
   using std::begin;
   using std::end;
 
@@ -138,12 +240,18 @@ void update_run(
       {tt.trip_stop_seq_numbers_[trip]},
       static_cast<stop_idx_t>(r.stop_range_.size())};
 
-  auto pred = r.stop_range_.from_ > 0U
-                  ? std::make_optional<delay_propagation>(delay_propagation{
-                        .pred_time_ = rtt.unix_event_time(
-                            r.rt_, r.stop_range_.from_, event_type::kArr),
-                        .pred_delay_ = 0_minutes})
-                  : std::nullopt;
+  // Two events per stop: arrival, departure.
+  auto& updates = profile.updates_;
+  updates.assign(2U * r.stop_range_.size(),
+                 {event_update::kind::kPropagate, i32_minutes{0}});
+  auto const arr = [&](stop_idx_t const stop_idx) -> event_update& {
+    return updates[2U * static_cast<unsigned>(stop_idx - r.stop_range_.from_)];
+  };
+  auto const dep = [&](stop_idx_t const stop_idx) -> event_update& {
+    return updates[2U * static_cast<unsigned>(stop_idx - r.stop_range_.from_) +
+                   1U];
+  };
+
   auto stop_idx = r.stop_range_.from_;
   auto seq_it = begin(seq_numbers);
   auto upd_it = begin(stops);
@@ -195,20 +303,16 @@ void update_run(
       }
     }
 
-    // Update arrival, propagate delay.
-    if (stop_idx != r.stop_range_.from_) {
-      if (matches && upd_it->has_arrival() &&
-          (upd_it->arrival().has_delay() || upd_it->arrival().has_time())) {
-        pred = update_event(
-            tt, rtt, r, stop_idx, event_type::kArr, upd_it->arrival(),
-            pred.has_value() ? pred->pred_time_ : unixtime_t{0_minutes});
-      } else if (pred.has_value()) {
-        pred = update_delay(tt, rtt, r, stop_idx, event_type::kArr,
-                            pred->pred_delay_, pred->pred_time_);
-      }
+    // Collect arrival update (the first arrival is not part of the run).
+    if (stop_idx == r.stop_range_.from_) {
+      arr(stop_idx).kind_ = event_update::kind::kNoEvent;
+    } else if (matches && upd_it->has_arrival() &&
+               (upd_it->arrival().has_delay() ||
+                upd_it->arrival().has_time())) {
+      arr(stop_idx) = to_event_update(upd_it->arrival());
     }
 
-    // Update departure, propagate delay.
+    // Collect departure update.
     if (stop_idx == 0U && matches && upd_it->has_arrival() &&
         !upd_it->has_departure() &&
         (upd_it->arrival().has_delay() || upd_it->arrival().has_time())) {
@@ -216,18 +320,13 @@ void update_run(
       // with arrival info (assuming they have the same static timetable,
       // because we don't store the static first arrival) to enable delay
       // propagation.
-      pred = update_event(tt, rtt, r, stop_idx, event_type::kDep,
-                          upd_it->arrival(), unixtime_t{0_minutes});
-    } else if (stop_idx != location_seq.size() - 1U) {
-      if (matches && upd_it->has_departure() &&
-          (upd_it->departure().has_time() || upd_it->departure().has_delay())) {
-        pred = update_event(
-            tt, rtt, r, stop_idx, event_type::kDep, upd_it->departure(),
-            pred.has_value() ? pred->pred_time_ : unixtime_t{0_minutes});
-      } else if (pred.has_value()) {
-        pred = update_delay(tt, rtt, r, stop_idx, event_type::kDep,
-                            pred->pred_delay_, pred->pred_time_);
-      }
+      dep(stop_idx) = to_event_update(upd_it->arrival());
+    } else if (stop_idx == location_seq.size() - 1U) {
+      dep(stop_idx).kind_ = event_update::kind::kNoEvent;
+    } else if (matches && upd_it->has_departure() &&
+               (upd_it->departure().has_time() ||
+                upd_it->departure().has_delay())) {
+      dep(stop_idx) = to_event_update(upd_it->departure());
     }
 
     if (matches) {
@@ -235,6 +334,8 @@ void update_run(
     }
   }
 
+  apply_delay_profile(tt, rtt, r, profile);
+
   auto const n_not_cancelled_stops = utl::count_if(
       rtt.rt_transport_location_seq_[r.rt_],
       [](stop::value_type const s) { return !stop{s}.is_cancelled(); });
@@ -262,17 +363,32 @@ statistics gtfsrt_update_msg(timetable const& tt,
       std::chrono::time_point_cast<date::sys_days::duration>(message_time);
   auto stats = statistics{.total_entities_ = msg.entity_size(),
                           .feed_timestamp_ = message_time};
+  auto const is_differential =
+      msg.header().incrementality() ==
+      gtfsrt::FeedHeader_Incrementality_DIFFERENTIAL;
 
   span->SetAttribute("nigiri.gtfsrt.header.timestamp",
                      msg.header().timestamp());
   span->SetAttribute("nigiri.gtfsrt.total_entities", msg.entity_size());
 
-  for (auto const& entity : msg.entity()) {
-    if (entity.has_is_deleted() && entity.is_deleted()) {
+  // Phase 1 (sequential, cheap): filter unsupported entities.
+  auto to_resolve = std::vector<int>{};
+  to_resolve.reserve(static_cast<std::size_t>(msg.entity_size()));
+  for (auto i = 0; i != msg.entity_size(); ++i) {
+    auto const& entity = msg.entity(i);
+    auto const is_deleted = entity.has_is_deleted() && entity.is_deleted();
+    if (is_deleted && (!is_differential || !entity.has_trip_update() ||
+                       !entity.trip_update().has_trip() ||
+                       !entity.trip_update().trip().has_trip_id())) {
+      // Deletions are only supported for differential messages that still
+      // contain the trip descriptor of the deleted entity.
       log(log_lvl::error, "rt.gtfs.unsupported",
           "unsupported deleted (tag={}, id={})", tag, entity.id());
       ++stats.unsupported_deleted_;
       continue;
+    } else if (is_deleted) {
+      to_resolve.emplace_back(i);
+      continue;
     } else if (entity.has_alert()) {
       log(log_lvl::error, "rt.gtfs.unsupported",
           "unsupported alert (tag={}, id={})", tag, entity.id());
@@ -302,7 +418,9 @@ statistics gtfsrt_update_msg(timetable const& tt,
     } else if (entity.trip_update().trip().schedule_relationship() !=
                    gtfsrt::TripDescriptor_ScheduleRelationship_SCHEDULED &&
                entity.trip_update().trip().schedule_relationship() !=
-                   gtfsrt::TripDescriptor_ScheduleRelationship_CANCELED) {
+                   gtfsrt::TripDescriptor_ScheduleRelationship_CANCELED &&
+               entity.trip_update().trip().schedule_relationship() !=
+                   gtfsrt::TripDescriptor_ScheduleRelationship_ADDED) {
       log(log_lvl::error, "rt.gtfs.unsupported",
           "unsupported schedule relationship {} (tag={}, id={})",
           TripDescriptor_ScheduleRelationship_Name(
@@ -311,11 +429,46 @@ statistics gtfsrt_update_msg(timetable const& tt,
       ++stats.unsupported_schedule_relationship_;
       continue;
     }
+    to_resolve.emplace_back(i);
+  }
 
+  // Phase 2 (parallel): resolve trips. Read-only on tt and rtt.
+  struct resolved {
+    run r_;
+    trip_idx_t trip_;
+    std::optional<std::string> error_;
+  };
+  auto const resolve_start = std::chrono::steady_clock::now();
+  auto resolved_entities = std::vector<resolved>(to_resolve.size());
+  utl::parallel_for_run(to_resolve.size(), [&](std::size_t const i) {
+    auto& res = resolved_entities[i];
     try {
-      auto const td = entity.trip_update().trip();
-      auto [r, trip] = gtfsrt_resolve_run(today, tt, &rtt, src, td);
+      std::tie(res.r_, res.trip_) = gtfsrt_resolve_run(
+          today, tt, &rtt, src, msg.entity(to_resolve[i]).trip_update().trip());
+    } catch (std::exception const& e) {
+      res.error_ = e.what();
+    }
+  });
+  stats.resolve_duration_ =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - resolve_start);
+
+  // Phase 3 (sequential): apply updates in feed order.
+  auto const apply_start = std::chrono::steady_clock::now();
+  auto updated = std::vector<rt_transport_idx_t>{};
+  auto deleted = std::vector<rt_transport_idx_t>{};
+  auto cancelled = std::vector<transport>{};  // without RT transport
+  auto deleted_static = std::vector<transport>{};
+  auto profile = delay_profile{};
+  for (auto const [i, entity_idx] : utl::enumerate(to_resolve)) {
+    auto const& entity = msg.entity(entity_idx);
+    auto& [r, trip, resolve_error] = resolved_entities[i];
+    try {
+      if (resolve_error.has_value()) {
+        throw std::runtime_error{*resolve_error};
+      }
 
+      auto const td = entity.trip_update().trip();
       if (!r.valid()) {
         log(log_lvl::error, "rt.gtfs.resolve", "could not resolve (tag={}) {}",
             tag, remove_nl(td.DebugString()));
@@ -339,12 +492,38 @@ statistics gtfsrt_update_msg(timetable const& tt,
         continue;
       }
 
-      if (entity.trip_update().trip().schedule_relationship() ==
-          gtfsrt::TripDescriptor_ScheduleRelationship_CANCELED) {
-        cancel_run(tt, rtt, r);
+      // An earlier entity of this message may have created the RT transport.
+      if (r.is_scheduled() && !r.is_rt()) {
+        r.rt_ = rtt.resolve_rt(r.t_);
+      }
+
+      if (entity.has_is_deleted() && entity.is_deleted()) {
+        revert_run(tt, rtt, r);
+        if (r.is_rt()) {
+          deleted.emplace_back(r.rt_);
+        }
+        if (r.is_scheduled()) {
+          deleted_static.emplace_back(r.t_);
+        }
+        ++stats.reverted_;
       } else {
-        update_run(src, tt, rtt, trip, r,
-                   entity.trip_update().stop_time_update());
+        if (entity.trip_update().trip().schedule_relationship() ==
+            gtfsrt::TripDescriptor_ScheduleRelationship_CANCELED) {
+          cancel_run(tt, rtt, r);
+        } else if (!r.is_scheduled()) {
+          // Additional trip already known to the RT timetable (they are not
+          // created from GTFS-RT): still part of the feed, times are kept.
+          rtt.rt_transport_is_cancelled_.set(to_idx(r.rt_), false);
+        } else {
+          update_run(src, tt, rtt, trip, r,
+                     entity.trip_update().stop_time_update(), profile);
+        }
+
+        if (r.is_rt()) {
+          updated.emplace_back(r.rt_);
+        } else {
+          cancelled.emplace_back(r.t_);
+        }
       }
       ++stats.total_entities_success_;
     } catch (const std::exception& e) {
@@ -360,6 +539,56 @@ statistics gtfsrt_update_msg(timetable const& tt,
     }
   }
 
+  // Revert transports from earlier messages that are not part of this full
+  // dataset. Differential messages extend the set of updated transports.
+  auto const next = [&](auto& prev, auto& curr, auto& del, auto&& revert) {
+    using T = typename std::decay_t<decltype(curr)>::value_type;
+    if (prev.size() <= to_idx(src)) {
+      prev.resize(to_idx(src) + 1U);
+    }
+    std::sort(begin(curr), end(curr));
+    curr.erase(std::unique(begin(curr), end(curr)), end(curr));
+    std::sort(begin(del), end(del));
+
+    auto& prev_src = prev[src];
+    auto next_src = std::vector<T>{};
+    if (is_differential) {
+      std::set_union(begin(prev_src), end(prev_src), begin(curr), end(curr),
+                     std::back_inserter(next_src));
+      std::erase_if(next_src, [&](T const x) {
+        return std::binary_search(begin(del), end(del), x);
+      });
+    } else {
+      std::set_difference(begin(prev_src), end(prev_src), begin(curr),
+                          end(curr), std::back_inserter(next_src));
+      for (auto const x : next_src) {
+        revert(x);
+      }
+      next_src = std::move(curr);
+    }
+    prev_src.clear();
+    for (auto const x : next_src) {
+      prev_src.push_back(x);
+    }
+  };
+  next(rtt.src_updated_transports_, updated, deleted,
+       [&](rt_transport_idx_t const rt_t) {
+         revert_run(tt, rtt, {.t_ = rtt.resolve_static(rt_t), .rt_ = rt_t});
+         ++stats.reverted_;
+       });
+  next(rtt.src_cancelled_transports_, cancelled, deleted_static,
+       [&](transport const t) {
+         if (rtt.resolve_rt(t) == rt_transport_idx_t::invalid()) {
+           // Otherwise, the RT transport created since is tracked instead.
+           revert_run(tt, rtt, {.t_ = t});
+           ++stats.reverted_;
+         }
+       });
+
+  rtt.build_rt_routes(tt);
+  stats.apply_duration_ = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - apply_start);
+
   return stats;
 }
 
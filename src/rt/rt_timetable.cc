@@ -1,23 +1,256 @@
 #include "nigiri/rt/rt_timetable.h"
 
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <numeric>
+
+#include "cista/io.h"
+
+#include "utl/equal_ranges_linear.h"
+#include "utl/erase_duplicates.h"
+#include "utl/get_or_create.h"
+#include "utl/helpers/algorithm.h"
+#include "utl/verify.h"
+
+#include "nigiri/common/it_range.h"
+
 namespace nigiri {
 
+void rt_timetable::deactivate_static_transport(transport const t) {
+  auto const [t_idx, day] = t;
+  auto const& bf = bitfields_[transport_traffic_days_[t_idx]];
+  if (!bf.test(to_idx(day))) {
+    return;
+  }
+
+  auto updated = bf;
+  updated.set(to_idx(day), false);
+  transport_traffic_days_[t_idx] =
+      utl::get_or_create(bitfield_indices_, updated, [&]() {
+        auto const idx = bitfield_idx_t{bitfields_.size()};
+        bitfields_.emplace_back(updated);
+        return idx;
+      });
+}
+
+void rt_timetable::reactivate_static_transport(timetable const& tt,
+                                               transport const t) {
+  auto const [t_idx, day] = t;
+  auto const& bf = bitfields_[transport_traffic_days_[t_idx]];
+  if (bf.test(to_idx(day)) ||
+      !tt.bitfields_[tt.transport_traffic_days_[t_idx]].test(to_idx(day))) {
+    return;
+  }
+
+  auto updated = bf;
+  updated.set(to_idx(day), true);
+  transport_traffic_days_[t_idx] =
+      utl::get_or_create(bitfield_indices_, updated, [&]() {
+        auto const idx = bitfield_idx_t{bitfields_.size()};
+        bitfields_.emplace_back(updated);
+        return idx;
+      });
+}
+
+void rt_timetable::reset_to_static(timetable const& tt,
+                                   rt_transport_idx_t const rt_t) {
+  auto const static_t = rt_transport_static_transport_[rt_t];
+  auto rt_location_seq = rt_transport_location_seq_[rt_t];
+  auto const remove_location = [&](stop::value_type const s) {
+    auto bucket = location_rt_transports_[stop{s}.location_idx()];
+    bucket.erase(std::remove(bucket.begin(), bucket.end(), rt_t),
+                 bucket.end());
+  };
+
+  set_rt_transport_changed(rt_t);
+  if (!holds_alternative<transport>(static_t)) {
+    // Additional trip: there is no static schedule to go back to. The RT
+    // transport is detached like a rerouted copy.
+    rt_transport_is_cancelled_.set(to_idx(rt_t), true);
+    additional_trips_lookup_.erase(static_t.as<rt_add_trip_id_idx_t>());
+    for (auto const s : rt_location_seq) {
+      remove_location(s);
+    }
+    return;
+  }
+
+  auto const t = static_t.as<transport>();
+  auto const location_seq =
+      tt.route_location_seq_[tt.transport_route_[t.t_idx_]];
+  if (rt_location_seq.size() != location_seq.size()) {
+    // Rerouted: the static transport has to be used instead. The RT copy is
+    // detached (unreachable via the lookup, the location index and RT
+    // routes), so a later update of t creates a new RT transport.
+    rt_transport_is_cancelled_.set(to_idx(rt_t), true);
+    for (auto const s : rt_location_seq) {
+      remove_location(s);
+    }
+    if (resolve_rt(t) == rt_t) {  // not replaced by a newer RT copy
+      static_trip_lookup_.erase(t);
+      reactivate_static_transport(tt, t);
+    }
+    return;
+  }
+
+  // Location index: drop stops that are not part of the static sequence.
+  auto const to_location = [](stop::value_type const s) {
+    return stop{s}.location_idx();
+  };
+  for (auto const s : rt_location_seq) {
+    if (std::none_of(begin(location_seq), end(location_seq),
+                     [&](stop::value_type const x) {
+                       return to_location(x) == to_location(s);
+                     })) {
+      remove_location(s);
+    }
+  }
+  for (auto const s : location_seq) {
+    auto bucket = location_rt_transports_[to_location(s)];
+    if (utl::find(bucket, rt_t) == end(bucket)) {
+      bucket.push_back(rt_t);
+    }
+  }
+
+  rt_transport_is_cancelled_.set(to_idx(rt_t), false);
+  std::copy(begin(location_seq), end(location_seq), begin(rt_location_seq));
+
+  auto times = rt_transport_stop_times_[rt_t];
+  for (auto i = 0U; i != times.size(); ++i) {
+    auto const stop_idx = static_cast<stop_idx_t>((i + 1U) / 2U);
+    auto const ev_type = (i % 2U) == 0U ? event_type::kDep : event_type::kArr;
+    times[i] = unix_to_delta(tt.event_time(t, stop_idx, ev_type));
+  }
+}
+
+namespace {
+
+using td_footpaths_t = mutable_fws_multimap<location_idx_t, td_footpath>;
+
+void add_td_footpath(td_footpaths_t& fps,
+                     location_idx_t const l,
+                     td_footpath const& fp) {
+  auto bucket = fps[l];
+  bucket.push_back(fp);
+  std::sort(bucket.begin(), bucket.end());
+}
+
+void remove_td_footpaths(td_footpaths_t& fps,
+                         location_idx_t const l,
+                         location_idx_t const target) {
+  auto bucket = fps[l];
+  bucket.erase(std::remove_if(bucket.begin(), bucket.end(),
+                              [&](td_footpath const& fp) {
+                                return fp.target_ == target;
+                              }),
+               bucket.end());
+}
+
+}  // namespace
+
+void rt_timetable::set_td_footpaths_out(
+    timetable const& tt,
+    profile_idx_t const prf_idx,
+    location_idx_t const l,
+    std::span<td_footpath const> footpaths) {
+  auto& has_out = has_td_footpaths_out_[prf_idx];
+  auto& has_in = has_td_footpaths_in_[prf_idx];
+  auto& out = td_footpaths_out_[prf_idx];
+  auto& in = td_footpaths_in_[prf_idx];
+  utl::verify(has_out.size() == tt.n_locations(),
+              "no footpaths for profile {}", prf_idx);
+
+  // Switches the incoming footpaths of l to td footpaths: copy of the static
+  // footpaths except those from locations with td footpaths.
+  auto const init_in = [&](location_idx_t const target) {
+    if (has_in.test(target)) {
+      return;
+    }
+    has_in.set(target, true);
+    auto bucket = in[target];
+    bucket.clear();
+    for (auto const& fp : tt.locations_.footpaths_in_[prf_idx][target]) {
+      if (!has_out.test(fp.target())) {
+        bucket.push_back(td_footpath{fp.target(), kNull, fp.duration()});
+      }
+    }
+    std::sort(bucket.begin(), bucket.end());
+  };
+
+  // Remove the previous footpaths of l from the incoming footpaths.
+  auto const was_td = has_out.test(l);
+  has_out.set(l, true);
+  auto const unlink = [&](location_idx_t const target) {
+    if (has_in.test(target)) {
+      remove_td_footpaths(in, target, l);
+    } else {
+      init_in(target);  // skips l
+    }
+  };
+  if (was_td) {
+    for (auto const& fp : out[l]) {
+      unlink(fp.target_);
+    }
+  } else {
+    for (auto const& fp : tt.locations_.footpaths_out_[prf_idx][l]) {
+      unlink(fp.target());
+    }
+  }
+
+  auto bucket = out[l];
+  bucket.clear();
+  for (auto const& fp : footpaths) {
+    bucket.push_back(fp);
+  }
+  std::sort(bucket.begin(), bucket.end());
+
+  for (auto const& fp : footpaths) {
+    init_in(fp.target_);
+    add_td_footpath(in, fp.target_,
+                    td_footpath{l, fp.valid_from_, fp.duration_});
+  }
+}
+
+void rt_timetable::reset_td_footpaths_out(timetable const& tt,
+                                          profile_idx_t const prf_idx,
+                                          location_idx_t const l) {
+  auto& has_out = has_td_footpaths_out_[prf_idx];
+  auto& has_in = has_td_footpaths_in_[prf_idx];
+  auto& out = td_footpaths_out_[prf_idx];
+  auto& in = td_footpaths_in_[prf_idx];
+  if (has_out.size() != tt.n_locations() || !has_out.test(l)) {
+    return;
+  }
+
+  for (auto const& fp : out[l]) {
+    remove_td_footpaths(in, fp.target_, l);
+  }
+  out[l].clear();
+  has_out.set(l, false);
+
+  for (auto const& fp : tt.locations_.footpaths_out_[prf_idx][l]) {
+    if (has_in.test(fp.target())) {
+      add_td_footpath(in, fp.target(),
+                      td_footpath{l, kNull, fp.duration()});
+    }
+  }
+}
+
 rt_transport_idx_t rt_timetable::add_rt_transport(
     source_idx_t const src,
     timetable const& tt,
     transport const t,
     std::span<stop::value_type> const& stop_seq,
     std::span<delta_t> const& time_seq) {
-  auto const [t_idx, day] = t;
+  auto const t_idx = t.t_idx_;
 
   auto const rt_t_idx = rt_transport_src_.size();
   auto const rt_t = rt_transport_idx_t{rt_t_idx};
+  set_rt_transport_changed(rt_t);
   static_trip_lookup_.emplace(t, rt_t_idx);
   rt_transport_static_transport_.emplace_back(t);
 
-  auto const static_bf = bitfields_[transport_traffic_days_[t_idx]];
-  bitfields_.emplace_back(static_bf).set(to_idx(day), false);
-  transport_traffic_days_[t_idx] = bitfield_idx_t{bitfields_.size() - 1U};
+  deactivate_static_transport(t);
 
   auto const r = tt.transport_route_[t_idx];
   auto const location_seq =
@@ -76,4 +309,249 @@ rt_transport_idx_t rt_timetable::add_rt_transport(
   return rt_transport_idx_t{rt_t_idx};
 }
 
+rt_transport_idx_t rt_timetable::add_additional_rt_transport(
+    source_idx_t const src,
+    std::string_view trip_id,
+    std::span<stop::value_type const> stop_seq,
+    std::span<delta_t const> time_seq,
+    clasz const c) {
+  utl::verify(stop_seq.size() >= 2U &&
+                  time_seq.size() == stop_seq.size() * 2U - 2U,
+              "additional trip {}: {} stops, {} event times", trip_id,
+              stop_seq.size(), time_seq.size());
+
+  auto const rt_t = rt_transport_idx_t{rt_transport_src_.size()};
+  auto const add_idx = rt_add_trip_id_idx_t{trip_id_strings_.size()};
+  set_rt_transport_changed(rt_t);
+  trip_id_strings_.emplace_back(trip_id);
+  additional_trips_lookup_.emplace(add_idx, rt_t);
+  rt_transport_static_transport_.emplace_back(add_idx);
+
+  rt_transport_location_seq_.emplace_back(stop_seq);
+  rt_transport_src_.emplace_back(src);
+  rt_transport_train_nr_.emplace_back(0U);
+  for (auto const s : stop_seq) {
+    auto rt_transports = location_rt_transports_[stop{s}.location_idx()];
+    if (rt_transports.empty() || rt_transports.back() != rt_t) {
+      rt_transports.push_back(rt_t);
+    }
+  }
+  rt_transport_stop_times_.emplace_back(time_seq);
+
+  rt_transport_display_names_.add_back_sized(0U);
+  rt_transport_section_clasz_.emplace_back(std::array{c});
+  rt_transport_line_.add_back_sized(0U);
+  rt_transport_is_cancelled_.resize(rt_transport_is_cancelled_.size() + 1U);
+  rt_transport_bikes_allowed_.resize(rt_transport_bikes_allowed_.size() + 2U);
+  rt_bikes_allowed_per_section_.add_back_sized(0U);
+
+  return rt_t;
+}
+
+rt_transport_idx_t rt_timetable::resolve_additional(
+    source_idx_t const src, std::string_view trip_id) const {
+  for (auto const [add_idx, rt_t] : additional_trips_lookup_) {
+    if (rt_transport_src_[rt_t] == src &&
+        trip_id_strings_[add_idx].view() == trip_id) {
+      return rt_t;
+    }
+  }
+  return rt_transport_idx_t::invalid();
+}
+
+void rt_timetable::build_rt_routes(timetable const& tt) {
+  if (!rt_routes_outdated_) {
+    return;
+  }
+
+  auto const cmp_range = [](auto&& a, auto&& b) {
+    return std::lexicographical_compare_three_way(begin(a), end(a), begin(b),
+                                                  end(b));
+  };
+  auto const bikes_allowed = [&](rt_transport_idx_t const t) {
+    return std::pair{rt_transport_bikes_allowed_.test(to_idx(t) * 2),
+                     rt_transport_bikes_allowed_.test(to_idx(t) * 2 + 1)};
+  };
+  auto const cmp_pattern = [&](rt_transport_idx_t const a,
+                               rt_transport_idx_t const b) {
+    if (auto const c = cmp_range(rt_transport_location_seq_[a],
+                                 rt_transport_location_seq_[b]);
+        c != 0) {
+      return c;
+    }
+    if (auto const c = cmp_range(rt_transport_section_clasz_[a],
+                                 rt_transport_section_clasz_[b]);
+        c != 0) {
+      return c;
+    }
+    if (auto const c = bikes_allowed(a) <=> bikes_allowed(b); c != 0) {
+      return c;
+    }
+    return cmp_range(rt_bikes_allowed_per_section_[a],
+                     rt_bikes_allowed_per_section_[b]);
+  };
+
+  // Within a pattern, a transport joins the first RT route it does not
+  // overtake (or get overtaken by) at any event.
+  auto const overtakes = [&](rt_transport_idx_t const a,
+                             rt_transport_idx_t const b) {
+    auto const a_times = rt_transport_stop_times_[a];
+    auto const b_times = rt_transport_stop_times_[b];
+    for (auto i = 0U; i != a_times.size(); ++i) {
+      if (a_times[i] < b_times[i]) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // RT copies of reverted reroutes and reverted additional trips (see
+  // reset_to_static()).
+  auto const is_detached = [&](rt_transport_idx_t const t) {
+    auto const static_t = rt_transport_static_transport_[t];
+    if (holds_alternative<transport>(static_t)) {
+      return resolve_rt(static_t.as<transport>()) != t;
+    }
+    auto const it =
+        additional_trips_lookup_.find(static_t.as<rt_add_trip_id_idx_t>());
+    return it == end(additional_trips_lookup_) || it->second != t;
+  };
+
+  auto routes = std::vector<std::vector<rt_transport_idx_t>>{};
+  auto const add_routes = [&](std::vector<rt_transport_idx_t>& transports) {
+    std::erase_if(transports, is_detached);
+    // Sort by pattern, then by departure at the first stop.
+    std::sort(begin(transports), end(transports),
+              [&](rt_transport_idx_t const a, rt_transport_idx_t const b) {
+                auto const c = cmp_pattern(a, b);
+                return c != 0 ? c < 0
+                              : rt_transport_stop_times_[a].front() <
+                                    rt_transport_stop_times_[b].front();
+              });
+
+    utl::equal_ranges_linear(
+        transports,
+        [&](rt_transport_idx_t const a, rt_transport_idx_t const b) {
+          return cmp_pattern(a, b) == 0;
+        },
+        [&](auto const from_it, auto const to_it) {
+          routes.clear();
+          for (auto const t : it_range{from_it, to_it}) {
+            auto const it = std::find_if(begin(routes), end(routes),
+                                         [&](auto const& r) {
+                                           return !overtakes(t, r.back());
+                                         });
+            if (it == end(routes)) {
+              routes.push_back({t});
+            } else {
+              it->push_back(t);
+            }
+          }
+
+          for (auto const& r : routes) {
+            auto const r_idx = rt_route_idx_t{rt_route_transports_.size()};
+            rt_route_transports_.emplace_back(r);
+            for (auto const t : r) {
+              rt_transport_route_[t] = r_idx;
+            }
+
+            auto const n_events = rt_transport_stop_times_[r.front()].size();
+            auto times =
+                rt_route_stop_times_.add_back_sized(n_events * r.size());
+            for (auto ev = 0U; ev != n_events; ++ev) {
+              for (auto i = 0U; i != r.size(); ++i) {
+                times[ev * r.size() + i] = rt_transport_stop_times_[r[i]][ev];
+              }
+            }
+
+            auto const location_seq = rt_transport_location_seq_[r.front()];
+            rt_route_location_seq_.emplace_back(location_seq);
+            for (auto const s : location_seq) {
+              auto bucket = location_rt_routes_[stop{s}.location_idx()];
+              if (utl::find(bucket, r_idx) == end(bucket)) {
+                bucket.push_back(r_idx);
+              }
+            }
+          }
+        });
+  };
+
+  auto transports = std::vector<rt_transport_idx_t>{};
+  rt_transport_route_.resize(n_rt_transports(), rt_route_idx_t::invalid());
+  if (location_rt_routes_.size() != tt.n_locations() ||
+      2U * n_removed_rt_routes_ > n_rt_routes()) {
+    // Full rebuild: no RT routes yet or too many replaced RT routes.
+    clear_rt_routes();
+    location_rt_routes_[location_idx_t{tt.n_locations() - 1U}];
+    rt_transport_route_.resize(n_rt_transports(), rt_route_idx_t::invalid());
+    transports.resize(n_rt_transports());
+    std::iota(begin(transports), end(transports), rt_transport_idx_t{0U});
+  } else {
+    // Replace the RT routes of the changed transports and all RT routes
+    // sharing the (new) pattern of a changed transport.
+    auto replaced = std::vector<rt_route_idx_t>{};
+    for (auto const t : rt_routes_changed_) {
+      transports.push_back(t);
+      if (rt_transport_route_[t] != rt_route_idx_t::invalid()) {
+        replaced.push_back(rt_transport_route_[t]);
+      }
+      auto const first =
+          stop{rt_transport_location_seq_[t].front()}.location_idx();
+      for (auto const r : location_rt_routes_[first]) {
+        if (cmp_pattern(rt_route_transports_[r].front(), t) == 0) {
+          replaced.push_back(r);
+        }
+      }
+    }
+    utl::erase_duplicates(replaced);
+
+    for (auto const r : replaced) {
+      for (auto const t : rt_route_transports_[r]) {
+        transports.push_back(t);
+      }
+      for (auto const s : rt_route_location_seq_[r]) {
+        auto bucket = location_rt_routes_[stop{s}.location_idx()];
+        bucket.erase(std::remove(bucket.begin(), bucket.end(), r),
+                     bucket.end());
+      }
+    }
+    n_removed_rt_routes_ += static_cast<std::uint32_t>(replaced.size());
+    utl::erase_duplicates(transports);
+  }
+
+  add_routes(transports);
+
+  rt_routes_changed_.clear();
+  rt_routes_outdated_ = false;
+}
+
+void rt_timetable::clear_rt_routes() {
+  rt_route_transports_.clear();
+  rt_route_stop_times_.clear();
+  rt_route_location_seq_.clear();
+  location_rt_routes_ = {};
+  rt_transport_route_.clear();
+  rt_routes_changed_.clear();
+  n_removed_rt_routes_ = 0U;
+  rt_routes_outdated_ = true;
+}
+
+void rt_timetable::write(std::filesystem::path const& p) const {
+  return cista::write(p, *this);
+}
+
+rt_timetable rt_timetable::read(std::filesystem::path const& p,
+                               timetable const& tt) {
+  auto snapshot = cista::read<rt_timetable>(p);
+  utl::verify(snapshot->static_tt_fingerprint_ == tt.fingerprint_,
+              "rt timetable {} was created for a different static timetable",
+              p.generic_string());
+
+  // The members that are not serialized hold the bytes of the writing
+  // process: never touch them, only copy the serialized members.
+  auto rtt = rt_timetable{};
+  rtt.cista_members() = snapshot->cista_members();
+  return rtt;
+}
+
 }  // namespace nigiri
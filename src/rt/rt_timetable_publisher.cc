@@ -0,0 +1,72 @@
+#include "nigiri/rt/rt_timetable_publisher.h"
+
+#include <thread>
+#include <utility>
+
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::rt {
+
+rt_timetable_publisher::snapshot::snapshot(rt_timetable_publisher const& p,
+                                           unsigned const buffer_idx)
+    : p_{&p}, idx_{buffer_idx} {}
+
+rt_timetable_publisher::snapshot::snapshot(snapshot&& o) noexcept
+    : p_{std::exchange(o.p_, nullptr)}, idx_{o.idx_} {}
+
+rt_timetable_publisher::snapshot::~snapshot() {
+  if (p_ != nullptr) {
+    p_->readers_[idx_].fetch_sub(1U, std::memory_order_release);
+  }
+}
+
+rt_timetable_publisher::rt_timetable_publisher(timetable const& tt,
+                                               date::sys_days const base_day)
+    : buffers_{create_rt_timetable(tt, base_day),
+               create_rt_timetable(tt, base_day)} {}
+
+rt_timetable_publisher::snapshot rt_timetable_publisher::get_snapshot()
+    const {
+  // Sequentially consistent: the writer must not miss the increment if the
+  // re-check below still sees the buffer as published.
+  while (true) {
+    auto const idx = published_.load();
+    readers_[idx].fetch_add(1U);
+    if (published_.load() == idx) {
+      return snapshot{*this, idx};
+    }
+    // The writer published the other buffer in between and might already
+    // modify this one: retry with the new version.
+    readers_[idx].fetch_sub(1U);
+  }
+}
+
+void rt_timetable_publisher::update(update_fn_t fn) {
+  auto const lock = std::lock_guard{write_mutex_};
+
+  auto const back = 1U - published_.load();
+  wait_for_readers(back);
+
+  auto& rtt = buffers_[back];
+  if (pending_) {
+    auto callback = std::exchange(rtt.change_callback_, nullptr);
+    auto const log_enabled = std::exchange(rtt.change_log_enabled_, false);
+    pending_(rtt);
+    rtt.change_callback_ = std::move(callback);
+    rtt.change_log_enabled_ = log_enabled;
+    pending_ = nullptr;
+  }
+
+  fn(rtt);
+  published_.store(back);
+  pending_ = std::move(fn);
+}
+
+void rt_timetable_publisher::wait_for_readers(unsigned const idx) const {
+  while (readers_[idx].load() != 0U) {
+    std::this_thread::yield();
+  }
+}
+
+}  // namespace nigiri::rt
@@ -0,0 +1,56 @@
+#include "nigiri/rt/vdv/vdv_event_index.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "nigiri/for_each_meta.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::rt::vdv {
+
+event_index::event_index(timetable const& tt) {
+  auto const n_locations = tt.n_locations();
+
+  auto matching = std::vector<std::vector<location_idx_t>>(n_locations);
+  for (auto i = 0U; i != n_locations; ++i) {
+    auto const l = location_idx_t{i};
+    routing::for_each_meta(tt, routing::location_match_mode::kEquivalent, l,
+                           [&](location_idx_t const meta) {
+                             matching[to_idx(meta)].push_back(l);
+                           });
+  }
+  for (auto& m : matching) {
+    std::sort(begin(m), end(m));
+    m.erase(std::unique(begin(m), end(m)), end(m));
+    matching_locations_.emplace_back(m);
+  }
+
+  auto events = std::vector<std::vector<event>>(n_locations);
+  for (auto i = 0U; i != tt.n_routes(); ++i) {
+    auto const r = route_idx_t{i};
+    auto const location_seq = tt.route_location_seq_[r];
+    auto const transports = tt.route_transport_ranges_[r];
+    for (auto stop_idx = 0U; stop_idx != location_seq.size(); ++stop_idx) {
+      auto const is_last = stop_idx == location_seq.size() - 1U;
+      auto const l = stop{location_seq[stop_idx]}.location_idx();
+      auto const times = tt.event_times_at_stop(
+          r, static_cast<stop_idx_t>(stop_idx),
+          is_last ? event_type::kArr : event_type::kDep);
+      for (auto j = 0U; j != times.size(); ++j) {
+        events[to_idx(l)].push_back(
+            {.t_ = transports[j],
+             .stop_idx_ = static_cast<stop_idx_t>(stop_idx),
+             .is_last_ = is_last,
+             .ev_time_ = times[j]});
+      }
+    }
+  }
+  for (auto& e : events) {
+    std::sort(begin(e), end(e), [](event const& a, event const& b) {
+      return a.ev_time_.mam() < b.ev_time_.mam();
+    });
+    events_.emplace_back(e);
+  }
+}
+
+}  // namespace nigiri::rt::vdv
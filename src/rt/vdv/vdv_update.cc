@@ -1,5 +1,8 @@
 #include "nigiri/rt/vdv/vdv_update.h"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -8,6 +11,7 @@
 
 #include "utl/enumerate.h"
 #include "utl/get_or_create.h"
+#include "utl/helpers/algorithm.h"
 #include "utl/parser/arg_parser.h"
 #include "utl/verify.h"
 
@@ -19,6 +23,7 @@
 #include "nigiri/rt/frun.h"
 #include "nigiri/rt/rt_timetable.h"
 #include "nigiri/rt/run.h"
+#include "nigiri/rt/vdv/vdv_event_index.h"
 #include "nigiri/timetable.h"
 #include "nigiri/types.h"
 
@@ -49,7 +54,9 @@ std::ostream& operator<<(std::ostream& out, statistics const& s) {
       << "\nskipped vdv stops: " << s.skipped_vdv_stops_
       << "\nexcess vdv stops: " << s.excess_vdv_stops_
       << "\nupdated events: " << s.updated_events_
-      << "\npropagated delays: " << s.propagated_delays_ << "\n";
+      << "\npropagated delays: " << s.propagated_delays_
+      << "\nindex probes: " << s.index_probes_
+      << "\nmatch duration [us]: " << s.match_duration_.count() << "\n";
   return out;
 }
 
@@ -72,12 +79,19 @@ statistics& operator+=(statistics& lhs, statistics const& rhs) {
   lhs.excess_vdv_stops_ += rhs.excess_vdv_stops_;
   lhs.updated_events_ += rhs.updated_events_;
   lhs.propagated_delays_ += rhs.propagated_delays_;
+  lhs.index_probes_ += rhs.index_probes_;
+  lhs.match_duration_ += rhs.match_duration_;
   return lhs;
 }
 
 updater::updater(nigiri::timetable const& tt, source_idx_t const src_idx)
     : tt_{tt}, src_idx_{src_idx} {}
 
+updater::updater(nigiri::timetable const& tt,
+                 source_idx_t const src_idx,
+                 event_index const& idx)
+    : tt_{tt}, src_idx_{src_idx}, idx_{&idx} {}
+
 void updater::reset_vdv_run_ids_() { vdv_nigiri_.clear(); }
 
 statistics const& updater::get_stats() const { return stats_; }
@@ -196,71 +210,126 @@ std::optional<rt::run> updater::find_run(std::string_view vdv_run_id,
 
   auto candidates = std::vector<candidate>{};
 
+  // Returns true if the transport is active and was added/updated.
+  auto const add_candidate = [&](transport_idx_t const t,
+                                 std::size_t const stop_idx,
+                                 std::size_t const n_stops,
+                                 delta const nigiri_ev_time,
+                                 day_idx_t const vdv_day_idx,
+                                 auto const vdv_mam) {
+    auto const [error, day_shift] =
+        mam_dist(vdv_mam, i32_minutes{nigiri_ev_time.mam()});
+    auto const local_score = kExactMatchScore - error.count() * error.count();
+    if (local_score < 0) {
+      return false;
+    }
+
+    auto const tr = transport{
+        t,
+        vdv_day_idx - day_idx_t{nigiri_ev_time.days() + day_shift.count()}};
+    if (!tt_.bitfields_[tt_.transport_traffic_days_[tr.t_idx_]].test(
+            to_idx(tr.day_))) {
+      return false;
+    }
+
+    auto candidate = std::find_if(begin(candidates), end(candidates),
+                                  [&](auto const& c) { return c.r_.t_ == tr; });
+
+    if (candidate != end(candidates) &&
+        stop_idx < candidate->r_.stop_range_.from_) {
+      return false;
+    }
+
+    if (candidate == end(candidates)) {
+      candidates.emplace_back(
+          run{tr, interval{static_cast<stop_idx_t>(stop_idx),
+                           static_cast<stop_idx_t>(n_stops)}},
+          n_stops);
+      candidate = end(candidates) - 1;
+    }
+
+    candidate->local_best_ = std::max(candidate->local_best_,
+                                      static_cast<std::uint32_t>(local_score));
+    return true;
+  };
+
   for (auto const& vdv_stop : vdv_stops) {
     if (vdv_stop.l_ == location_idx_t::invalid()) {
       continue;
     }
     auto no_transport_found_at_stop = true;
-    for (auto const l : tt_.locations_.equivalences_[vdv_stop.l_]) {
-      for (auto const r : tt_.location_routes_[l]) {
-        auto const location_seq = tt_.route_location_seq_[r];
-        for (auto const [stop_idx, s] : utl::enumerate(location_seq)) {
-          if (!matches(tt_, routing::location_match_mode::kEquivalent,
-                       stop{s}.location_idx(), vdv_stop.l_)) {
-            continue;
-          }
-
-          auto const vdv_ev = stop_idx == location_seq.size() - 1
-                                  ? vdv_stop.get_event(event_type::kArr)
-                                  : vdv_stop.get_event(event_type::kDep);
+    if (idx_ != nullptr) {
+      // Same candidates as the route scan below: only routes that serve an
+      // equivalent of the VDV stop. Routes at an equivalent location l
+      // trivially do, others are checked per event.
+      auto const equivalences = tt_.locations_.equivalences_[vdv_stop.l_];
+      auto const serves_equivalent = [&](route_idx_t const r) {
+        return utl::any_of(equivalences, [&](location_idx_t const eq) {
+          return utl::find(tt_.location_routes_[eq], r) !=
+                 end(tt_.location_routes_[eq]);
+        });
+      };
+
+      for (auto const l : idx_->matching_locations_[vdv_stop.l_]) {
+        auto const is_equivalent =
+            utl::find(equivalences, l) != end(equivalences);
+        for (auto const ev_type : {event_type::kDep, event_type::kArr}) {
+          auto const vdv_ev = vdv_stop.get_event(ev_type);
           if (!vdv_ev.has_value()) {
             continue;
           }
 
-          auto const [vdv_time, ev_type] = *vdv_ev;
-          auto const [vdv_day_idx, vdv_mam] = tt_.day_idx_mam(vdv_time);
-
-          for (auto const [nigiri_ev_time_idx, nigiri_ev_time] :
-               utl::enumerate(tt_.event_times_at_stop(
-                   r, static_cast<stop_idx_t>(stop_idx), ev_type))) {
-            auto const [error, day_shift] =
-                mam_dist(vdv_mam, i32_minutes{nigiri_ev_time.mam()});
-            auto const local_score =
-                kExactMatchScore - error.count() * error.count();
-            if (local_score < 0) {
+          auto const vdv_day_mam = tt_.day_idx_mam(vdv_ev->first);
+          ++stats_.index_probes_;
+          idx_->for_each_event(
+              l, static_cast<std::int32_t>(vdv_day_mam.second.count()),
+              kAllowedTimeDiscrepancy,
+              [&](event_index::event const& e) {
+                if (e.is_last_ != (ev_type == event_type::kArr)) {
+                  return;
+                }
+                auto const r = tt_.transport_route_[e.t_];
+                if (!is_equivalent && !serves_equivalent(r)) {
+                  return;
+                }
+                if (add_candidate(e.t_, e.stop_idx_,
+                                  tt_.route_location_seq_[r].size(),
+                                  e.ev_time_, vdv_day_mam.first,
+                                  vdv_day_mam.second)) {
+                  no_transport_found_at_stop = false;
+                }
+              });
+        }
+      }
+    } else {
+      for (auto const l : tt_.locations_.equivalences_[vdv_stop.l_]) {
+        for (auto const r : tt_.location_routes_[l]) {
+          auto const location_seq = tt_.route_location_seq_[r];
+          for (auto const [stop_idx, s] : utl::enumerate(location_seq)) {
+            if (!matches(tt_, routing::location_match_mode::kEquivalent,
+                         stop{s}.location_idx(), vdv_stop.l_)) {
               continue;
             }
 
-            auto const tr = transport{
-                tt_.route_transport_ranges_[r][nigiri_ev_time_idx],
-                vdv_day_idx -
-                    day_idx_t{nigiri_ev_time.days() + day_shift.count()}};
-
-            if (tt_.bitfields_[tt_.transport_traffic_days_[tr.t_idx_]].test(
-                    to_idx(tr.day_))) {
-              auto candidate =
-                  std::find_if(begin(candidates), end(candidates),
-                               [&](auto const& c) { return c.r_.t_ == tr; });
-
-              if (candidate != end(candidates) &&
-                  stop_idx < candidate->r_.stop_range_.from_) {
-                continue;
-              }
+            auto const vdv_ev = stop_idx == location_seq.size() - 1
+                                    ? vdv_stop.get_event(event_type::kArr)
+                                    : vdv_stop.get_event(event_type::kDep);
+            if (!vdv_ev.has_value()) {
+              continue;
+            }
 
-              if (candidate == end(candidates)) {
-                candidates.emplace_back(
-                    run{tr,
-                        interval{static_cast<stop_idx_t>(stop_idx),
-                                 static_cast<stop_idx_t>(location_seq.size())}},
-                    location_seq.size());
-                candidate = end(candidates) - 1;
+            auto const [vdv_time, ev_type] = *vdv_ev;
+            auto const [vdv_day_idx, vdv_mam] = tt_.day_idx_mam(vdv_time);
+
+            for (auto const [nigiri_ev_time_idx, nigiri_ev_time] :
+                 utl::enumerate(tt_.event_times_at_stop(
+                     r, static_cast<stop_idx_t>(stop_idx), ev_type))) {
+              if (add_candidate(
+                      tt_.route_transport_ranges_[r][nigiri_ev_time_idx],
+                      stop_idx, location_seq.size(), nigiri_ev_time,
+                      vdv_day_idx, vdv_mam)) {
+                no_transport_found_at_stop = false;
               }
-
-              candidate->local_best_ =
-                  std::max(candidate->local_best_,
-                           static_cast<std::uint32_t>(local_score));
-
-              no_transport_found_at_stop = false;
             }
           }
         }
@@ -471,9 +540,16 @@ void updater::process_vdv_run(rt_timetable& rtt, pugi::xml_node const vdv_run) {
 
   auto const is_complete_run = *get_opt_bool(vdv_run, "Komplettfahrt", false);
 
-  auto r = vdv_nigiri_.contains(vdv_run_id)
-               ? std::optional{vdv_nigiri_.at(vdv_run_id)}
-               : find_run(vdv_run_id, vdv_stops, is_complete_run);
+  auto r = std::optional<run>{};
+  if (vdv_nigiri_.contains(vdv_run_id)) {
+    r = vdv_nigiri_.at(vdv_run_id);
+  } else {
+    auto const match_start = std::chrono::steady_clock::now();
+    r = find_run(vdv_run_id, vdv_stops, is_complete_run);
+    stats_.match_duration_ +=
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - match_start);
+  }
   if (!r.has_value()) {
     if (is_complete_run) {
 #ifdef VDV_DEBUG
@@ -490,26 +566,162 @@ void updater::process_vdv_run(rt_timetable& rtt, pugi::xml_node const vdv_run) {
   update_run(rtt, *r, vdv_stops, is_complete_run);
 }
 
-void updater::update(rt_timetable& rtt, pugi::xml_document const& doc) {
-  for (auto const& vdv_run : doc.select_nodes("//IstFahrt")) {
-    if (get_opt_bool(vdv_run.node(), "Zusatzfahrt", false).value()) {
+void updater::process_ist_fahrt(rt_timetable& rtt,
+                                pugi::xml_node const vdv_run) {
+  if (get_opt_bool(vdv_run, "Zusatzfahrt", false).value()) {
 #ifdef VDV_DEBUG
-      vdv_trace("unsupported additional run:\n");
-      vdv_run.node().print(std::cout);
+    vdv_trace("unsupported additional run:\n");
+    vdv_run.print(std::cout);
 #endif
-      ++stats_.unsupported_additional_runs_;
-      continue;
-    } else if (get_opt_bool(vdv_run.node(), "FaelltAus", false).value()) {
+    ++stats_.unsupported_additional_runs_;
+    return;
+  } else if (get_opt_bool(vdv_run, "FaelltAus", false).value()) {
 #ifdef VDV_DEBUG
-      vdv_trace("unsupported canceled run:\n");
-      vdv_run.node().print(std::cout);
+    vdv_trace("unsupported canceled run:\n");
+    vdv_run.print(std::cout);
 #endif
-      ++stats_.unsupported_cancelled_runs_;
+    ++stats_.unsupported_cancelled_runs_;
+    return;
+  }
+
+  process_vdv_run(rtt, vdv_run);
+}
+
+void updater::update(rt_timetable& rtt, pugi::xml_document const& doc) {
+  for (auto const& vdv_run : doc.select_nodes("//IstFahrt")) {
+    process_ist_fahrt(rtt, vdv_run.node());
+  }
+
+  rtt.build_rt_routes(tt_);
+}
+
+void updater::update(rt_timetable& rtt, std::string_view xml) {
+  auto stream = update_stream{*this, rtt};
+  stream.feed(xml);
+  stream.finish();
+}
+
+namespace {
+
+// Value of the encoding attribute of the XML prolog (lower case), e.g.
+// <?xml version="1.0" encoding = 'ISO-8859-1'?>. Empty if not declared.
+std::string xml_encoding(std::string_view prolog) {
+  constexpr auto const kWs = std::string_view{" \t\r\n"};
+  constexpr auto const kAttr = std::string_view{"encoding"};
+  auto const skip_ws = [&](std::size_t const i) {
+    return std::min(prolog.find_first_not_of(kWs, i), prolog.size());
+  };
+
+  for (auto pos = prolog.find(kAttr); pos != std::string_view::npos;
+       pos = prolog.find(kAttr, pos + 1U)) {
+    auto i = skip_ws(pos + kAttr.size());
+    if (i == prolog.size() || prolog[i] != '=') {
       continue;
     }
+    i = skip_ws(i + 1U);
+    if (i == prolog.size() || (prolog[i] != '"' && prolog[i] != '\'')) {
+      continue;
+    }
+    auto const end = prolog.find(prolog[i], i + 1U);
+    if (end == std::string_view::npos) {
+      return {};
+    }
+    auto encoding = std::string{prolog.substr(i + 1U, end - i - 1U)};
+    for (auto& c : encoding) {
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return encoding;
+  }
+  return {};
+}
+
+}  // namespace
+
+update_stream::update_stream(updater& u, rt_timetable& rtt)
+    : updater_{u},
+      rtt_{rtt},
+      run_doc_{std::make_unique<pugi::xml_document>()} {}
+
+update_stream::~update_stream() = default;
+
+void update_stream::feed(std::string_view const chunk) {
+  constexpr auto const kOpen = std::string_view{"<IstFahrt"};
+  constexpr auto const kClose = std::string_view{"</IstFahrt>"};
+
+  buf_.append(chunk);
+
+  if (!prolog_checked_) {
+    // The encoding of the message is declared in the XML prolog, which is
+    // not part of the IstFahrt elements. Wait until it is complete.
+    constexpr auto const kProlog = std::string_view{"<?xml"};
+    auto const b = std::string_view{buf_};
+    auto const start = b.find_first_not_of(" \t\r\n");
+    if (start == std::string_view::npos) {
+      return;
+    }
+    auto const head = b.substr(start, kProlog.size());
+    if (head.size() < kProlog.size() && kProlog.starts_with(head)) {
+      return;  // could still become a prolog
+    }
+    if (head == kProlog) {
+      auto const prolog_end = b.find("?>", start);
+      if (prolog_end == std::string_view::npos) {
+        return;  // prolog incomplete
+      }
+      auto const encoding =
+          xml_encoding(b.substr(start, prolog_end - start));
+      latin1_ = encoding == "iso-8859-1" || encoding == "latin1";
+    }
+    prolog_checked_ = true;
+  }
+
+  auto pos = std::size_t{0U};
+  while (true) {
+    // Start tag: "<IstFahrt" followed by '>' or whitespace.
+    auto start = buf_.find(kOpen, pos);
+    while (start != std::string::npos && start + kOpen.size() < buf_.size()) {
+      auto const next =
+          static_cast<unsigned char>(buf_[start + kOpen.size()]);
+      if (next == '>' || std::isspace(next) != 0) {
+        break;
+      }
+      start = buf_.find(kOpen, start + 1U);
+    }
 
-    process_vdv_run(rtt, vdv_run.node());
+    if (start == std::string::npos) {
+      // Keep a possibly incomplete start tag at the end.
+      pos = std::max(pos, buf_.size() >= kOpen.size()
+                              ? buf_.size() - kOpen.size() + 1U
+                              : std::size_t{0U});
+      break;
+    }
+
+    auto const end = buf_.find(kClose, start);
+    if (start + kOpen.size() >= buf_.size() || end == std::string::npos) {
+      pos = start;  // wait for the rest of the element
+      break;
+    }
+
+    auto const size = end + kClose.size() - start;
+    auto const result = run_doc_->load_buffer_inplace(
+        buf_.data() + start, size, pugi::parse_default,
+        latin1_ ? pugi::encoding_latin1 : pugi::encoding_auto);
+    if (result) {
+      updater_.process_ist_fahrt(rtt_, run_doc_->first_child());
+    } else {
+      log(log_lvl::error, "vdv_update.stream", "invalid IstFahrt: {}",
+          result.description());
+    }
+    pos = start + size;
   }
+
+  run_doc_->reset();
+  buf_.erase(0U, pos);
+}
+
+void update_stream::finish() {
+  buf_.clear();
+  rtt_.build_rt_routes(updater_.tt_);
 }
 
 }  // namespace nigiri::rt::vdv
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "nigiri/timetable.h"
 
+#include <bit>
+
+#include "cista/hash.h"
 #include "cista/io.h"
 
 #include "utl/overloaded.h"
@@ -23,6 +26,105 @@ void timetable::locations::resolve_timezones() {
   }
 }
 
+namespace {
+
+std::uint64_t trip_id_hash(source_idx_t const src, std::string_view id) {
+  return cista::hash(id, cista::hash_combine(cista::BASE_HASH, to_idx(src)));
+}
+
+}  // namespace
+
+void timetable::build_trip_id_index() {
+  auto const is_range_start = [&](std::size_t const i) {
+    if (i == 0U) {
+      return true;
+    }
+    auto const a = trip_id_to_idx_[i - 1U].first;
+    auto const b = trip_id_to_idx_[i].first;
+    return trip_id_src_[a] != trip_id_src_[b] ||
+           trip_id_strings_[a].view() != trip_id_strings_[b].view();
+  };
+
+  auto n_distinct = std::size_t{0U};
+  for (auto i = 0U; i != trip_id_to_idx_.size(); ++i) {
+    n_distinct += is_range_start(i) ? 1U : 0U;
+  }
+
+  // Load factor <= 0.5 keeps probe sequences short.
+  auto const n_slots =
+      std::bit_ceil(std::max(std::size_t{2U}, 2U * n_distinct));
+  auto const mask = n_slots - 1U;
+  trip_id_index_.clear();
+  trip_id_index_.resize(n_slots, {0U, 0U});
+
+  for (auto i = 0U; i != trip_id_to_idx_.size(); ++i) {
+    if (!is_range_start(i)) {
+      continue;
+    }
+    auto const id = trip_id_to_idx_[i].first;
+    auto const h = trip_id_hash(trip_id_src_[id], trip_id_strings_[id].view());
+    auto slot = h & mask;
+    while (trip_id_index_[slot].second != 0U) {
+      slot = (slot + 1U) & mask;
+    }
+    trip_id_index_[slot] = {static_cast<std::uint32_t>(h >> 32U), i + 1U};
+  }
+}
+
+vector<pair<trip_id_idx_t, trip_idx_t>>::const_iterator timetable::find_trip_id(
+    source_idx_t const src, std::string_view id) const {
+  if (trip_id_index_.empty()) {
+    auto const it = std::lower_bound(
+        begin(trip_id_to_idx_), end(trip_id_to_idx_), std::tuple(src, id),
+        [&](pair<trip_id_idx_t, trip_idx_t> const& a,
+            std::tuple<source_idx_t, std::string_view> const& b) {
+          return std::tuple(trip_id_src_[a.first],
+                            trip_id_strings_[a.first].view()) < b;
+        });
+    return it != end(trip_id_to_idx_) && trip_id_src_[it->first] == src &&
+                   trip_id_strings_[it->first].view() == id
+               ? it
+               : end(trip_id_to_idx_);
+  }
+
+  auto const h = trip_id_hash(src, id);
+  auto const tag = static_cast<std::uint32_t>(h >> 32U);
+  auto const mask = trip_id_index_.size() - 1U;
+  for (auto slot = h & mask; trip_id_index_[slot].second != 0U;
+       slot = (slot + 1U) & mask) {
+    auto const [slot_tag, pos] = trip_id_index_[slot];
+    if (slot_tag != tag) {
+      continue;
+    }
+    auto const it = begin(trip_id_to_idx_) + (pos - 1U);
+    if (trip_id_src_[it->first] == src &&
+        trip_id_strings_[it->first].view() == id) {
+      return it;
+    }
+  }
+  return end(trip_id_to_idx_);
+}
+
+std::uint64_t timetable::compute_fingerprint() const {
+  auto const hash_bytes = [](cista::hash_t const h, auto const& v) {
+    return cista::hash(
+        std::string_view{reinterpret_cast<char const*>(v.data()),
+                         v.size() * sizeof(*v.data())},
+        h);
+  };
+  auto h = cista::BASE_HASH;
+  h = cista::hash_combine(h, date_range_.from_.time_since_epoch().count(),
+                          date_range_.to_.time_since_epoch().count());
+  h = cista::hash_combine(h, n_locations(), n_routes(),
+                          transport_traffic_days_.size(), bitfields_.size());
+  h = hash_bytes(h, locations_.ids_.data_);
+  h = hash_bytes(h, trip_id_strings_.data_);
+  h = hash_bytes(h, transport_traffic_days_);
+  h = hash_bytes(h, route_location_seq_.data_);
+  h = hash_bytes(h, route_stop_times_);
+  return h;
+}
+
 std::ostream& operator<<(std::ostream& out, timetable const& tt) {
   for (auto const [id, idx] : tt.trip_id_to_idx_) {
     auto const str = tt.trip_id_strings_[id].view();
@@ -14,6 +14,17 @@ void nigiri_update_with_rt_from_buf(const nigiri_timetable_t* t,
                                     void (*callback)(nigiri_event_change_t,
                                                      void* context),
                                     void* context);
+void nigiri_update_with_rt_batch_from_buf(
+    const nigiri_timetable_t* t,
+    std::string_view protobuf,
+    void (*callback)(const nigiri_event_change_t* changes,
+                     uint32_t n_changes,
+                     void* context),
+    void* context);
+uint32_t nigiri_update_with_rt_changes_from_buf(
+    const nigiri_timetable_t* t,
+    std::string_view protobuf,
+    const nigiri_event_change_t** changes);
 
 using namespace nigiri;
 using namespace nigiri::loader;
@@ -476,5 +487,31 @@ TEST(rt, abi_1) {
                                  &test_event_change_counter);
   EXPECT_EQ(27, test_event_change_counter);
 
+  auto const my_test_batch_callback = [](const nigiri_event_change_t* changes,
+                                         uint32_t const n_changes,
+                                         void* context) {
+    *static_cast<uint32_t*>(context) = n_changes;
+    ASSERT_EQ(27U, n_changes);
+    EXPECT_EQ(14, changes[0].stop_idx);
+    EXPECT_EQ(false, changes[0].is_departure);
+    EXPECT_EQ(1, changes[0].delay);
+    EXPECT_EQ(25, changes[23].stop_idx);
+    EXPECT_EQ(true, changes[23].is_departure);
+    EXPECT_EQ(-1, changes[23].delay);
+  };
+
+  auto n_batch_changes = 0U;
+  nigiri_update_with_rt_batch_from_buf(t, msg, my_test_batch_callback,
+                                       &n_batch_changes);
+  EXPECT_EQ(27U, n_batch_changes);
+
+  // Borrowed array, valid until the next update.
+  auto const* changes = static_cast<nigiri_event_change_t const*>(nullptr);
+  ASSERT_EQ(27U, nigiri_update_with_rt_changes_from_buf(t, msg, &changes));
+  ASSERT_NE(nullptr, changes);
+  EXPECT_EQ(14, changes[0].stop_idx);
+  EXPECT_EQ(25, changes[23].stop_idx);
+  EXPECT_EQ(-1, changes[23].delay);
+
   nigiri_destroy(t);
 }
@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "nigiri/loader/gtfs/csv_scanner.h"
+
+namespace nigiri::loader::gtfs {
+
+namespace {
+
+std::vector<std::vector<std::string>> scan(std::string_view csv,
+                                           std::size_t const n_cols) {
+  auto rows = std::vector<std::vector<std::string>>{};
+  auto scanner = csv_scanner{csv};
+  while (scanner.next()) {
+    auto& row = rows.emplace_back();
+    for (auto i = 0U; i != n_cols; ++i) {
+      row.emplace_back(scanner[i].view());
+    }
+  }
+  return rows;
+}
+
+}  // namespace
+
+TEST(gtfs, csv_scanner_columns) {
+  auto const csv = csv_scanner{"\xEF\xBB\xBFtrip_id, stop_id ,x\r\n"};
+  EXPECT_EQ(0U, csv.column("trip_id"));
+  EXPECT_EQ(1U, csv.column("stop_id"));
+  EXPECT_EQ(2U, csv.column("x"));
+  EXPECT_EQ(csv_scanner::kMissing, csv.column("stop_headsign"));
+}
+
+TEST(gtfs, csv_scanner_rows) {
+  using row = std::vector<std::string>;
+
+  // Fields longer than eight bytes, quotes, CRLF, empty lines, short rows.
+  auto const rows = scan(
+      "a,b,c\r\n"
+      "a_very_long_trip_id_0123456789,x,y\r\n"
+      "\r\n"
+      "\"quoted, with comma\",\"multi\nline\",\"\"\n"
+      "\"say \"\"hi\"\"\",\"\"\"\",5\n"
+      "\n"
+      "only_one\n"
+      "in\"side,,last",
+      3U);
+  ASSERT_EQ(5U, rows.size());
+  EXPECT_EQ((row{"a_very_long_trip_id_0123456789", "x", "y"}), rows[0]);
+  EXPECT_EQ((row{"quoted, with comma", "multi\nline", ""}), rows[1]);
+  EXPECT_EQ((row{"say \"hi\"", "\"", "5"}), rows[2]);
+  EXPECT_EQ((row{"only_one", "", ""}), rows[3]);
+  EXPECT_EQ((row{"in\"side", "", "last"}), rows[4]);
+}
+
+TEST(gtfs, csv_scanner_chunk) {
+  auto csv = csv_scanner{"x,y\n", "1,2\n3,4"};
+  ASSERT_TRUE(csv.next());
+  EXPECT_EQ("2", csv[csv.column("y")].view());
+  EXPECT_EQ(4U, csv.position());
+  ASSERT_TRUE(csv.next());
+  EXPECT_EQ("3", csv[csv.column("x")].view());
+  EXPECT_EQ(7U, csv.position());
+  EXPECT_FALSE(csv.next());
+}
+
+TEST(gtfs, csv_scanner_unescaped_lifetime) {
+  // Readers keep views of earlier rows (e.g. stop IDs).
+  auto csv = csv_scanner{"id\n\"a\"\"b\"\n\"c\"\"d\"\n"};
+  ASSERT_TRUE(csv.next());
+  auto const first = csv[0U];
+  ASSERT_TRUE(csv.next());
+  EXPECT_EQ("a\"b", first.view());
+  EXPECT_EQ("c\"d", csv[0U].view());
+}
+
+TEST(gtfs, parse_int) {
+  EXPECT_EQ(0, parse_int<int>(utl::cstr{""}));
+  EXPECT_EQ(7, parse_int<int>(utl::cstr{"7"}));
+  EXPECT_EQ(123456789, parse_int<int>(utl::cstr{"123456789"}));
+  EXPECT_EQ(1234567890U, parse_int<unsigned>(utl::cstr{"1234567890"}));
+  EXPECT_EQ(-3, parse_int<int>(utl::cstr{"-3"}));
+  EXPECT_EQ(std::uint16_t{42U}, parse_int<std::uint16_t>(utl::cstr{"42"}));
+}
+
+}  // namespace nigiri::loader::gtfs
@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 
 #include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/parse_time.h"
 #include "nigiri/loader/gtfs/stop_time.h"
 #include "nigiri/loader/loader_interface.h"
 
@@ -13,6 +14,16 @@ using namespace date;
 
 namespace nigiri::loader::gtfs {
 
+TEST(gtfs, hhmm_to_min) {
+  EXPECT_EQ(duration_t{8 * 60 + 5}, hhmm_to_min(utl::cstr{"08:05:00"}));
+  EXPECT_EQ(duration_t{8 * 60 + 5}, hhmm_to_min(utl::cstr{"8:05:59"}));
+  EXPECT_EQ(duration_t{25 * 60 + 30}, hhmm_to_min(utl::cstr{"25:30"}));
+  EXPECT_EQ(duration_t{123 * 60 + 1}, hhmm_to_min(utl::cstr{"123:01:00"}));
+  EXPECT_EQ(duration_t{7 * 60 + 3}, hhmm_to_min(utl::cstr{"7:3:00"}));
+  EXPECT_EQ(kInterpolate, hhmm_to_min(utl::cstr{""}));
+  EXPECT_EQ(kInterpolate, hhmm_to_min(utl::cstr{"12"}));
+}
+
 TEST(gtfs, read_stop_times_example_data) {
   auto const files = example_files();
 
@@ -112,4 +123,106 @@ TEST(gtfs, read_stop_times_example_data) {
   read_frequencies(trip_data, files.get_file(kFrequenciesFile).data());
 }
 
+namespace {
+
+constexpr auto const kChunkBorderStopTimes =
+    R"(trip_id,arrival_time,departure_time,stop_id,stop_sequence,stop_headsign,shape_dist_traveled
+AWD1,6:10,6:10,S1,1,Head A,
+AWD1,6:15,6:15,S2,2,Head A,1.5
+UNKNOWN,6:15,6:15,S2,2,,
+AWD1,6:20,6:20,S3,3,,2.5
+AWD1,6:25,6:25,UNKNOWN,4,,
+AWD1,6:30,6:30,S4,4,Head B,
+AWE1,6:10,6:10,S1,1,,
+AWE1,6:20,6:30,S3,3,Head C,
+AWE1,6:15,6:15,S2,2,,
+UNKNOWN,6:15,6:15,S2,2,,
+)";
+
+trip_data read_chunked(timetable& tt,
+                       std::size_t const chunk_size,
+                       bool const parse_first = false) {
+  auto const files = example_files();
+
+  tt.date_range_ = interval{date::sys_days{July / 1 / 2006},
+                            date::sys_days{August / 1 / 2006}};
+  tz_map timezones;
+
+  auto const config = loader_config{};
+  auto agencies =
+      read_agencies(tt, timezones, files.get_file(kAgencyFile).data());
+  auto const routes = read_routes(tt, timezones, agencies,
+                                  files.get_file(kRoutesFile).data(), "CET");
+  auto const dates =
+      read_calendar_date(files.get_file(kCalendarDatesFile).data());
+  auto const calendar = read_calendar(files.get_file(kCalenderFile).data());
+  auto const services =
+      merge_traffic_days(tt.internal_interval_days(), calendar, dates);
+  auto trip_data =
+      read_trips(tt, routes, services, {}, files.get_file(kTripsFile).data(),
+                 config.bikes_allowed_default_);
+  auto const stops = read_stops(source_idx_t{0}, tt, timezones,
+                                files.get_file(kStopFile).data(),
+                                files.get_file(kTransfersFile).data(), 0U);
+
+  if (parse_first) {
+    auto st = split_stop_times(kChunkBorderStopTimes, chunk_size);
+    parse_stop_times(st);
+    read_stop_times(tt, trip_data, stops, st, true);
+  } else {
+    read_stop_times(tt, trip_data, stops, kChunkBorderStopTimes, true,
+                    chunk_size);
+  }
+  return trip_data;
+}
+
+}  // namespace
+
+TEST(gtfs, read_stop_times_chunk_borders) {
+  auto ref_tt = timetable{};
+  auto const ref = read_chunked(ref_tt, kStopTimesChunkSize);
+
+  // Chunk sizes of 1 byte put every row in its own chunk. The other sizes cut
+  // trips and unknown trips / stops at varying positions. Rows are parsed
+  // either while reading or all before reading.
+  for (auto const [chunk_size, parse_first] :
+       {std::pair{1U, false}, std::pair{16U, false}, std::pair{50U, false},
+        std::pair{100U, false}, std::pair{200U, false}, std::pair{1U, true},
+        std::pair{50U, true}, std::pair{200U, true}}) {
+    auto tt = timetable{};
+    auto const chunked = read_chunked(tt, chunk_size, parse_first);
+
+    ASSERT_EQ(ref.data_.size(), chunked.data_.size());
+    for (auto i = 0U; i != ref.data_.size(); ++i) {
+      auto const& a = ref.get(gtfs_trip_idx_t{i});
+      auto const& b = chunked.get(gtfs_trip_idx_t{i});
+      EXPECT_EQ(a.seq_numbers_, b.seq_numbers_) << chunk_size;
+      EXPECT_EQ(a.stop_seq_, b.stop_seq_) << chunk_size;
+      ASSERT_EQ(a.event_times_.size(), b.event_times_.size()) << chunk_size;
+      for (auto j = 0U; j != a.event_times_.size(); ++j) {
+        EXPECT_EQ(a.event_times_[j].arr_, b.event_times_[j].arr_);
+        EXPECT_EQ(a.event_times_[j].dep_, b.event_times_[j].dep_);
+      }
+      EXPECT_EQ(a.distance_traveled_, b.distance_traveled_) << chunk_size;
+      EXPECT_EQ(a.stop_headsigns_, b.stop_headsigns_) << chunk_size;
+      EXPECT_EQ(a.requires_sorting_, b.requires_sorting_) << chunk_size;
+      EXPECT_EQ(a.from_line_, b.from_line_) << chunk_size;
+      EXPECT_EQ(a.to_line_, b.to_line_) << chunk_size;
+    }
+    EXPECT_EQ(ref_tt.trip_direction_strings_.size(),
+              tt.trip_direction_strings_.size());
+  }
+
+  auto const& awd1 = ref.get("AWD1");
+  EXPECT_EQ((std::vector<std::uint16_t>{1U, 2U, 3U, 4U}), awd1.seq_numbers_);
+  EXPECT_EQ(2U, awd1.from_line_);
+  EXPECT_EQ(7U, awd1.to_line_);
+  EXPECT_EQ((std::vector{0.0, 1.5, 2.5, 0.0}), awd1.distance_traveled_);
+
+  auto const& awe1 = ref.get("AWE1");
+  EXPECT_EQ((std::vector<std::uint16_t>{1U, 3U, 2U}), awe1.seq_numbers_);
+  EXPECT_TRUE(awe1.requires_sorting_);
+  EXPECT_EQ(8U, awe1.from_line_);
+}
+
 }  // namespace nigiri::loader::gtfs
@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/timetable.h"
+
+using namespace date;
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::gtfs;
+
+namespace {
+
+// T2 overtakes T1 and T3. T4 equals T3.
+mem_dir sub_routes_files() {
+  return mem_dir::read(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+AG,Agency,https://agency.com,Etc/UTC
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+A,A,1.0,1.0
+B,B,2.0,2.0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S,20240601,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R,AG,R,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+R,S,T1,B
+R,S,T2,B
+R,S,T3,B
+R,S,T4,B
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+T3,10:20:00,10:20:00,A,1
+T3,11:20:00,11:20:00,B,2
+T1,10:00:00,10:00:00,A,1
+T1,11:00:00,11:00:00,B,2
+T2,10:10:00,10:10:00,A,1
+T2,10:50:00,10:50:00,B,2
+T4,10:20:00,10:20:00,A,1
+T4,11:20:00,11:20:00,B,2
+)");
+}
+
+}  // namespace
+
+TEST(gtfs, sub_routes_fifo) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2024_y / June / 1},
+                    date::sys_days{2024_y / June / 2}};
+  load_timetable({}, source_idx_t{0}, sub_routes_files(), tt);
+  finalize(tt);
+
+  ASSERT_EQ(2U, tt.n_routes());
+  auto n_transports = std::size_t{0U};
+  for (auto r = 0U; r != tt.n_routes(); ++r) {
+    auto const transports = tt.route_transport_ranges_[route_idx_t{r}];
+    n_transports += transports.size();
+
+    // Transports of a route are sorted and do not overtake each other.
+    for (auto const t : transports) {
+      if (t == transports.from_) {
+        continue;
+      }
+      auto const prev = transport_idx_t{to_idx(t) - 1U};
+      EXPECT_LE(tt.event_mam(prev, 0U, event_type::kDep).as_duration(),
+                tt.event_mam(t, 0U, event_type::kDep).as_duration());
+      EXPECT_LE(tt.event_mam(prev, 1U, event_type::kArr).as_duration(),
+                tt.event_mam(t, 1U, event_type::kArr).as_duration());
+    }
+  }
+  EXPECT_EQ(4U, n_transports);
+}
@@ -0,0 +1,216 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "fmt/core.h"
+
+#include "cista/serialization.h"
+
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/loader/load.h"
+#include "nigiri/loader/loader_interface.h"
+#include "nigiri/timetable.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace date;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string feed(std::string_view trip_id, std::string_view dep) {
+  return fmt::format(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+AG,Agency,https://agency.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+A,A,1.0,1.0
+B,B,2.0,2.0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S,20240601,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R,AG,R,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+R,S,{0},B
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+{0},{1},{1},A,1
+{0},11:00:00,11:00:00,B,2
+)",
+                     trip_id, dep);
+}
+
+std::vector<fs::path> checkpoints(fs::path const& cache_dir) {
+  auto files = std::vector<fs::path>{};
+  for (auto const& e : fs::directory_iterator{cache_dir}) {
+    if (e.path().filename().generic_string().starts_with("checkpoint-")) {
+      files.emplace_back(e.path());
+    }
+  }
+  std::sort(begin(files), end(files));
+  return files;
+}
+
+}  // namespace
+
+TEST(loader, load_cache) {
+  auto const cache_dir = fs::temp_directory_path() / "nigiri-load-cache-test";
+  fs::remove_all(cache_dir);
+
+  auto const date_range = interval{date::sys_days{2024_y / June / 1},
+                                   date::sys_days{2024_y / June / 3}};
+  auto const serialized = [&](std::string_view dep, fs::path const& cache) {
+    auto const paths = std::vector<std::pair<std::string, loader_config>>{
+        {feed("T1", "10:00:00"), loader_config{}},
+        {feed("T2", dep), loader_config{}}};
+    auto tt = load(paths, {}, date_range, nullptr, nullptr, false, cache);
+    return cista::serialize(tt);
+  };
+
+  // Checkpoint written on the first import, restored on the second.
+  auto const reference = serialized("10:00:00", {});
+  EXPECT_EQ(reference, serialized("10:00:00", cache_dir));
+  EXPECT_EQ(1U, checkpoints(cache_dir).size());
+  EXPECT_EQ(reference, serialized("10:00:00", cache_dir));
+
+  // Changed source: parsed again, stale checkpoint replaced.
+  auto const changed = serialized("10:10:00", {});
+  EXPECT_NE(reference, changed);
+  EXPECT_EQ(changed, serialized("10:10:00", cache_dir));
+  EXPECT_EQ(1U, checkpoints(cache_dir).size());
+
+  fs::remove_all(cache_dir);
+}
+
+TEST(loader, load_cache_partial_resume) {
+  auto const cache_dir =
+      fs::temp_directory_path() / "nigiri-load-cache-partial-resume-test";
+  fs::remove_all(cache_dir);
+
+  auto const date_range = interval{date::sys_days{2024_y / June / 1},
+                                   date::sys_days{2024_y / June / 3}};
+  auto const serialized = [&](std::size_t const n_sources,
+                              std::string_view dep, fs::path const& cache) {
+    auto paths = std::vector<std::pair<std::string, loader_config>>{
+        {feed("T1", "10:00:00"), loader_config{}},
+        {feed("T2", "10:05:00"), loader_config{}},
+        {feed("T3", dep), loader_config{}}};
+    paths.resize(n_sources);
+    auto tt = load(paths, {}, date_range, nullptr, nullptr, false, cache, 1U);
+    return cista::serialize(tt);
+  };
+  auto const added = [](std::vector<fs::path> const& before,
+                        std::vector<fs::path> const& after) {
+    auto diff = std::vector<fs::path>{};
+    std::set_difference(begin(after), end(after), begin(before), end(before),
+                        std::back_inserter(diff));
+    return diff;
+  };
+
+  // One checkpoint per source. A checkpoint only depends on the sources up to
+  // its own, so importing growing prefixes identifies them.
+  serialized(1U, "10:10:00", cache_dir);
+  auto const cp1 = checkpoints(cache_dir);
+  ASSERT_EQ(1U, cp1.size());
+  serialized(2U, "10:10:00", cache_dir);
+  auto const cp2 = added(cp1, checkpoints(cache_dir));
+  ASSERT_EQ(1U, cp2.size());
+  EXPECT_EQ(serialized(3U, "10:10:00", {}),
+            serialized(3U, "10:10:00", cache_dir));
+  EXPECT_EQ(3U, checkpoints(cache_dir).size());
+
+  // Without the checkpoint of the first source, a full import would write it
+  // again. Resuming from the checkpoint of the first two sources restores
+  // their timetable, rebuilds the bitfield map and only parses the changed
+  // third source, which has to reuse the restored bitfields exactly like a
+  // sequential import.
+  fs::remove(cp1.front());
+  EXPECT_EQ(serialized(3U, "10:20:00", {}),
+            serialized(3U, "10:20:00", cache_dir));
+  EXPECT_FALSE(fs::exists(cp1.front()));
+  EXPECT_TRUE(fs::exists(cp2.front()));
+  EXPECT_EQ(2U, checkpoints(cache_dir).size());
+
+  fs::remove_all(cache_dir);
+}
+
+TEST(loader, load_cache_shared_dir) {
+  auto const cache_dir =
+      fs::temp_directory_path() / "nigiri-load-cache-shared-dir-test";
+  fs::remove_all(cache_dir);
+
+  auto const date_range = interval{date::sys_days{2024_y / June / 1},
+                                   date::sys_days{2024_y / June / 3}};
+  auto const serialized = [&](std::vector<std::string> const& feeds,
+                              fs::path const& cache) {
+    auto paths = std::vector<std::pair<std::string, loader_config>>{};
+    for (auto const& f : feeds) {
+      paths.emplace_back(f, loader_config{});
+    }
+    auto tt = load(paths, {}, date_range, nullptr, nullptr, false, cache);
+    return cista::serialize(tt);
+  };
+
+  // Two source configurations importing into the same cache directory keep
+  // each other's checkpoints.
+  auto const a = std::vector<std::string>{feed("T1", "10:00:00")};
+  auto const b =
+      std::vector<std::string>{feed("T2", "10:05:00"), feed("T3", "10:10:00")};
+  serialized(a, cache_dir);
+  auto const cp_a = checkpoints(cache_dir);
+  ASSERT_EQ(1U, cp_a.size());
+  serialized(b, cache_dir);
+  EXPECT_EQ(2U, checkpoints(cache_dir).size());
+  EXPECT_TRUE(fs::exists(cp_a.front()));
+
+  // A change of one configuration only replaces its own checkpoint.
+  auto const changed = std::vector<std::string>{feed("T1", "10:20:00")};
+  EXPECT_EQ(serialized(changed, {}), serialized(changed, cache_dir));
+  EXPECT_FALSE(fs::exists(cp_a.front()));
+  EXPECT_EQ(2U, checkpoints(cache_dir).size());
+  EXPECT_EQ(serialized(b, {}), serialized(b, cache_dir));
+  EXPECT_EQ(2U, checkpoints(cache_dir).size());
+
+  fs::remove_all(cache_dir);
+}
+
+TEST(loader, load_prepared) {
+  auto const date_range = interval{date::sys_days{2024_y / June / 1},
+                                   date::sys_days{2024_y / June / 3}};
+  auto const feeds = std::vector<std::string>{
+      feed("T1", "10:00:00"), feed("T2", "10:05:00"), feed("T3", "10:10:00"),
+      feed("T4", "10:15:00"), feed("T5", "10:20:00"), feed("T6", "10:25:00")};
+
+  // Sequential reference: every source parsed when it is loaded.
+  auto ref = timetable{};
+  ref.date_range_ = date_range;
+  register_special_stations(ref);
+  auto bitfields = hash_map<bitfield, bitfield_idx_t>{};
+  for (auto i = 0U; i != feeds.size(); ++i) {
+    gtfs::load_timetable({}, source_idx_t{i}, mem_dir::read(feeds[i]), ref,
+                         bitfields);
+  }
+  finalize(ref, {});
+
+  // load() prepares upcoming sources in parallel and merges them in order.
+  auto paths = std::vector<std::pair<std::string, loader_config>>{};
+  for (auto const& f : feeds) {
+    paths.emplace_back(f, loader_config{});
+  }
+  auto tt = load(paths, {}, date_range);
+  EXPECT_EQ(cista::serialize(ref), cista::serialize(tt));
+}
@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/routing/raptor/mark_set.h"
+
+using namespace nigiri;
+using namespace nigiri::routing;
+
+namespace {
+
+std::vector<std::uint64_t> collect(mark_set& m) {
+  auto v = std::vector<std::uint64_t>{};
+  m.for_each_set_bit([&](std::uint64_t const i) { v.emplace_back(i); });
+  return v;
+}
+
+}  // namespace
+
+TEST(routing, mark_set_sparse) {
+  auto m = mark_set{};
+  m.resize(1024U);
+
+  m.set(700U);
+  m.set(3U);
+  m.set(700U);
+  m.set(64U);
+
+  EXPECT_FALSE(m.is_dense());
+  EXPECT_TRUE(m[3U]);
+  EXPECT_FALSE(m[4U]);
+  EXPECT_EQ((std::vector<std::uint64_t>{3U, 64U, 700U}), collect(m));
+
+  m.reset();
+  EXPECT_FALSE(m[3U]);
+  EXPECT_TRUE(collect(m).empty());
+}
+
+TEST(routing, mark_set_dense) {
+  auto m = mark_set{};
+  m.resize(256U);
+
+  auto expected = std::vector<std::uint64_t>{};
+  for (auto i = 255U; i > 200U; i -= 10U) {
+    m.set(i);
+    expected.emplace(begin(expected), i);
+  }
+
+  EXPECT_TRUE(m.is_dense());
+  EXPECT_EQ(expected, collect(m));
+
+  m.reset();
+  EXPECT_FALSE(m.is_dense());
+  EXPECT_TRUE(collect(m).empty());
+}
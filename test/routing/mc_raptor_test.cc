@@ -0,0 +1,220 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/routing/mc_raptor_search.h"
+#include "nigiri/routing/raptor_search.h"
+#include "nigiri/timetable.h"
+
+#include "../raptor_search.h"
+
+using namespace date;
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::routing;
+using nigiri::test::parse_time;
+
+namespace {
+
+/*
+ *                 10 min walk
+ *          W  ----------------->  V
+ *   X:  S  ->  W  ->  U      Y:   V  ->  D   (arrival 10:35)
+ *                     |
+ *                 Z:  U  ->  D               (arrival 10:50)
+ */
+mem_dir mc_files() {
+  return mem_dir::read(R"__(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+MTA,MOTIS Transit Authority,https://motis-project.de/,Europe/Berlin
+
+# calendar_dates.txt
+service_id,date,exception_type
+D,20240608,1
+
+# stops.txt
+stop_id,stop_name,stop_desc,stop_lat,stop_lon,stop_url,location_type,parent_station
+S,S,,49.0,8.0,,,,
+W,W,,49.1,8.0,,,,
+V,V,,49.105,8.0,,,,
+U,U,,49.2,8.0,,,,
+D,D,,49.3,8.0,,,,
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+X,MTA,X,X,S -> U,0
+Y,MTA,Y,Y,V -> D,0
+Z,MTA,Z,Z,U -> D,0
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id
+X,D,X1,X1,
+Y,D,Y1,Y1,
+Z,D,Z1,Z1,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+X1,10:00,10:00,S,0,0,0
+X1,10:10,10:10,W,1,0,0
+X1,10:15,10:15,U,2,0,0
+Y1,10:25,10:25,V,0,0,0
+Y1,10:35,10:35,D,1,0,0
+Z1,10:20,10:20,U,0,0,0
+Z1,10:50,10:50,D,1,0,0
+
+# transfers.txt
+from_stop_id,to_stop_id,transfer_type,min_transfer_time
+W,V,2,600
+)__");
+}
+
+}  // namespace
+
+TEST(routing, mc_raptor_walk_time_criterion) {
+  constexpr auto const src = source_idx_t{0U};
+
+  timetable tt;
+  tt.date_range_ = {date::sys_days{2024_y / June / 7},
+                    date::sys_days{2024_y / June / 9}};
+  register_special_stations(tt);
+  gtfs::load_timetable({}, src, mc_files(), tt);
+  finalize(tt);
+
+  auto const q = query{
+      .start_time_ = parse_time("2024-06-08 10:00 Europe/Berlin",
+                                "%Y-%m-%d %H:%M %Z"),
+      .start_ = {{tt.locations_.location_id_to_idx_.at({"S", src}),
+                  0_minutes, 0U}},
+      .destination_ = {{tt.locations_.location_id_to_idx_.at({"D", src}),
+                        0_minutes, 0U}}};
+
+  auto s_state = search_state{};
+  auto mc_state = mc_raptor_state{};
+  auto const mc = mc_raptor_search(tt, s_state, mc_state, q);
+  ASSERT_EQ(2U, mc.journeys_->size());
+
+  auto const arr = [&](std::string_view time) {
+    return parse_time(time, "%Y-%m-%d %H:%M %Z");
+  };
+  auto found_fast = false;
+  auto found_no_walk = false;
+  for (auto const& j : *mc.journeys_) {
+    EXPECT_FALSE(j.error_);
+    EXPECT_EQ(1U, j.transfers_);
+    ASSERT_FALSE(j.legs_.empty());
+    if (j.dest_time_ == arr("2024-06-08 10:35 Europe/Berlin")) {
+      found_fast = true;
+      EXPECT_LT(0_minutes, j.walk_time_);
+      EXPECT_EQ(3U, j.legs_.size());
+      EXPECT_TRUE(std::holds_alternative<footpath>(j.legs_[1].uses_));
+    } else if (j.dest_time_ == arr("2024-06-08 10:50 Europe/Berlin")) {
+      found_no_walk = true;
+      EXPECT_EQ(0_minutes, j.walk_time_);
+    }
+  }
+  EXPECT_TRUE(found_fast);
+  EXPECT_TRUE(found_no_walk);
+
+  // Single-criterion RAPTOR only finds the fast connection.
+  auto r_state = raptor_state{};
+  auto const single = raptor_search(tt, nullptr, s_state, r_state, q,
+                                    direction::kForward);
+  ASSERT_EQ(1U, single.journeys_->size());
+  EXPECT_EQ(arr("2024-06-08 10:35 Europe/Berlin"),
+            single.journeys_->begin()->dest_time_);
+}
+
+TEST(routing, mc_raptor_walk_time_start_offset) {
+  constexpr auto const src = source_idx_t{0U};
+
+  timetable tt;
+  tt.date_range_ = {date::sys_days{2024_y / June / 7},
+                    date::sys_days{2024_y / June / 9}};
+  register_special_stations(tt);
+  gtfs::load_timetable({}, src, mc_files(), tt);
+  finalize(tt);
+
+  // 5 minutes to reach S: counted as walking time of every journey.
+  auto const q = query{
+      .start_time_ = parse_time("2024-06-08 09:55 Europe/Berlin",
+                                "%Y-%m-%d %H:%M %Z"),
+      .start_ = {{tt.locations_.location_id_to_idx_.at({"S", src}),
+                  5_minutes, 0U}},
+      .destination_ = {{tt.locations_.location_id_to_idx_.at({"D", src}),
+                        0_minutes, 0U}}};
+
+  auto s_state = search_state{};
+  auto mc_state = mc_raptor_state{};
+  auto const mc = mc_raptor_search(tt, s_state, mc_state, q);
+  ASSERT_EQ(2U, mc.journeys_->size());
+
+  auto const slow = parse_time("2024-06-08 10:50 Europe/Berlin",
+                               "%Y-%m-%d %H:%M %Z");
+  for (auto const& j : *mc.journeys_) {
+    EXPECT_FALSE(j.error_);
+    if (j.dest_time_ == slow) {
+      EXPECT_EQ(5_minutes, j.walk_time_);
+    } else {
+      EXPECT_LT(5_minutes, j.walk_time_);
+    }
+  }
+}
+
+TEST(routing, mc_raptor_intermodal_start_footpath) {
+  constexpr auto const src = source_idx_t{0U};
+
+  timetable tt;
+  tt.date_range_ = {date::sys_days{2024_y / June / 7},
+                    date::sys_days{2024_y / June / 9}};
+  register_special_stations(tt);
+  gtfs::load_timetable({}, src, mc_files(), tt);
+  finalize(tt);
+
+  auto const w = tt.locations_.location_id_to_idx_.at({"W", src});
+  auto const v = tt.locations_.location_id_to_idx_.at({"V", src});
+
+  // 5 minutes to W, then either X1 at W or the footpath to V and Y1.
+  auto const q = query{
+      .start_time_ = parse_time("2024-06-08 10:00 Europe/Berlin",
+                                "%Y-%m-%d %H:%M %Z"),
+      .start_match_mode_ = location_match_mode::kIntermodal,
+      .use_start_footpaths_ = true,
+      .start_ = {{w, 5_minutes, 0U}},
+      .destination_ = {{tt.locations_.location_id_to_idx_.at({"D", src}),
+                        0_minutes, 0U}}};
+
+  auto s_state = search_state{};
+  auto mc_state = mc_raptor_state{};
+  auto const mc = mc_raptor_search(tt, s_state, mc_state, q);
+  ASSERT_EQ(2U, mc.journeys_->size());
+
+  auto const time = [&](std::string_view t) {
+    return parse_time(t, "%Y-%m-%d %H:%M %Z");
+  };
+  for (auto const& j : *mc.journeys_) {
+    EXPECT_FALSE(j.error_);
+    ASSERT_FALSE(j.legs_.empty());
+    auto const& first = j.legs_.front();
+    ASSERT_TRUE(std::holds_alternative<offset>(first.uses_));
+    EXPECT_EQ(w, std::get<offset>(first.uses_).target());
+    EXPECT_EQ(time("2024-06-08 10:00 Europe/Berlin"), first.dep_time_);
+    EXPECT_EQ(time("2024-06-08 10:05 Europe/Berlin"), first.arr_time_);
+
+    if (j.dest_time_ == time("2024-06-08 10:35 Europe/Berlin")) {
+      // Offset to W, footpath W -> V, Y1.
+      EXPECT_EQ(15_minutes, j.walk_time_);
+      ASSERT_EQ(3U, j.legs_.size());
+      EXPECT_EQ(w, j.legs_[0].to_);
+      ASSERT_TRUE(std::holds_alternative<footpath>(j.legs_[1].uses_));
+      EXPECT_EQ(w, j.legs_[1].from_);
+      EXPECT_EQ(v, j.legs_[1].to_);
+      EXPECT_EQ(time("2024-06-08 10:15 Europe/Berlin"), j.legs_[1].arr_time_);
+    } else {
+      // Offset to W, X1, Z1.
+      EXPECT_EQ(time("2024-06-08 10:50 Europe/Berlin"), j.dest_time_);
+      EXPECT_EQ(5_minutes, j.walk_time_);
+    }
+  }
+}
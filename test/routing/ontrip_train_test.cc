@@ -1,9 +1,13 @@
 #include "gtest/gtest.h"
 
+#include "utl/helpers/algorithm.h"
+
 #include "nigiri/loader/hrd/load_timetable.h"
 #include "nigiri/loader/init_finish.h"
 #include "nigiri/lookup/get_transport.h"
 #include "nigiri/routing/ontrip_train.h"
+#include "nigiri/routing/raptor/raptor_state.h"
+#include "nigiri/routing/search.h"
 #include "nigiri/timetable.h"
 
 #include "../loader/hrd/hrd_timetable.h"
@@ -51,3 +55,53 @@ TEST(routing, ontrip_train) {
   }
   std::cout << "results: " << results.size() << "\n";
 }
+
+TEST(routing, ontrip_train_batch) {
+  using namespace date;
+  timetable tt;
+  tt.date_range_ = full_period();
+  constexpr auto const src = source_idx_t{0U};
+  load_timetable(src, loader::hrd::hrd_5_20_26, files(), tt);
+  finalize(tt);
+
+  auto const t = get_ref_transport(
+      tt, {"3374/0000008/1350/0000006/2950/", source_idx_t{0}},
+      March / 29 / 2020, false);
+  ASSERT_TRUE(t.has_value());
+
+  auto const q = routing::query{
+      .start_time_ = {},
+      .start_match_mode_ = nigiri::routing::location_match_mode::kIntermodal,
+      .dest_match_mode_ = nigiri::routing::location_match_mode::kIntermodal,
+      .start_ = {},
+      .destination_ = {{tt.locations_.location_id_to_idx_.at(
+                            {.id_ = "0000004", .src_ = src}),
+                        10_minutes, 77U}},
+      .via_stops_ = {}};
+
+  auto s_state = search_state{};
+  auto r_state = raptor_state{};
+  auto const batch =
+      ontrip_train_search(tt, nullptr, s_state, r_state, t->first, 1U, q);
+
+  auto const n_stops =
+      tt.route_location_seq_[tt.transport_route_[t->first.t_idx_]].size();
+  ASSERT_EQ(n_stops - 1U, batch.size());
+
+  auto const to_tuples = [](pareto_set<journey> const& journeys) {
+    auto x = std::vector<std::tuple<unixtime_t, unixtime_t, std::uint8_t>>{};
+    for (auto const& j : journeys) {
+      x.emplace_back(j.start_time_, j.dest_time_, j.transfers_);
+    }
+    utl::sort(x);
+    return x;
+  };
+
+  for (auto const& r : batch) {
+    auto single_q = q;
+    generate_ontrip_train_query(tt, t->first, r.stop_idx_, single_q);
+    auto const single = raptor_search(tt, nullptr, std::move(single_q));
+    EXPECT_EQ(to_tuples(single), to_tuples(r.journeys_))
+        << "stop_idx=" << r.stop_idx_;
+  }
+}
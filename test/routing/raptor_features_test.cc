@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/routing/raptor_search.h"
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/rt/rt_timetable.h"
+#include "nigiri/timetable.h"
+
+#include "../raptor_search.h"
+#include "../rt/util.h"
+
+using namespace nigiri;
+using namespace nigiri::routing;
+using namespace date;
+using namespace std::chrono_literals;
+using namespace std::string_view_literals;
+
+namespace {
+
+// T1: A 10:00 -> B 10:10
+// T2: B 10:13 -> C 10:22
+// T3: B 10:20 -> C 10:30
+constexpr auto const test_files = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_desc,stop_lat,stop_lon,stop_url,location_type,parent_station
+A,A,,0.0,1.0,,
+B,B,,2.0,3.0,,
+C,C,,4.0,5.0,,
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+R1,DB,1,,,3
+R2,DB,2,,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id
+R1,S1,T1,,
+R2,S1,T2,,
+R2,S1,T3,,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+T1,10:00:00,10:00:00,A,0
+T1,10:10:00,10:10:00,B,1
+T2,10:13:00,10:13:00,B,0
+T2,10:22:00,10:22:00,C,1
+T3,10:20:00,10:20:00,B,0
+T3,10:30:00,10:30:00,C,1
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+)"sv;
+
+std::string to_str(pareto_set<journey> const& results,
+                   timetable const& tt,
+                   rt_timetable const* rtt) {
+  std::stringstream ss;
+  for (auto const& j : results) {
+    j.print(ss, tt, rtt);
+    ss << "\n";
+  }
+  return ss.str();
+}
+
+template <direction SearchDir, raptor_features Features>
+std::string search_with(timetable const& tt,
+                        rt_timetable const* rtt,
+                        query q) {
+  auto s_state = search_state{};
+  auto r_state = raptor_state{};
+  auto const result =
+      rtt == nullptr
+          ? search<SearchDir, raptor<SearchDir, false, 0, Features>>{
+                tt, rtt, s_state, r_state, std::move(q)}
+                .execute()
+          : search<SearchDir, raptor<SearchDir, true, 0, Features>>{
+                tt, rtt, s_state, r_state, std::move(q)}
+                .execute();
+  return to_str(*result.journeys_, tt, rtt);
+}
+
+// Both specializations and raptor_search() on the same query.
+template <direction SearchDir>
+void check(timetable const& tt,
+           rt_timetable const* rtt,
+           query const& q,
+           bool const expect_feature_free) {
+  auto const no_features =
+      search_with<SearchDir, kNoRaptorFeatures>(tt, rtt, q);
+  auto const all_features =
+      search_with<SearchDir, kAllRaptorFeatures>(tt, rtt, q);
+  auto const dispatched =
+      to_str(test::raptor_search(tt, rtt, q, SearchDir), tt, rtt);
+
+  EXPECT_EQ(expect_feature_free, is_raptor_feature_free(q, rtt != nullptr));
+  EXPECT_FALSE(all_features.empty());
+  EXPECT_EQ(all_features, dispatched);
+  if (expect_feature_free) {
+    EXPECT_EQ(no_features, all_features);
+  } else {
+    // The specialization ignores the feature: it must not be used.
+    EXPECT_NE(no_features, all_features);
+  }
+}
+
+}  // namespace
+
+TEST(routing, raptor_features_equivalence) {
+  auto tt = timetable{};
+  tt.date_range_ = {date::sys_days{2019_y / May / 1},
+                    date::sys_days{2019_y / May / 2}};
+  loader::register_special_stations(tt);
+  loader::gtfs::load_timetable({}, source_idx_t{0},
+                               loader::mem_dir::read(test_files), tt);
+  loader::finalize(tt);
+
+  auto const a = tt.locations_.location_id_to_idx_.at({"A", source_idx_t{0}});
+  auto const c = tt.locations_.location_id_to_idx_.at({"C", source_idx_t{0}});
+  auto const make_query = [&](direction const dir,
+                              transfer_time_settings const tts) {
+    auto const from = dir == direction::kForward ? a : c;
+    auto const to = dir == direction::kForward ? c : a;
+    return query{.start_time_ = interval<unixtime_t>{tt.date_range_.from_,
+                                                     tt.date_range_.to_},
+                 .start_ = {{from, 0_minutes, 0U}},
+                 .destination_ = {{to, 0_minutes, 0U}},
+                 .transfer_time_settings_ = tts};
+  };
+
+  // T1 arrives 2 minutes late: the transfer to T2 breaks.
+  auto rtt = rt::create_rt_timetable(tt, date::sys_days{2019_y / May / 1});
+  rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg({{.trip_id_ = "T1",
+                          .delays_ = {{.seq_ = 1U,
+                                       .ev_type_ = event_type::kArr,
+                                       .delay_minutes_ = 2}}}},
+                        date::sys_days{2019_y / May / 1} + 7h));
+
+  auto const min_10 = transfer_time_settings{
+      .default_ = false, .min_transfer_time_ = duration_t{10}};
+  for (auto const* r : {static_cast<rt_timetable const*>(nullptr),
+                        static_cast<rt_timetable const*>(&rtt)}) {
+    // Static and real-time, default transfer times: both specializations.
+    check<direction::kForward>(tt, r, make_query(direction::kForward, {}),
+                               true);
+    check<direction::kBackward>(tt, r, make_query(direction::kBackward, {}),
+                                true);
+  }
+
+  // Non-default transfer time: generic path only (T2 is not reachable).
+  check<direction::kForward>(tt, nullptr,
+                             make_query(direction::kForward, min_10), false);
+  check<direction::kBackward>(tt, nullptr,
+                              make_query(direction::kBackward, min_10), false);
+}
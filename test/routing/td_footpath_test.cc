@@ -232,20 +232,24 @@ TEST(routing, td_footpath) {
 
   // Switch to real-time footpaths but don't add any footpaths.
   // Represents "elevator broken forever".
-  rtt.has_td_footpaths_in_[kProfile].set(B1, true);
-  rtt.has_td_footpaths_in_[kProfile].set(B2, true);
-  rtt.has_td_footpaths_out_[kProfile].set(B1, true);
-  rtt.has_td_footpaths_out_[kProfile].set(B2, true);
-  rtt.td_footpaths_out_[kProfile].resize(tt.n_locations());
-  rtt.td_footpaths_in_[kProfile].resize(tt.n_locations());
+  rtt.set_td_footpaths_out(tt, kProfile, B1, {});
+  rtt.set_td_footpaths_out(tt, kProfile, B2, {});
+  EXPECT_TRUE(rtt.has_td_footpaths_in_[kProfile].test(B1));
+  EXPECT_TRUE(rtt.has_td_footpaths_in_[kProfile].test(B2));
 
   EXPECT_EQ(kElevatorOutOfOrder, to_string(tt, run_search()));
 
   // Add elevator available beginning with 11:25 with 10min footpath length.
-  rtt.td_footpaths_out_[kProfile][B1].push_back(td_footpath{
-      B2, unixtime_t{sys_days{2024_y / June / 19} + 9h + 25min}, 10min});
-  rtt.td_footpaths_in_[kProfile][B2].push_back(td_footpath{
-      B1, unixtime_t{sys_days{2024_y / June / 19} + 9h + 25min}, 10min});
+  auto const fp = td_footpath{
+      B2, unixtime_t{sys_days{2024_y / June / 19} + 9h + 25min}, 10min};
+  rtt.set_td_footpaths_out(tt, kProfile, B1, {&fp, 1U});
+  ASSERT_EQ(1U, rtt.td_footpaths_in_[kProfile][B2].size());
+  EXPECT_EQ(B1, rtt.td_footpaths_in_[kProfile][B2][0].target_);
 
   EXPECT_EQ(kElevatorStartsWorkingAt1125, to_string(tt, run_search()));
+
+  // Back to the static footpaths of B1.
+  rtt.reset_td_footpaths_out(tt, kProfile, B1);
+  rtt.reset_td_footpaths_out(tt, kProfile, B2);
+  EXPECT_EQ(kEverythingWorks, to_string(tt, run_search()));
 }
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "gtest/gtest.h"
+
+#include <array>
+
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/rt/compact.h"
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/gtfsrt_resolve_run.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/timetable.h"
+
+#include "./util.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::gtfs;
+using namespace date;
+using namespace std::chrono_literals;
+
+namespace {
+
+mem_dir compact_files() {
+  return mem_dir::read(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+AG,Agency,https://agency.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+A,A,1.0,1.0
+B,B,2.0,2.0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S,20231126,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R,AG,R,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+R,S,T1,B
+R,S,T2,B
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+T1,10:00:00,10:00:00,A,1
+T1,10:30:00,10:30:00,B,2
+T2,12:00:00,12:00:00,A,1
+T2,12:30:00,12:30:00,B,2
+)");
+}
+
+constexpr auto const kBaseDay = date::sys_days{2023_y / November / 26};
+
+rt::run resolve(timetable const& tt,
+                rt_timetable const& rtt,
+                std::string const& trip_id) {
+  auto td = transit_realtime::TripDescriptor{};
+  td.set_trip_id(trip_id);
+  return rt::gtfsrt_resolve_run(kBaseDay, tt, &rtt, source_idx_t{0}, td)
+      .first;
+}
+
+}  // namespace
+
+TEST(rt, compact) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, compact_files(), tt);
+  finalize(tt);
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+  rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg(
+          {{.trip_id_ = "T1",
+            .delays_ = {{.seq_ = 1U, .ev_type_ = event_type::kDep,
+                         .delay_minutes_ = 5}}},
+           {.trip_id_ = "T2",
+            .delays_ = {{.seq_ = 1U, .ev_type_ = event_type::kDep,
+                         .delay_minutes_ = 10}}}},
+          kBaseDay + 9h));
+  ASSERT_EQ(2U, rtt.n_rt_transports());
+
+  // Nothing expired, yet.
+  auto stats = rt::compact(tt, rtt, kBaseDay + 9h);
+  EXPECT_EQ(0U, stats.removed_transports_);
+  EXPECT_EQ(2U, rtt.n_rt_transports());
+
+  // T1 arrived at 10:35 local time (09:35 UTC).
+  stats = rt::compact(tt, rtt, kBaseDay + 10h);
+  EXPECT_EQ(1U, stats.removed_transports_);
+  EXPECT_EQ(1U, stats.remaining_transports_);
+  EXPECT_GT(stats.bytes_reclaimed_, 0U);
+  ASSERT_EQ(1U, rtt.n_rt_transports());
+
+  EXPECT_FALSE(resolve(tt, rtt, "T1").is_rt());
+
+  auto const t2 = resolve(tt, rtt, "T2");
+  ASSERT_TRUE(t2.is_rt());
+  EXPECT_EQ(rt_transport_idx_t{0U}, t2.rt_);
+  EXPECT_EQ(10_minutes,
+            rtt.unix_event_time(t2.rt_, 0U, event_type::kDep) -
+                tt.event_time(t2.t_, 0U, event_type::kDep));
+
+  auto const a = tt.locations_.location_id_to_idx_.at({"A", source_idx_t{0}});
+  ASSERT_EQ(1U, rtt.location_rt_transports_[a].size());
+  EXPECT_EQ(rt_transport_idx_t{0U}, rtt.location_rt_transports_[a][0]);
+  EXPECT_TRUE(rtt.has_rt_routes());
+  EXPECT_EQ(1U, rtt.n_rt_routes());
+}
+
+TEST(rt, compact_additional_trips) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, compact_files(), tt);
+  finalize(tt);
+
+  auto const a = tt.locations_.location_id_to_idx_.at({"A", source_idx_t{0}});
+  auto const b = tt.locations_.location_id_to_idx_.at({"B", source_idx_t{0}});
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+  auto const add = [&](std::string_view trip_id, unixtime_t const dep) {
+    auto const stop_seq = std::array{stop{a, true, true, true, true}.value(),
+                                     stop{b, true, true, true, true}.value()};
+    auto const times = std::array{rtt.unix_to_delta(dep),
+                                  rtt.unix_to_delta(dep + 20min)};
+    return rtt.add_additional_rt_transport(source_idx_t{0}, trip_id, stop_seq,
+                                           times, clasz::kBus);
+  };
+  add("X1", kBaseDay + 8h);
+  add("X2", kBaseDay + 13h);
+
+  auto msg = test::to_feed_msg(
+      {{.trip_id_ = "X2", .delays_ = {}},
+       {.trip_id_ = "T2",
+        .delays_ = {{.seq_ = 1U, .ev_type_ = event_type::kDep,
+                     .delay_minutes_ = 10}}}},
+      kBaseDay + 9h);
+  msg.mutable_entity(0)
+      ->mutable_trip_update()
+      ->mutable_trip()
+      ->set_schedule_relationship(
+          transit_realtime::TripDescriptor_ScheduleRelationship_ADDED);
+  rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "", msg);
+
+  // Single stop: no events at all.
+  auto single_stop = std::array{stop{a, true, true, true, true}.value()};
+  rtt.add_rt_transport(source_idx_t{0}, tt, resolve(tt, rtt, "T1").t_,
+                       single_stop);
+  ASSERT_EQ(4U, rtt.n_rt_transports());
+
+  auto stats = rt::compact(tt, rtt, kBaseDay + 10h);
+  EXPECT_EQ(2U, stats.removed_transports_);
+  ASSERT_EQ(2U, rtt.n_rt_transports());
+  EXPECT_FALSE(resolve(tt, rtt, "T1").is_rt());
+  EXPECT_EQ(rt_transport_idx_t::invalid(),
+            rtt.resolve_additional(source_idx_t{0}, "X1"));
+
+  // Trip IDs of removed additional trips are dropped.
+  auto const x2 = rtt.resolve_additional(source_idx_t{0}, "X2");
+  ASSERT_EQ(rt_transport_idx_t{0U}, x2);
+  ASSERT_EQ(1U, rtt.trip_id_strings_.size());
+  EXPECT_EQ("X2", rtt.trip_id_strings_[rtt.rt_transport_static_transport_[x2]
+                                           .as<rt_add_trip_id_idx_t>()]
+                      .view());
+
+  // Updated transports of the source were renumbered as well: X2 is
+  // reverted by the next full dataset, T2 is kept.
+  auto const gtfsrt_stats = rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg(
+          {{.trip_id_ = "T2",
+            .delays_ = {{.seq_ = 1U, .ev_type_ = event_type::kDep,
+                         .delay_minutes_ = 10}}}},
+          kBaseDay + 9h + 1min));
+  EXPECT_EQ(1, gtfsrt_stats.reverted_);
+  EXPECT_EQ(rt_transport_idx_t::invalid(),
+            rtt.resolve_additional(source_idx_t{0}, "X2"));
+  EXPECT_TRUE(rtt.rt_transport_is_cancelled_.test(to_idx(x2)));
+  EXPECT_EQ(rt_transport_idx_t{1U}, resolve(tt, rtt, "T2").rt_);
+}
@@ -0,0 +1,112 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/frun.h"
+#include "nigiri/rt/gtfsrt_resolve_run.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/timetable.h"
+
+#include "./util.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::gtfs;
+using namespace date;
+using namespace std::chrono_literals;
+
+namespace {
+
+mem_dir frun_files() {
+  return mem_dir::read(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+AG,Agency,https://agency.com,Etc/UTC
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+A,A,1.0,1.0
+B,B,2.0,2.0
+C,C,3.0,3.0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S,20231126,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R,AG,R,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+R,S,T1,C
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+T1,10:00:00,10:00:00,A,1
+T1,10:30:00,10:30:00,B,2
+T1,11:00:00,11:00:00,C,3
+)");
+}
+
+constexpr auto const kBaseDay = date::sys_days{2023_y / November / 26};
+
+}  // namespace
+
+TEST(rt, frun_bulk_times) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, frun_files(), tt);
+  finalize(tt);
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+  rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg({{.trip_id_ = "T1",
+                          .delays_ = {{.seq_ = 2U,
+                                       .ev_type_ = event_type::kArr,
+                                       .delay_minutes_ = 5}}}},
+                        kBaseDay + 9h));
+
+  auto td = transit_realtime::TripDescriptor{};
+  td.set_trip_id("T1");
+  auto const [r, _] =
+      rt::gtfsrt_resolve_run(kBaseDay, tt, &rtt, source_idx_t{0}, td);
+  ASSERT_TRUE(r.is_rt());
+
+  auto const fr = rt::frun{tt, &rtt, r};
+  auto scheduled = std::vector<unixtime_t>{};
+  auto times = std::vector<unixtime_t>{};
+  fr.scheduled_times(scheduled);
+  fr.times(times);
+  ASSERT_EQ(4U, scheduled.size());
+  ASSERT_EQ(4U, times.size());
+  EXPECT_EQ(4U, fr.rt_times().size());
+
+  for (auto const rs : fr) {
+    for (auto const ev_type : {event_type::kArr, event_type::kDep}) {
+      if ((ev_type == event_type::kArr && rs.stop_idx_ == 0U) ||
+          (ev_type == event_type::kDep && rs.stop_idx_ == fr.size() - 1U)) {
+        continue;
+      }
+      auto const ev_idx = static_cast<unsigned>(
+          rs.stop_idx_ * 2 - (ev_type == event_type::kArr ? 1 : 0));
+      EXPECT_EQ(tt.event_time(fr.t_, rs.stop_idx_, ev_type),
+                rs.scheduled_time(ev_type));
+      EXPECT_EQ(rs.scheduled_time(ev_type), scheduled[ev_idx]);
+      EXPECT_EQ(rs.time(ev_type), times[ev_idx]);
+    }
+  }
+  EXPECT_EQ(kBaseDay + 10h + 35min, times[1]);
+  EXPECT_EQ(kBaseDay + 10h + 30min, scheduled[1]);
+
+  // Without rt timetable: static times only.
+  auto const static_fr = rt::frun{tt, nullptr, r};
+  static_fr.times(times);
+  EXPECT_EQ(scheduled, times);
+  EXPECT_TRUE(static_fr.rt_times().empty());
+}
@@ -0,0 +1,255 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/gtfsrt_resolve_run.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/timetable.h"
+
+#include "./util.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::gtfs;
+using namespace date;
+using namespace std::chrono_literals;
+
+namespace {
+
+mem_dir delay_profile_files() {
+  return mem_dir::read(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+AG,Agency,https://agency.com,Etc/UTC
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+A,A,1.0,1.0
+B,B,2.0,2.0
+C,C,3.0,3.0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S,20231126,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R,AG,R,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+R,S,T1,C
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+T1,10:00:00,10:00:00,A,1
+T1,10:30:00,10:30:00,B,2
+T1,11:00:00,11:00:00,C,3
+)");
+}
+
+// T1 and T2 are joined into one transport A-B-C (same block), so the run of
+// T2 starts at stop index 1.
+mem_dir block_files() {
+  return mem_dir::read(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+AG,Agency,https://agency.com,Etc/UTC
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+A,A,1.0,1.0
+B,B,2.0,2.0
+C,C,3.0,3.0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S,20231126,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R,AG,R,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id
+R,S,T1,B,1
+R,S,T2,C,1
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+T1,10:00:00,10:00:00,A,1
+T1,10:30:00,10:30:00,B,2
+T2,10:35:00,10:35:00,B,1
+T2,11:00:00,11:00:00,C,2
+)");
+}
+
+constexpr auto const kBaseDay = date::sys_days{2023_y / November / 26};
+
+}  // namespace
+
+TEST(rt, gtfs_rt_delay_profile) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, delay_profile_files(), tt);
+  finalize(tt);
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+  rtt.set_change_log_enabled(true);
+
+  // The early arrival at C must not be before the propagated departure at B.
+  rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg(
+          {{.trip_id_ = "T1",
+            .delays_ = {{.seq_ = 1U,
+                         .ev_type_ = event_type::kDep,
+                         .delay_minutes_ = 40},
+                        {.seq_ = 3U,
+                         .ev_type_ = event_type::kArr,
+                         .delay_minutes_ = -20}}}},
+          kBaseDay + 9h));
+
+  auto td = transit_realtime::TripDescriptor{};
+  td.set_trip_id("T1");
+  auto const [r, _] =
+      rt::gtfsrt_resolve_run(kBaseDay, tt, &rtt, source_idx_t{0}, td);
+  ASSERT_TRUE(r.is_rt());
+
+  EXPECT_EQ(kBaseDay + 10h + 40min,
+            rtt.unix_event_time(r.rt_, 0U, event_type::kDep));
+  EXPECT_EQ(kBaseDay + 11h + 10min,
+            rtt.unix_event_time(r.rt_, 1U, event_type::kArr));
+  EXPECT_EQ(kBaseDay + 11h + 10min,
+            rtt.unix_event_time(r.rt_, 1U, event_type::kDep));
+  EXPECT_EQ(kBaseDay + 11h + 10min,
+            rtt.unix_event_time(r.rt_, 2U, event_type::kArr));
+
+  // Changes are reported with the delays of the message.
+  auto const changes = rtt.get_changes();
+  ASSERT_EQ(4U, changes.size());
+  EXPECT_EQ(0U, changes[0].stop_idx_);
+  EXPECT_EQ(event_type::kDep, changes[0].ev_type_);
+  EXPECT_EQ(40_minutes, changes[0].delay_);
+  EXPECT_EQ(1U, changes[1].stop_idx_);
+  EXPECT_EQ(event_type::kArr, changes[1].ev_type_);
+  EXPECT_EQ(40_minutes, changes[1].delay_);
+  EXPECT_EQ(1U, changes[2].stop_idx_);
+  EXPECT_EQ(event_type::kDep, changes[2].ev_type_);
+  EXPECT_EQ(40_minutes, changes[2].delay_);
+  EXPECT_EQ(2U, changes[3].stop_idx_);
+  EXPECT_EQ(event_type::kArr, changes[3].ev_type_);
+  EXPECT_EQ(-20_minutes, changes[3].delay_);
+}
+
+TEST(rt, gtfs_rt_delay_profile_time) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, delay_profile_files(), tt);
+  finalize(tt);
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+  rtt.set_change_log_enabled(true);
+
+  // Absolute arrival time at B, propagated as delay to the following events.
+  auto msg = test::to_feed_msg(
+      {{.trip_id_ = "T1",
+        .delays_ = {{.seq_ = 2U, .ev_type_ = event_type::kArr}}}},
+      kBaseDay + 9h);
+  auto* const arr = msg.mutable_entity(0)
+                        ->mutable_trip_update()
+                        ->mutable_stop_time_update(0)
+                        ->mutable_arrival();
+  arr->clear_delay();
+  arr->set_time(static_cast<std::int64_t>(
+      test::to_unix(kBaseDay + 10h + 45min)));
+  rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "", msg);
+
+  auto td = transit_realtime::TripDescriptor{};
+  td.set_trip_id("T1");
+  auto const [r, _] =
+      rt::gtfsrt_resolve_run(kBaseDay, tt, &rtt, source_idx_t{0}, td);
+  ASSERT_TRUE(r.is_rt());
+
+  EXPECT_EQ(kBaseDay + 10h, rtt.unix_event_time(r.rt_, 0U, event_type::kDep));
+  EXPECT_EQ(kBaseDay + 10h + 45min,
+            rtt.unix_event_time(r.rt_, 1U, event_type::kArr));
+  EXPECT_EQ(kBaseDay + 10h + 45min,
+            rtt.unix_event_time(r.rt_, 1U, event_type::kDep));
+  EXPECT_EQ(kBaseDay + 11h + 15min,
+            rtt.unix_event_time(r.rt_, 2U, event_type::kArr));
+
+  auto const changes = rtt.get_changes();
+  ASSERT_EQ(3U, changes.size());
+  EXPECT_EQ(1U, changes[0].stop_idx_);
+  EXPECT_EQ(event_type::kArr, changes[0].ev_type_);
+  EXPECT_EQ(15_minutes, changes[0].delay_);
+  EXPECT_EQ(15_minutes, changes[2].delay_);
+
+  // A second update of the existing RT transport has to reach the RT routes.
+  rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg({{.trip_id_ = "T1",
+                          .delays_ = {{.seq_ = 2U,
+                                       .ev_type_ = event_type::kArr,
+                                       .delay_minutes_ = 5}}}},
+                        kBaseDay + 9h + 1min));
+  ASSERT_TRUE(rtt.has_rt_routes());
+  ASSERT_EQ(1U, rtt.n_rt_routes());
+  EXPECT_EQ(rtt.event_time(r.rt_, 2U, event_type::kArr),
+            rtt.rt_route_event_times(rt_route_idx_t{0U}, 2U,
+                                     event_type::kArr)[0]);
+  EXPECT_EQ(kBaseDay + 11h + 5min,
+            rtt.unix_event_time(r.rt_, 2U, event_type::kArr));
+}
+
+TEST(rt, gtfs_rt_delay_profile_run_in_block) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, block_files(), tt);
+  finalize(tt);
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+  rtt.set_change_log_enabled(true);
+
+  rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg({{.trip_id_ = "T2",
+                          .delays_ = {{.seq_ = 1U,
+                                       .ev_type_ = event_type::kDep,
+                                       .delay_minutes_ = 5}}}},
+                        kBaseDay + 9h));
+
+  auto td = transit_realtime::TripDescriptor{};
+  td.set_trip_id("T2");
+  auto const [r, _] =
+      rt::gtfsrt_resolve_run(kBaseDay, tt, &rtt, source_idx_t{0}, td);
+  ASSERT_TRUE(r.is_rt());
+  ASSERT_EQ(1U, r.stop_range_.from_);
+
+  // Events before the run keep their times.
+  EXPECT_EQ(kBaseDay + 10h, rtt.unix_event_time(r.rt_, 0U, event_type::kDep));
+  EXPECT_EQ(kBaseDay + 10h + 30min,
+            rtt.unix_event_time(r.rt_, 1U, event_type::kArr));
+  EXPECT_EQ(kBaseDay + 10h + 40min,
+            rtt.unix_event_time(r.rt_, 1U, event_type::kDep));
+  EXPECT_EQ(kBaseDay + 11h + 5min,
+            rtt.unix_event_time(r.rt_, 2U, event_type::kArr));
+
+  auto const changes = rtt.get_changes();
+  ASSERT_EQ(2U, changes.size());
+  EXPECT_EQ(1U, changes[0].stop_idx_);
+  EXPECT_EQ(event_type::kDep, changes[0].ev_type_);
+  EXPECT_EQ(5_minutes, changes[0].delay_);
+  EXPECT_EQ(2U, changes[1].stop_idx_);
+  EXPECT_EQ(event_type::kArr, changes[1].ev_type_);
+  EXPECT_EQ(5_minutes, changes[1].delay_);
+}
@@ -0,0 +1,395 @@
+#include "gtest/gtest.h"
+
+#include <array>
+#include <vector>
+
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/gtfsrt_resolve_run.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/timetable.h"
+
+#include "./util.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::gtfs;
+using namespace date;
+using namespace std::chrono_literals;
+
+namespace {
+
+mem_dir differential_files() {
+  return mem_dir::read(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+AG,Agency,https://agency.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+A,A,1.0,1.0
+B,B,2.0,2.0
+C,C,3.0,3.0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S,20231126,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R,AG,R,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+R,S,T1,B
+R,S,T2,B
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+T1,10:00:00,10:00:00,A,1
+T1,10:30:00,10:30:00,B,2
+T2,10:10:00,10:10:00,A,1
+T2,10:40:00,10:40:00,B,2
+)");
+}
+
+constexpr auto const kBaseDay = date::sys_days{2023_y / November / 26};
+
+test::trip delayed(std::string trip_id) {
+  return {.trip_id_ = std::move(trip_id),
+          .delays_ = {{.seq_ = 1U,
+                       .ev_type_ = event_type::kDep,
+                       .delay_minutes_ = 5}}};
+}
+
+duration_t dep_delay(timetable const& tt,
+                     rt_timetable const& rtt,
+                     std::string const& trip_id) {
+  auto td = transit_realtime::TripDescriptor{};
+  td.set_trip_id(trip_id);
+  auto const [r, _] =
+      rt::gtfsrt_resolve_run(kBaseDay, tt, &rtt, source_idx_t{0}, td);
+  if (!r.is_rt()) {
+    return 0_minutes;
+  }
+  return rtt.unix_event_time(r.rt_, 0U, event_type::kDep) -
+         tt.event_time(r.t_, 0U, event_type::kDep);
+}
+
+bool contains(rt_timetable const& rtt,
+              location_idx_t const l,
+              rt_transport_idx_t const rt_t) {
+  auto const transports = rtt.location_rt_transports_[l];
+  return std::find(transports.begin(), transports.end(), rt_t) !=
+         transports.end();
+}
+
+}  // namespace
+
+TEST(rt, gtfs_rt_full_dataset_reverts_stale_updates) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, differential_files(), tt);
+  finalize(tt);
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+
+  auto stats = rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg({delayed("T1"), delayed("T2")}, kBaseDay + 9h));
+  EXPECT_EQ(0, stats.reverted_);
+  EXPECT_EQ(5_minutes, dep_delay(tt, rtt, "T1"));
+  EXPECT_EQ(5_minutes, dep_delay(tt, rtt, "T2"));
+
+  // T1 is missing in the next full dataset: back to the static schedule.
+  stats = rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "",
+                                test::to_feed_msg({delayed("T2")},
+                                                  kBaseDay + 9h + 1min));
+  EXPECT_EQ(1, stats.reverted_);
+  EXPECT_EQ(0_minutes, dep_delay(tt, rtt, "T1"));
+  EXPECT_EQ(5_minutes, dep_delay(tt, rtt, "T2"));
+  EXPECT_EQ(2U, rtt.n_rt_transports());
+}
+
+TEST(rt, gtfs_rt_differential) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, differential_files(), tt);
+  finalize(tt);
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+
+  auto const differential = [](std::vector<test::trip> const& trips,
+                               date::sys_seconds const t) {
+    auto msg = test::to_feed_msg(trips, t);
+    msg.mutable_header()->set_incrementality(
+        transit_realtime::FeedHeader_Incrementality_DIFFERENTIAL);
+    return msg;
+  };
+
+  rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "",
+                        differential({delayed("T1")}, kBaseDay + 9h));
+  rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "",
+                        differential({delayed("T2")}, kBaseDay + 9h + 1min));
+  EXPECT_EQ(5_minutes, dep_delay(tt, rtt, "T1"));
+  EXPECT_EQ(5_minutes, dep_delay(tt, rtt, "T2"));
+
+  // Deleted entity: revert T1 only.
+  auto del = differential({{.trip_id_ = "T1", .delays_ = {}}},
+                          kBaseDay + 9h + 2min);
+  del.mutable_entity(0)->set_is_deleted(true);
+  auto const stats =
+      rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "", del);
+  EXPECT_EQ(1, stats.reverted_);
+  EXPECT_EQ(0_minutes, dep_delay(tt, rtt, "T1"));
+  EXPECT_EQ(5_minutes, dep_delay(tt, rtt, "T2"));
+
+  // A full dataset replaces everything collected from differential messages.
+  rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg({}, kBaseDay + 9h + 3min));
+  EXPECT_EQ(0_minutes, dep_delay(tt, rtt, "T2"));
+}
+
+TEST(rt, gtfs_rt_revert_cancellation) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, differential_files(), tt);
+  finalize(tt);
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+
+  struct change {
+    transport transport_;
+    event_type ev_type_;
+    duration_t delay_;
+    bool cancelled_;
+  };
+  auto changes = std::vector<change>{};
+  rtt.set_change_callback([&](transport const t, stop_idx_t,
+                              event_type const ev_type,
+                              duration_t const delay, bool const cancelled) {
+    changes.push_back({t, ev_type, delay, cancelled});
+  });
+
+  auto td = transit_realtime::TripDescriptor{};
+  td.set_trip_id("T1");
+  auto const [r, _] =
+      rt::gtfsrt_resolve_run(kBaseDay, tt, &rtt, source_idx_t{0}, td);
+  ASSERT_TRUE(r.valid());
+  auto const is_active = [&]() {
+    return rtt.bitfields_[rtt.transport_traffic_days_[r.t_.t_idx_]].test(
+        to_idx(r.t_.day_));
+  };
+
+  // Cancellation without RT transport: only the static transport is
+  // deactivated.
+  auto cancel = test::to_feed_msg({{.trip_id_ = "T1", .delays_ = {}}},
+                                  kBaseDay + 9h);
+  cancel.mutable_entity(0)->mutable_trip_update()->mutable_trip()
+      ->set_schedule_relationship(
+          transit_realtime::TripDescriptor_ScheduleRelationship_CANCELED);
+  rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "", cancel);
+  EXPECT_FALSE(is_active());
+  EXPECT_EQ(0U, rtt.n_rt_transports());
+  changes.clear();
+
+  // Missing in the next full dataset: active again, reported as change.
+  auto const stats =
+      rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "",
+                            test::to_feed_msg({}, kBaseDay + 9h + 1min));
+  EXPECT_EQ(1, stats.reverted_);
+  EXPECT_TRUE(is_active());
+
+  ASSERT_EQ(2U, changes.size());
+  EXPECT_EQ(r.t_, changes[0].transport_);
+  EXPECT_EQ(event_type::kDep, changes[0].ev_type_);
+  EXPECT_FALSE(changes[0].cancelled_);
+  EXPECT_EQ(event_type::kArr, changes[1].ev_type_);
+  EXPECT_EQ(0_minutes, changes[1].delay_);
+}
+
+TEST(rt, gtfs_rt_revert_track_change) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, differential_files(), tt);
+  finalize(tt);
+
+  auto const b = tt.locations_.location_id_to_idx_.at({"B", source_idx_t{0}});
+  auto const c = tt.locations_.location_id_to_idx_.at({"C", source_idx_t{0}});
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+
+  // T1 arrives at C instead of B.
+  auto msg = test::to_feed_msg({delayed("T1")}, kBaseDay + 9h);
+  auto* const stu =
+      msg.mutable_entity(0)->mutable_trip_update()->add_stop_time_update();
+  stu->set_stop_sequence(2U);
+  stu->mutable_stop_time_properties()->set_assigned_stop_id("C");
+  rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "", msg);
+  ASSERT_EQ(1U, rtt.n_rt_transports());
+  auto const rt_t = rt_transport_idx_t{0U};
+  EXPECT_EQ(c, stop{rtt.rt_transport_location_seq_[rt_t][1]}.location_idx());
+  EXPECT_TRUE(contains(rtt, c, rt_t));
+
+  // Reverted: the location index matches the static stop sequence again.
+  rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "",
+                        test::to_feed_msg({}, kBaseDay + 9h + 1min));
+  EXPECT_EQ(b, stop{rtt.rt_transport_location_seq_[rt_t][1]}.location_idx());
+  EXPECT_TRUE(contains(rtt, b, rt_t));
+  EXPECT_FALSE(contains(rtt, c, rt_t));
+  EXPECT_TRUE(rtt.location_rt_routes_[c].empty());
+}
+
+TEST(rt, gtfs_rt_revert_reroute) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, differential_files(), tt);
+  finalize(tt);
+
+  auto const a = tt.locations_.location_id_to_idx_.at({"A", source_idx_t{0}});
+  auto const c = tt.locations_.location_id_to_idx_.at({"C", source_idx_t{0}});
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+
+  auto td = transit_realtime::TripDescriptor{};
+  td.set_trip_id("T1");
+  auto const [r, _] =
+      rt::gtfsrt_resolve_run(kBaseDay, tt, &rtt, source_idx_t{0}, td);
+  ASSERT_TRUE(r.valid());
+
+  // Rerouted A -> C -> B.
+  auto stop_seq = std::vector<stop::value_type>{};
+  for (auto const l : {a, c,
+                       tt.locations_.location_id_to_idx_.at(
+                           {"B", source_idx_t{0}})}) {
+    stop_seq.push_back(stop{l, true, true, true, true}.value());
+  }
+  auto times = std::vector<delta_t>{
+      rtt.unix_to_delta(kBaseDay + 10h), rtt.unix_to_delta(kBaseDay + 10h),
+      rtt.unix_to_delta(kBaseDay + 10h + 10min),
+      rtt.unix_to_delta(kBaseDay + 10h + 10min)};
+  auto const rerouted =
+      rtt.add_rt_transport(source_idx_t{0}, tt, r.t_, stop_seq, times);
+  rtt.build_rt_routes(tt);
+  EXPECT_TRUE(contains(rtt, c, rerouted));
+  EXPECT_EQ(1U, rtt.location_rt_routes_[c].size());
+
+  // Reverted: the RT copy is detached, the static transport is used again.
+  rtt.reset_to_static(tt, rerouted);
+  rtt.build_rt_routes(tt);
+  EXPECT_EQ(rt_transport_idx_t::invalid(), rtt.resolve_rt(r.t_));
+  EXPECT_TRUE(rtt.bitfields_[rtt.transport_traffic_days_[r.t_.t_idx_]].test(
+      to_idx(r.t_.day_)));
+  EXPECT_FALSE(contains(rtt, a, rerouted));
+  EXPECT_FALSE(contains(rtt, c, rerouted));
+  EXPECT_TRUE(rtt.location_rt_routes_[a].empty());
+  EXPECT_TRUE(rtt.location_rt_routes_[c].empty());
+
+  // A new update creates a new RT transport.
+  rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "",
+                        test::to_feed_msg({delayed("T1")}, kBaseDay + 9h));
+  EXPECT_EQ(2U, rtt.n_rt_transports());
+  EXPECT_EQ(5_minutes, dep_delay(tt, rtt, "T1"));
+}
+
+TEST(rt, gtfs_rt_revert_additional_trip) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, differential_files(), tt);
+  finalize(tt);
+
+  auto const a = tt.locations_.location_id_to_idx_.at({"A", source_idx_t{0}});
+  auto const c = tt.locations_.location_id_to_idx_.at({"C", source_idx_t{0}});
+
+  auto rtt = rt::create_rt_timetable(tt, kBaseDay);
+
+  auto const add = [&](std::string_view trip_id) {
+    auto const stop_seq = std::array{stop{a, true, true, true, true}.value(),
+                                     stop{c, true, true, true, true}.value()};
+    auto const times = std::array{rtt.unix_to_delta(kBaseDay + 11h),
+                                  rtt.unix_to_delta(kBaseDay + 11h + 20min)};
+    auto const rt_t = rtt.add_additional_rt_transport(
+        source_idx_t{0}, trip_id, stop_seq, times, clasz::kBus);
+    rtt.build_rt_routes(tt);
+    return rt_t;
+  };
+  auto const added_msg = [](std::vector<test::trip> const& trips,
+                            date::sys_seconds const t,
+                            bool const is_differential) {
+    auto msg = test::to_feed_msg(trips, t);
+    msg.mutable_entity(0)
+        ->mutable_trip_update()
+        ->mutable_trip()
+        ->set_schedule_relationship(
+            transit_realtime::TripDescriptor_ScheduleRelationship_ADDED);
+    if (is_differential) {
+      msg.mutable_header()->set_incrementality(
+          transit_realtime::FeedHeader_Incrementality_DIFFERENTIAL);
+    }
+    return msg;
+  };
+  auto const is_detached = [&](rt_transport_idx_t const rt_t) {
+    return rtt.rt_transport_is_cancelled_.test(to_idx(rt_t)) &&
+           !contains(rtt, a, rt_t) && !contains(rtt, c, rt_t) &&
+           rtt.location_rt_routes_[c].empty();
+  };
+
+  // Full dataset: the additional trip is part of the first message only.
+  auto const x1 = add("X1");
+  EXPECT_EQ(x1, rtt.resolve_additional(source_idx_t{0}, "X1"));
+  EXPECT_EQ(1U, rtt.location_rt_routes_[c].size());
+
+  auto stats = rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      added_msg({{.trip_id_ = "X1", .delays_ = {}}, delayed("T1")},
+                kBaseDay + 9h, false));
+  EXPECT_EQ(2, stats.total_entities_success_);
+  EXPECT_FALSE(rtt.rt_transport_is_cancelled_.test(to_idx(x1)));
+
+  stats = rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg({delayed("T1")}, kBaseDay + 9h + 1min));
+  EXPECT_EQ(1, stats.reverted_);
+  EXPECT_EQ(rt_transport_idx_t::invalid(),
+            rtt.resolve_additional(source_idx_t{0}, "X1"));
+  EXPECT_TRUE(is_detached(x1));
+  EXPECT_EQ(5_minutes, dep_delay(tt, rtt, "T1"));
+
+  // Differential: the additional trip is removed by a deleted entity.
+  auto const x2 = add("X2");
+  rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      added_msg({{.trip_id_ = "X2", .delays_ = {}}}, kBaseDay + 9h + 2min,
+                true));
+  EXPECT_FALSE(rtt.rt_transport_is_cancelled_.test(to_idx(x2)));
+
+  auto del = added_msg({{.trip_id_ = "X2", .delays_ = {}}},
+                       kBaseDay + 9h + 3min, true);
+  del.mutable_entity(0)->set_is_deleted(true);
+  stats = rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "", del);
+  EXPECT_EQ(1, stats.reverted_);
+  EXPECT_EQ(rt_transport_idx_t::invalid(),
+            rtt.resolve_additional(source_idx_t{0}, "X2"));
+  EXPECT_TRUE(is_detached(x2));
+
+  // Not reverted again by the next full dataset.
+  stats = rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg({delayed("T1")}, kBaseDay + 9h + 4min));
+  EXPECT_EQ(0, stats.reverted_);
+}
@@ -367,4 +367,38 @@ TEST(rt, gtfs_rt_update) {
   ss << frun{tt, &rtt, r};
   EXPECT_EQ(ss.str(), kTransportAfterUpdate);
   std::cout << ss.str() << "\n";
-}
\ No newline at end of file
+}
+
+TEST(rt, trip_id_index) {
+  timetable tt;
+  tt.date_range_ = {date::sys_days{2019_y / March / 25},
+                    date::sys_days{2019_y / November / 1}};
+  register_special_stations(tt);
+  load_timetable({}, source_idx_t{0}, test_files(), tt);
+  finalize(tt);
+
+  ASSERT_FALSE(tt.trip_id_index_.empty());
+  for (auto const id : {"T_RE1", "T_RE2"}) {
+    auto const it = tt.find_trip_id(source_idx_t{0}, id);
+    ASSERT_NE(end(tt.trip_id_to_idx_), it);
+    EXPECT_EQ(id, tt.trip_id_strings_[it->first].view());
+    EXPECT_TRUE(it == begin(tt.trip_id_to_idx_) ||
+                tt.trip_id_strings_[std::prev(it)->first].view() != id);
+  }
+  EXPECT_EQ(end(tt.trip_id_to_idx_), tt.find_trip_id(source_idx_t{0}, "X"));
+  EXPECT_EQ(end(tt.trip_id_to_idx_),
+            tt.find_trip_id(source_idx_t{1}, "T_RE1"));
+
+  // Registering a trip invalidates the index (-> binary search fallback).
+  tt.register_trip_id(std::string_view{"T_RE3"}, source_idx_t{0}, "", {}, 0U,
+                      {});
+  EXPECT_TRUE(tt.trip_id_index_.empty());
+
+  // The fallback agrees with the index, also for misses.
+  auto const it = tt.find_trip_id(source_idx_t{0}, "T_RE1");
+  ASSERT_NE(end(tt.trip_id_to_idx_), it);
+  EXPECT_EQ("T_RE1", tt.trip_id_strings_[it->first].view());
+  EXPECT_EQ(end(tt.trip_id_to_idx_), tt.find_trip_id(source_idx_t{0}, "A"));
+  EXPECT_EQ(end(tt.trip_id_to_idx_),
+            tt.find_trip_id(source_idx_t{1}, "T_RE1"));
+}
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/rt/util.h"
+#include "nigiri/timetable.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::gtfs;
+using namespace nigiri::rt;
+using namespace date;
+using namespace std::string_literals;
+
+namespace {
+
+mem_dir bitfield_files() {
+  return mem_dir::read(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+AG,Agency,https://agency.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+A,A,1.0,1.0
+B,B,2.0,2.0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S,20231126,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R,AG,R,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+R,S,TRIP_1,B
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+TRIP_1,10:00:00,10:00:00,A,1
+TRIP_1,10:30:00,10:30:00,B,2
+)");
+}
+
+auto const kCancelUpdate =
+    R"({
+ "header": {
+  "gtfsRealtimeVersion": "2.0",
+  "incrementality": "FULL_DATASET",
+  "timestamp": "1691660324"
+ },
+ "entity": [
+  {
+    "id": "3248651",
+    "isDeleted": false,
+    "tripUpdate": {
+     "trip": {
+      "tripId": "TRIP_1",
+      "startTime": "10:00:00",
+      "startDate": "20231126",
+      "scheduleRelationship": "CANCELED"
+     }
+    }
+  }
+ ]
+})"s;
+
+}  // namespace
+
+TEST(rt, gtfs_rt_repeated_cancel_no_bitfield_growth) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, bitfield_files(), tt);
+  finalize(tt);
+
+  auto rtt =
+      rt::create_rt_timetable(tt, date::sys_days{2023_y / November / 26});
+
+  auto const msg = rt::json_to_protobuf(kCancelUpdate);
+  gtfsrt_update_buf(tt, rtt, source_idx_t{0}, "", msg);
+  auto const n_bitfields = rtt.bitfields_.size();
+  EXPECT_EQ(tt.bitfields_.size() + 1U, n_bitfields);
+
+  for (auto i = 0U; i != 10U; ++i) {
+    gtfsrt_update_buf(tt, rtt, source_idx_t{0}, "", msg);
+  }
+  EXPECT_EQ(n_bitfields, rtt.bitfields_.size());
+
+  auto const t = transport_idx_t{0U};
+  EXPECT_FALSE(rtt.bitfields_[rtt.transport_traffic_days_[t]].test(
+      to_idx(tt.day_idx(date::sys_days{2023_y / November / 26}))));
+}
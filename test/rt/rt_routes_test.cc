@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/timetable.h"
+
+#include "./util.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::gtfs;
+using namespace date;
+using namespace std::chrono_literals;
+
+namespace {
+
+mem_dir rt_routes_files() {
+  return mem_dir::read(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+AG,Agency,https://agency.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+A,A,1.0,1.0
+B,B,2.0,2.0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S,20231126,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R,AG,R,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+R,S,T1,B
+R,S,T2,B
+R,S,T3,B
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+T1,10:00:00,10:00:00,A,1
+T1,10:30:00,10:30:00,B,2
+T2,10:10:00,10:10:00,A,1
+T2,10:40:00,10:40:00,B,2
+T3,10:20:00,10:20:00,A,1
+T3,10:50:00,10:50:00,B,2
+)");
+}
+
+}  // namespace
+
+TEST(rt, rt_routes) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, rt_routes_files(), tt);
+  finalize(tt);
+
+  auto rtt =
+      rt::create_rt_timetable(tt, date::sys_days{2023_y / November / 26});
+  EXPECT_TRUE(rtt.has_rt_routes());
+  EXPECT_EQ(0U, rtt.n_rt_routes());
+
+  // Delays keeping the order: all RT transports share one RT route.
+  rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg(
+          {{.trip_id_ = "T1",
+            .delays_ = {{.seq_ = 1U, .ev_type_ = event_type::kDep,
+                         .delay_minutes_ = 5}}},
+           {.trip_id_ = "T2",
+            .delays_ = {{.seq_ = 1U, .ev_type_ = event_type::kDep,
+                         .delay_minutes_ = 5}}}},
+          date::sys_days{2023_y / November / 26} + 9h));
+  ASSERT_TRUE(rtt.has_rt_routes());
+  ASSERT_EQ(1U, rtt.n_rt_routes());
+  EXPECT_EQ(2U, rtt.rt_route_transports_[rt_route_idx_t{0U}].size());
+
+  auto const a = tt.locations_.location_id_to_idx_.at({"A", source_idx_t{0}});
+  EXPECT_EQ(1U, rtt.location_rt_routes_[a].size());
+
+  // Event times are stored column-major and sorted per stop.
+  auto const dep_a =
+      rtt.rt_route_event_times(rt_route_idx_t{0U}, 0U, event_type::kDep);
+  ASSERT_EQ(2U, dep_a.size());
+  EXPECT_LT(dep_a[0], dep_a[1]);
+
+  // T3 overtakes the delayed T2: T2 has to go to a separate RT route.
+  rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg(
+          {{.trip_id_ = "T2",
+            .delays_ = {{.seq_ = 2U, .ev_type_ = event_type::kArr,
+                         .delay_minutes_ = 15}}},
+           {.trip_id_ = "T3", .delays_ = {}}},
+          date::sys_days{2023_y / November / 26} + 9h));
+  ASSERT_TRUE(rtt.has_rt_routes());
+  ASSERT_EQ(3U, rtt.n_rt_transports());
+  auto const t2 = rt_transport_idx_t{1U};
+  auto const t3 = rt_transport_idx_t{2U};
+  EXPECT_NE(rtt.rt_transport_route_[t2], rtt.rt_transport_route_[t3]);
+
+  // The replaced RT route is no longer reachable via its locations.
+  EXPECT_EQ(2U, rtt.location_rt_routes_[a].size());
+  EXPECT_EQ(1U, rtt.n_removed_rt_routes_);
+  EXPECT_EQ(3U, rtt.n_rt_routes());
+
+  // Nothing changed: no RT routes are rebuilt.
+  rtt.build_rt_routes(tt);
+  EXPECT_EQ(3U, rtt.n_rt_routes());
+}
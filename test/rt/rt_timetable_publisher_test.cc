@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/rt/rt_timetable_publisher.h"
+#include "nigiri/timetable.h"
+
+#include "./util.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::gtfs;
+using namespace date;
+using namespace std::chrono_literals;
+
+namespace {
+
+mem_dir publisher_files() {
+  return mem_dir::read(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+AG,Agency,https://agency.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+A,A,1.0,1.0
+B,B,2.0,2.0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S,20231126,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R,AG,R,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+R,S,T1,B
+R,S,T2,B
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+T1,10:00:00,10:00:00,A,1
+T1,10:30:00,10:30:00,B,2
+T2,11:00:00,11:00:00,A,1
+T2,11:30:00,11:30:00,B,2
+)");
+}
+
+}  // namespace
+
+TEST(rt, rt_timetable_publisher) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                    date::sys_days{2023_y / November / 27}};
+  load_timetable({}, source_idx_t{0}, publisher_files(), tt);
+  finalize(tt);
+
+  auto const base_day = date::sys_days{2023_y / November / 26};
+  auto const update = [&](std::string const& trip_id) {
+    return [&, msg = test::to_feed_msg({{.trip_id_ = trip_id, .delays_ = {}}},
+                                       base_day + 9h)](rt_timetable& rtt) {
+      rt::gtfsrt_update_msg(tt, rtt, source_idx_t{0}, "", msg);
+    };
+  };
+
+  auto publisher = rt::rt_timetable_publisher{tt, base_day};
+
+  {
+    // A pinned snapshot is not affected by later updates.
+    auto const before = publisher.get_snapshot();
+    publisher.update(update("T1"));
+    EXPECT_EQ(0U, before->n_rt_transports());
+    EXPECT_EQ(1U, publisher.get_snapshot()->n_rt_transports());
+  }
+
+  // The second update replays the first one on the other buffer.
+  publisher.update(update("T2"));
+  EXPECT_EQ(2U, publisher.get_snapshot()->n_rt_transports());
+
+  publisher.update(update("T1"));
+  EXPECT_EQ(2U, publisher.get_snapshot()->n_rt_transports());
+}
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <sstream>
+
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/frun.h"
+#include "nigiri/rt/gtfsrt_resolve_run.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/timetable.h"
+
+#include "./util.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::gtfs;
+using namespace date;
+using namespace std::chrono_literals;
+
+namespace {
+
+mem_dir snapshot_files(std::string_view extra_stop_times) {
+  return mem_dir::read(std::string{R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+AG,Agency,https://agency.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+A,A,1.0,1.0
+B,B,2.0,2.0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S,20231126,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R,AG,R,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+R,S,T1,B
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+T1,10:00:00,10:00:00,A,1
+T1,10:30:00,10:30:00,B,2
+)"} + std::string{extra_stop_times});
+}
+
+std::string print_t1(timetable const& tt, rt_timetable const& rtt) {
+  auto td = transit_realtime::TripDescriptor{};
+  td.set_trip_id("T1");
+  auto const [r, _] =
+      rt::gtfsrt_resolve_run(date::sys_days{2023_y / November / 26}, tt, &rtt,
+                             source_idx_t{0}, td);
+  auto ss = std::stringstream{};
+  ss << rt::frun{tt, &rtt, r};
+  return ss.str();
+}
+
+}  // namespace
+
+TEST(rt, rt_timetable_snapshot) {
+  auto const load = [](std::string_view extra_stop_times) {
+    auto tt = timetable{};
+    register_special_stations(tt);
+    tt.date_range_ = {date::sys_days{2023_y / November / 25},
+                      date::sys_days{2023_y / November / 27}};
+    load_timetable({}, source_idx_t{0}, snapshot_files(extra_stop_times), tt);
+    finalize(tt);
+    return tt;
+  };
+
+  auto const tt = load("");
+  auto rtt =
+      rt::create_rt_timetable(tt, date::sys_days{2023_y / November / 26});
+  rt::gtfsrt_update_msg(
+      tt, rtt, source_idx_t{0}, "",
+      test::to_feed_msg({{.trip_id_ = "T1",
+                          .delays_ = {{.seq_ = 1U,
+                                       .ev_type_ = event_type::kDep,
+                                       .delay_minutes_ = 5}}}},
+                        date::sys_days{2023_y / November / 26} + 9h));
+
+  auto const path =
+      std::filesystem::temp_directory_path() / "nigiri_rtt_snapshot.bin";
+  rtt.write(path);
+
+  auto const restored = rt_timetable::read(path, tt);
+  EXPECT_EQ(rtt.n_rt_transports(), restored.n_rt_transports());
+  EXPECT_EQ(print_t1(tt, rtt), print_t1(tt, restored));
+  EXPECT_FALSE(restored.change_callback_);
+  EXPECT_TRUE(restored.get_changes().empty());
+
+  // Snapshot of a different static timetable.
+  auto const other_tt = load("T1,10:40:00,10:40:00,B,3\n");
+  EXPECT_ANY_THROW(rt_timetable::read(path, other_tt));
+
+  std::filesystem::remove(path);
+}
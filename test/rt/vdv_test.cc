@@ -8,6 +8,7 @@
 #include "nigiri/rt/create_rt_timetable.h"
 #include "nigiri/rt/frun.h"
 #include "nigiri/rt/rt_timetable.h"
+#include "nigiri/rt/vdv/vdv_event_index.h"
 #include "nigiri/rt/vdv/vdv_update.h"
 #include "nigiri/special_stations.h"
 #include "nigiri/timetable.h"
@@ -375,6 +376,188 @@ TEST(vdv_update, delay_propagation) {
   EXPECT_EQ(u.get_stats().matched_runs_, 3);
 }
 
+TEST(vdv_update, indexed_matching) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2024_y / July / 1},
+                    date::sys_days{2024_y / July / 31}};
+  auto const src_idx = source_idx_t{0};
+  load_timetable({}, src_idx, vdv_test_files(), tt);
+  finalize(tt);
+
+  auto const idx = rt::vdv::event_index{tt};
+
+  auto doc = pugi::xml_document{};
+  doc.load_string(vdv_update_msg0);
+
+  auto rtt_scan =
+      rt::create_rt_timetable(tt, date::sys_days{2024_y / July / 10});
+  auto scan = rt::vdv::updater{tt, src_idx};
+  scan.update(rtt_scan, doc);
+
+  auto rtt_indexed =
+      rt::create_rt_timetable(tt, date::sys_days{2024_y / July / 10});
+  auto indexed = rt::vdv::updater{tt, src_idx, idx};
+  indexed.update(rtt_indexed, doc);
+
+  auto const r = rt::run{{transport_idx_t{0}, day_idx_t{13}},
+                         {stop_idx_t{0}, stop_idx_t{5}}};
+  auto ss_scan = std::stringstream{};
+  auto ss_indexed = std::stringstream{};
+  ss_scan << rt::frun{tt, &rtt_scan, r};
+  ss_indexed << rt::frun{tt, &rtt_indexed, r};
+  EXPECT_EQ(ss_scan.str(), ss_indexed.str());
+
+  EXPECT_EQ(scan.get_stats().found_runs_, indexed.get_stats().found_runs_);
+  EXPECT_EQ(scan.get_stats().matched_runs_, indexed.get_stats().matched_runs_);
+  EXPECT_EQ(0U, scan.get_stats().index_probes_);
+  EXPECT_LT(0U, indexed.get_stats().index_probes_);
+}
+
+TEST(vdv_update, streaming) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2024_y / July / 1},
+                    date::sys_days{2024_y / July / 31}};
+  auto const src_idx = source_idx_t{0};
+  load_timetable({}, src_idx, vdv_test_files(), tt);
+  finalize(tt);
+
+  auto const r = rt::run{{transport_idx_t{0}, day_idx_t{13}},
+                         {stop_idx_t{0}, stop_idx_t{5}}};
+  auto const print = [&](rt_timetable const& rtt) {
+    auto ss = std::stringstream{};
+    ss << rt::frun{tt, &rtt, r};
+    return ss.str();
+  };
+
+  auto doc = pugi::xml_document{};
+  doc.load_string(vdv_update_msg0);
+  auto rtt_dom =
+      rt::create_rt_timetable(tt, date::sys_days{2024_y / July / 10});
+  auto dom = rt::vdv::updater{tt, src_idx};
+  dom.update(rtt_dom, doc);
+
+  // Whole message at once.
+  auto rtt_str =
+      rt::create_rt_timetable(tt, date::sys_days{2024_y / July / 10});
+  auto str = rt::vdv::updater{tt, src_idx};
+  str.update(rtt_str, std::string_view{vdv_update_msg0});
+  EXPECT_EQ(print(rtt_dom), print(rtt_str));
+  EXPECT_EQ(dom.get_stats().matched_runs_, str.get_stats().matched_runs_);
+  EXPECT_EQ(dom.get_stats().updated_events_, str.get_stats().updated_events_);
+
+  // Small chunks: tags are split across chunk borders.
+  auto rtt_chunked =
+      rt::create_rt_timetable(tt, date::sys_days{2024_y / July / 10});
+  auto chunked = rt::vdv::updater{tt, src_idx};
+  {
+    auto stream = rt::vdv::update_stream{chunked, rtt_chunked};
+    auto const msg = std::string_view{vdv_update_msg0};
+    for (auto i = 0U; i < msg.size(); i += 7U) {
+      stream.feed(msg.substr(i, 7U));
+    }
+    stream.finish();
+  }
+  EXPECT_EQ(print(rtt_dom), print(rtt_chunked));
+  EXPECT_EQ(dom.get_stats().total_runs_, chunked.get_stats().total_runs_);
+  EXPECT_EQ(dom.get_stats().matched_runs_, chunked.get_stats().matched_runs_);
+  EXPECT_EQ(dom.get_stats().updated_events_,
+            chunked.get_stats().updated_events_);
+}
+
+namespace {
+mem_dir latin1_files() {
+  return mem_dir::read(R"__(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+MTA,MOTIS Transit Authority,https://motis-project.de/,Europe/Berlin
+
+# calendar_dates.txt
+service_id,date,exception_type
+D,20240710,1
+
+# stops.txt
+stop_id,stop_name,stop_desc,stop_lat,stop_lon,stop_url,location_type,parent_station
+A,A,,,,,,
+Ä,Ä,,,,,,
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+AE,MTA,AE,AE,A -> Ä,0
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id
+AE,D,AE_TRIP,AE_TRIP,1
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+AE_TRIP,10:00,10:00,A,0,0,0
+AE_TRIP,11:00,11:00,Ä,1,0,0
+)__");
+}
+
+// Latin-1 encoded stop id, whitespace around '=' in the prolog.
+constexpr auto const latin1_update = R"(
+<?xml version = "1.0" encoding = 'ISO-8859-1' ?>
+<DatenAbrufenAntwort>
+  <AUSNachricht AboID="1">
+    <IstFahrt Zst="2024-07-10T00:00:00">
+      <LinienID>AE</LinienID>
+      <RichtungsID>1</RichtungsID>
+      <FahrtRef>
+        <FahrtID>
+          <FahrtBezeichner>AE</FahrtBezeichner>
+          <Betriebstag>2024-07-10</Betriebstag>
+        </FahrtID>
+      </FahrtRef>
+      <Komplettfahrt>false</Komplettfahrt>
+      <BetreiberID>MTA</BetreiberID>
+      <IstHalt>
+        <HaltID>A</HaltID>
+        <Abfahrtszeit>2024-07-10T08:00:00</Abfahrtszeit>
+      </IstHalt>
+      <IstHalt>
+        <HaltID>)"
+                                   "\xC4"
+                                   R"(</HaltID>
+        <Ankunftszeit>2024-07-10T09:00:00</Ankunftszeit>
+        <IstAnkunftPrognose>2024-07-10T09:10:00</IstAnkunftPrognose>
+      </IstHalt>
+      <FaelltAus>false</FaelltAus>
+    </IstFahrt>
+  </AUSNachricht>
+</DatenAbrufenAntwort>
+)";
+}  // namespace
+
+TEST(vdv_update, streaming_latin1_prolog) {
+  timetable tt;
+  register_special_stations(tt);
+  tt.date_range_ = {date::sys_days{2024_y / July / 1},
+                    date::sys_days{2024_y / July / 31}};
+  auto const src_idx = source_idx_t{0};
+  load_timetable({}, src_idx, latin1_files(), tt);
+  finalize(tt);
+
+  // One byte per chunk: the prolog is only evaluated once "?>" arrived.
+  auto rtt = rt::create_rt_timetable(tt, date::sys_days{2024_y / July / 10});
+  auto u = rt::vdv::updater{tt, src_idx};
+  {
+    auto stream = rt::vdv::update_stream{u, rtt};
+    auto const msg = std::string_view{latin1_update};
+    for (auto i = 0U; i != msg.size(); ++i) {
+      stream.feed(msg.substr(i, 1U));
+    }
+    stream.finish();
+  }
+
+  EXPECT_EQ(1U, u.get_stats().matched_runs_);
+  ASSERT_EQ(1U, rtt.n_rt_transports());
+  EXPECT_EQ(date::sys_days{2024_y / July / 10} + 9h + 10min,
+            rtt.unix_event_time(rt_transport_idx_t{0U}, 1U, event_type::kArr));
+}
+
 namespace {
 mem_dir before_midnight_files() {
   return mem_dir::read(R"__(